@@ -0,0 +1,466 @@
+/*
+* Copyright (c) 2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Box2D.h>
+#include <Box2D/Dynamics/Contacts/b2ContactTraits.h>
+#include <Box2D/Rope/b2Rope.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+// Steps a few fixed scenes and reports the b2Profile phases per step. On
+// Linux the hardware counters of each phase are reported next to the time.
+// Then the narrow phase of the scene's contacts is timed once through the
+// virtual b2Contact::Evaluate and once through the b2ContactTraits loops the
+// contact manager uses. The rope case steps a free rope with each
+// constraint ordering.
+//
+// usage: Box2DBenchmark [scene] [steps]
+
+typedef void (*SceneFcn)(b2World* world);
+
+// A pyramid of boxes on a box ground. Tests the contact solver.
+static void CreatePyramid(b2World* world)
+{
+	b2BodyDef bd;
+	b2Body* ground = world->CreateBody(&bd);
+	b2PolygonShape groundShape;
+	groundShape.SetAsBox(40.0f, 1.0f, b2Vec2(0.0f, -1.0f), 0.0f);
+	ground->CreateFixture(&groundShape, 0.0f);
+
+	const int32 rowCount = 30;
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+	for (int32 i = 0; i < rowCount; ++i)
+	{
+		for (int32 j = i; j < rowCount; ++j)
+		{
+			bd.type = b2_dynamicBody;
+			bd.position.Set(1.125f * (j - 0.5f * i - 0.5f * rowCount), 0.5f + 1.0f * i);
+			b2Body* body = world->CreateBody(&bd);
+			body->CreateFixture(&box, 5.0f);
+		}
+	}
+}
+
+// Mixed shapes falling onto a chain. Tests the broad-phase and the narrow phase.
+static void CreateRain(b2World* world)
+{
+	b2BodyDef bd;
+	b2Body* ground = world->CreateBody(&bd);
+	b2Vec2 vertices[101];
+	for (int32 i = 0; i < 101; ++i)
+	{
+		vertices[i].Set(-50.0f + i, 2.0f * sinf(0.3f * i));
+	}
+	b2ChainShape chain;
+	chain.CreateChain(vertices, 101);
+	ground->CreateFixture(&chain, 0.0f);
+
+	b2CircleShape circle;
+	circle.m_radius = 0.4f;
+	b2PolygonShape box;
+	box.SetAsBox(0.4f, 0.25f);
+	b2PolygonShape hexagon;
+	b2Vec2 points[6];
+	for (int32 i = 0; i < 6; ++i)
+	{
+		float32 angle = i * b2_pi / 3.0f;
+		points[i].Set(0.4f * cosf(angle), 0.4f * sinf(angle));
+	}
+	hexagon.Set(points, 6);
+
+	const b2Shape* shapes[3] = { &circle, &box, &hexagon };
+	for (int32 i = 0; i < 600; ++i)
+	{
+		bd.type = b2_dynamicBody;
+		bd.position.Set(-45.0f + 1.5f * (i % 60), 6.0f + 1.5f * (i / 60));
+		bd.angle = 0.1f * i;
+		b2Body* body = world->CreateBody(&bd);
+		body->CreateFixture(shapes[i % 3], 1.0f);
+	}
+}
+
+// Fish sized bodies floating over a heightfield lake bed, like the game.
+// Tests the controllers, sleeping and the heightfield contacts.
+static void CreateLake(b2World* world)
+{
+	const int32 heightCount = 400;
+	float32 heights[heightCount];
+	for (int32 i = 0; i < heightCount; ++i)
+	{
+		heights[i] = 2.0f * sinf(0.05f * i) + 0.5f * sinf(0.31f * i);
+	}
+
+	b2BodyDef bd;
+	b2Body* ground = world->CreateBody(&bd);
+	b2HeightfieldShape bed;
+	bed.Create(heights, heightCount, -100.0f, 0.5f);
+	ground->CreateFixture(&bed, 0.0f);
+
+	b2BuoyancyControllerDef waterDef;
+	waterDef.normal.Set(0.0f, 1.0f);
+	waterDef.offset = 12.0f;
+	waterDef.density = 1.0f;
+	waterDef.linearDrag = 2.0f;
+	waterDef.quadraticDrag = 1.0f;
+	waterDef.angularDrag = 1.0f;
+	b2Controller* water = world->CreateController(&waterDef);
+
+	b2PolygonShape fish;
+	fish.SetAsBox(0.3f, 0.1f);
+	for (int32 i = 0; i < 800; ++i)
+	{
+		bd.type = b2_dynamicBody;
+		bd.position.Set(-95.0f + 0.5f * (i % 380), 4.0f + 0.5f * (i / 380));
+		b2Body* body = world->CreateBody(&bd);
+		body->CreateFixture(&fish, 0.8f + 0.1f * (i % 5));
+		water->AddBody(body);
+	}
+}
+
+struct Scene
+{
+	const char* name;
+	SceneFcn create;
+};
+
+static const Scene s_scenes[] =
+{
+	{ "pyramid", CreatePyramid },
+	{ "rain", CreateRain },
+	{ "lake", CreateLake }
+};
+
+static const int32 s_sceneCount = sizeof(s_scenes) / sizeof(s_scenes[0]);
+
+// Phase totals over all measured steps.
+struct PhaseTotal
+{
+	const char* name;
+	float64 milliseconds;
+	float64 events[e_perfEventCount];
+};
+
+static void Accumulate(PhaseTotal* total, float32 milliseconds, const b2PerfSample& sample)
+{
+	total->milliseconds += milliseconds;
+	for (int32 i = 0; i < e_perfEventCount; ++i)
+	{
+		total->events[i] += float64(sample.values[i]);
+	}
+}
+
+// The contacts of one shape pair and the state the narrow phase writes.
+struct DispatchBatch
+{
+	std::vector<b2Contact*> contacts;
+	std::vector<b2Manifold> manifolds;
+	std::vector<b2SATCache> caches;
+};
+
+typedef void (*DispatchFcn)(DispatchBatch* batch);
+
+template <int32 typeA, int32 typeB>
+static void CollideDirect(DispatchBatch* batch)
+{
+	int32 count = int32(batch->contacts.size());
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Contact* c = batch->contacts[i];
+		b2Fixture* fixtureA = c->GetFixtureA();
+		b2Fixture* fixtureB = c->GetFixtureB();
+		b2ContactTraits<typeA, typeB>::Collide(&batch->manifolds[i],
+			fixtureA->GetShape(), c->GetChildIndexA(), fixtureA->GetBody()->GetTransform(),
+			fixtureB->GetShape(), c->GetChildIndexB(), fixtureB->GetBody()->GetTransform(),
+			&batch->caches[i]);
+	}
+}
+
+static void CollideVirtual(DispatchBatch* batch)
+{
+	int32 count = int32(batch->contacts.size());
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Contact* c = batch->contacts[i];
+		c->Evaluate(&batch->manifolds[i], c->GetFixtureA()->GetBody()->GetTransform(),
+					c->GetFixtureB()->GetBody()->GetTransform());
+	}
+}
+
+// Time the narrow phase of all non-sensor contacts of the world, grouped by
+// shape pair like the contact manager does, with both kinds of dispatch.
+// The manifolds go to separate buffers. Evaluate refreshes the contacts' own
+// SAT caches, which leaves them valid for the current transforms.
+static void RunDispatch(const b2World& world)
+{
+	const int32 typeCount = b2Shape::e_typeCount;
+	DispatchFcn direct[typeCount * typeCount];
+	memset(direct, 0, sizeof(direct));
+	direct[b2Shape::e_circle * typeCount + b2Shape::e_circle] = CollideDirect<b2Shape::e_circle, b2Shape::e_circle>;
+	direct[b2Shape::e_polygon * typeCount + b2Shape::e_circle] = CollideDirect<b2Shape::e_polygon, b2Shape::e_circle>;
+	direct[b2Shape::e_polygon * typeCount + b2Shape::e_polygon] = CollideDirect<b2Shape::e_polygon, b2Shape::e_polygon>;
+	direct[b2Shape::e_edge * typeCount + b2Shape::e_circle] = CollideDirect<b2Shape::e_edge, b2Shape::e_circle>;
+	direct[b2Shape::e_edge * typeCount + b2Shape::e_polygon] = CollideDirect<b2Shape::e_edge, b2Shape::e_polygon>;
+	direct[b2Shape::e_chain * typeCount + b2Shape::e_circle] = CollideDirect<b2Shape::e_chain, b2Shape::e_circle>;
+	direct[b2Shape::e_chain * typeCount + b2Shape::e_polygon] = CollideDirect<b2Shape::e_chain, b2Shape::e_polygon>;
+	direct[b2Shape::e_heightfield * typeCount + b2Shape::e_circle] = CollideDirect<b2Shape::e_heightfield, b2Shape::e_circle>;
+	direct[b2Shape::e_heightfield * typeCount + b2Shape::e_polygon] = CollideDirect<b2Shape::e_heightfield, b2Shape::e_polygon>;
+
+	DispatchBatch batches[typeCount * typeCount];
+	int32 contactCount = 0;
+	for (const b2Contact* c = world.GetContactList(); c; c = c->GetNext())
+	{
+		const b2Fixture* fixtureA = c->GetFixtureA();
+		const b2Fixture* fixtureB = c->GetFixtureB();
+		if (fixtureA->IsSensor() || fixtureB->IsSensor())
+		{
+			continue;
+		}
+
+		DispatchBatch& batch = batches[fixtureA->GetType() * typeCount + fixtureB->GetType()];
+		batch.contacts.push_back(const_cast<b2Contact*>(c));
+		b2SATCache cache;
+		cache.type = b2SATCache::e_empty;
+		cache.index = 0;
+		batch.caches.push_back(cache);
+		++contactCount;
+	}
+
+	for (int32 i = 0; i < typeCount * typeCount; ++i)
+	{
+		batches[i].manifolds.resize(batches[i].contacts.size());
+	}
+
+	// Best of several rounds, each round runs the whole narrow phase many times.
+	const int32 roundCount = 5;
+	const int32 passCount = 50;
+	float64 best[2] = { 1.0e9, 1.0e9 };
+	for (int32 round = 0; round < roundCount; ++round)
+	{
+		for (int32 kind = 0; kind < 2; ++kind)
+		{
+			b2Timer timer;
+			for (int32 pass = 0; pass < passCount; ++pass)
+			{
+				for (int32 i = 0; i < typeCount * typeCount; ++i)
+				{
+					if (batches[i].contacts.empty())
+					{
+						continue;
+					}
+
+					if (kind == 0)
+					{
+						CollideVirtual(batches + i);
+					}
+					else
+					{
+						direct[i](batches + i);
+					}
+				}
+			}
+
+			float64 microseconds = 1000.0 * timer.GetMilliseconds() / passCount;
+			best[kind] = b2Min(best[kind], microseconds);
+		}
+	}
+
+	printf("  narrow phase of %d contacts: virtual %.1f us, compile-time %.1f us\n",
+		contactCount, best[0], best[1]);
+}
+
+static void RunScene(const Scene& scene, int32 stepCount, const b2PerfCounters& counters)
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	scene.create(&world);
+
+	// Let the scene settle into its working set before measuring.
+	const float32 timeStep = 1.0f / 60.0f;
+	for (int32 i = 0; i < 60; ++i)
+	{
+		world.Step(timeStep, 8, 3);
+	}
+
+	PhaseTotal totals[5];
+	memset(totals, 0, sizeof(totals));
+	totals[0].name = "step";
+	totals[1].name = "collide";
+	totals[2].name = "solve";
+	totals[3].name = "broadphase";
+	totals[4].name = "solveTOI";
+
+	world.SetPerfCounters(&counters);
+	for (int32 i = 0; i < stepCount; ++i)
+	{
+		world.Step(timeStep, 8, 3);
+
+		const b2Profile& profile = world.GetProfile();
+		const b2PerfProfile& perfProfile = world.GetPerfProfile();
+		Accumulate(totals + 0, profile.step, perfProfile.step);
+		Accumulate(totals + 1, profile.collide, perfProfile.collide);
+		Accumulate(totals + 2, profile.solve, perfProfile.solve);
+		Accumulate(totals + 3, profile.broadphase, perfProfile.broadphase);
+		Accumulate(totals + 4, profile.solveTOI, perfProfile.solveTOI);
+	}
+	world.SetPerfCounters(NULL);
+
+	printf("%s: %d bodies, %d contacts, %d steps\n", scene.name,
+		world.GetBodyCount(), world.GetContactCount(), stepCount);
+
+	printf("  %-10s %10s", "phase", "ms/step");
+	for (int32 i = 0; i < e_perfEventCount; ++i)
+	{
+		printf(" %14s", b2PerfCounters::GetName(b2PerfEvent(i)));
+	}
+	printf(" %6s\n", "IPC");
+
+	// The counts are per step. The broad-phase is part of the solve phase.
+	float64 inv = 1.0 / stepCount;
+	for (int32 k = 0; k < 5; ++k)
+	{
+		const PhaseTotal& total = totals[k];
+		printf("  %-10s %10.4f", total.name, total.milliseconds * inv);
+		for (int32 i = 0; i < e_perfEventCount; ++i)
+		{
+			if (counters.IsAvailable(b2PerfEvent(i)))
+			{
+				printf(" %14.0f", total.events[i] * inv);
+			}
+			else
+			{
+				printf(" %14s", "n/a");
+			}
+		}
+
+		float64 cycles = total.events[e_perfCycles];
+		if (counters.IsAvailable(e_perfCycles) && counters.IsAvailable(e_perfInstructions) && cycles > 0.0)
+		{
+			printf(" %6.2f\n", total.events[e_perfInstructions] / cycles);
+		}
+		else
+		{
+			printf(" %6s\n", "n/a");
+		}
+	}
+
+	RunDispatch(world);
+}
+
+// A 256 vertex rope hanging from one end, stepped with 8 iterations.
+static float64 StepRope(b2RopeOrdering ordering, b2RopeScheduler* scheduler, int32 stepCount)
+{
+	const int32 count = 256;
+	b2Vec2 vertices[count];
+	float32 masses[count];
+	for (int32 i = 0; i < count; ++i)
+	{
+		vertices[i].Set(0.1f * i, 0.0f);
+		masses[i] = 1.0f;
+	}
+	masses[0] = 0.0f;
+
+	b2RopeDef def;
+	def.vertices = vertices;
+	def.masses = masses;
+	def.count = count;
+	def.gravity.Set(0.0f, -10.0f);
+	def.k2 = 1.0f;
+	def.k3 = 0.5f;
+	def.ordering = ordering;
+
+	b2Rope rope;
+	rope.Initialize(&def);
+	rope.SetScheduler(scheduler, 1);
+
+	const float32 timeStep = 1.0f / 60.0f;
+	for (int32 i = 0; i < 60; ++i)
+	{
+		rope.Step(timeStep, 8);
+	}
+
+	b2Timer timer;
+	for (int32 i = 0; i < stepCount; ++i)
+	{
+		rope.Step(timeStep, 8);
+	}
+	return timer.GetMilliseconds() / stepCount;
+}
+
+static void RunRope(int32 stepCount)
+{
+	b2SerialRopeScheduler scheduler(32);
+	printf("rope: 256 vertices, 8 iterations, %d steps\n", stepCount);
+	printf("  sequential            %10.4f ms/step\n", StepRope(b2_sequentialOrdering, NULL, stepCount));
+	printf("  red-black             %10.4f ms/step\n", StepRope(b2_redBlackOrdering, NULL, stepCount));
+	printf("  red-black, scheduled  %10.4f ms/step\n", StepRope(b2_redBlackOrdering, &scheduler, stepCount));
+}
+
+int main(int argc, char** argv)
+{
+	const char* sceneName = argc > 1 ? argv[1] : "all";
+	int32 stepCount = argc > 2 ? atoi(argv[2]) : 600;
+	if (stepCount <= 0)
+	{
+		printf("usage: %s [scene] [steps]\n", argv[0]);
+		return 1;
+	}
+
+	b2PerfCounters counters;
+	bool any = false;
+	for (int32 i = 0; i < e_perfEventCount; ++i)
+	{
+		any = any || counters.IsAvailable(b2PerfEvent(i));
+	}
+
+	if (any == false)
+	{
+		printf("Hardware counters are not available, reporting times only.\n");
+	}
+
+	bool found = false;
+	for (int32 i = 0; i < s_sceneCount; ++i)
+	{
+		if (strcmp(sceneName, "all") == 0 || strcmp(sceneName, s_scenes[i].name) == 0)
+		{
+			RunScene(s_scenes[i], stepCount, counters);
+			found = true;
+		}
+	}
+
+	if (strcmp(sceneName, "all") == 0 || strcmp(sceneName, "rope") == 0)
+	{
+		RunRope(stepCount);
+		found = true;
+	}
+
+	if (found == false)
+	{
+		printf("unknown scene %s, the scenes are:", sceneName);
+		for (int32 i = 0; i < s_sceneCount; ++i)
+		{
+			printf(" %s", s_scenes[i].name);
+		}
+		printf(" rope\n");
+		return 1;
+	}
+
+	return 0;
+}
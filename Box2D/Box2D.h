@@ -34,10 +34,14 @@ For discussion please visit http://box2d.org/forum
 #include <Box2D/Common/b2Settings.h>
 #include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2Profiler.h>
+#include <Box2D/Common/b2PerfCounters.h>
+#include <Box2D/Common/b2Allocator.h>
 
 #include <Box2D/Collision/Shapes/b2CircleShape.h>
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2HeightfieldShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 
 #include <Box2D/Collision/b2BroadPhase.h>
@@ -53,6 +57,8 @@ For discussion please visit http://box2d.org/forum
 
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 
+#include <Box2D/Dynamics/Controllers/b2BuoyancyController.h>
+
 #include <Box2D/Dynamics/Joints/b2DistanceJoint.h>
 #include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
 #include <Box2D/Dynamics/Joints/b2GearJoint.h>
@@ -23,7 +23,10 @@
 
 b2ChainShape::~b2ChainShape()
 {
-	b2Free(m_vertices);
+	if (m_vertices)
+	{
+		m_allocator->Free(m_vertices, m_count * sizeof(b2Vec2), "b2ChainShape vertices");
+	}
 	m_vertices = NULL;
 	m_count = 0;
 }
@@ -41,7 +44,7 @@ void b2ChainShape::CreateLoop(const b2Vec2* vertices, int32 count)
 	}
 
 	m_count = count + 1;
-	m_vertices = (b2Vec2*)b2Alloc(m_count * sizeof(b2Vec2));
+	m_vertices = (b2Vec2*)m_allocator->Allocate(m_count * sizeof(b2Vec2), "b2ChainShape vertices");
 	memcpy(m_vertices, vertices, count * sizeof(b2Vec2));
 	m_vertices[count] = m_vertices[0];
 	m_prevVertex = m_vertices[m_count - 2];
@@ -63,7 +66,7 @@ void b2ChainShape::CreateChain(const b2Vec2* vertices, int32 count)
 	}
 
 	m_count = count;
-	m_vertices = (b2Vec2*)b2Alloc(count * sizeof(b2Vec2));
+	m_vertices = (b2Vec2*)m_allocator->Allocate(count * sizeof(b2Vec2), "b2ChainShape vertices");
 	memcpy(m_vertices, vertices, m_count * sizeof(b2Vec2));
 
 	m_hasPrevVertex = false;
@@ -89,6 +92,7 @@ b2Shape* b2ChainShape::Clone(b2BlockAllocator* allocator) const
 {
 	void* mem = allocator->Allocate(sizeof(b2ChainShape));
 	b2ChainShape* clone = new (mem) b2ChainShape;
+	clone->m_allocator = allocator->GetAllocator();
 	clone->CreateChain(m_vertices, m_count);
 	clone->m_prevVertex = m_prevVertex;
 	clone->m_nextVertex = m_nextVertex;
@@ -188,3 +192,15 @@ void b2ChainShape::ComputeMass(b2MassData* massData, float32 density) const
 	massData->center.SetZero();
 	massData->I = 0.0f;
 }
+
+float32 b2ChainShape::ComputeSubmergedArea(const b2Vec2& normal, float32 offset,
+									const b2Transform& xf, b2Vec2* c) const
+{
+	B2_NOT_USED(normal);
+	B2_NOT_USED(offset);
+	B2_NOT_USED(xf);
+	B2_NOT_USED(c);
+
+	// Chains have no area.
+	return 0.0f;
+}
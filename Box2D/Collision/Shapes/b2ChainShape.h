@@ -20,13 +20,15 @@
 #define B2_CHAIN_SHAPE_H
 
 #include <Box2D/Collision/Shapes/b2Shape.h>
+#include <Box2D/Common/b2Allocator.h>
 
 class b2EdgeShape;
 
 /// A chain shape is a free form sequence of line segments.
 /// The chain has two-sided collision, so you can use inside and outside collision.
 /// Therefore, you may use any winding order.
-/// Since there may be many vertices, they are allocated using b2Alloc.
+/// Since there may be many vertices, they are allocated using b2Alloc, or
+/// the world allocator once the chain is attached to a fixture.
 /// Connectivity information is used to create smooth collisions.
 /// WARNING: The chain will not collide properly if there are self-intersections.
 class b2ChainShape : public b2Shape
@@ -34,7 +36,7 @@ class b2ChainShape : public b2Shape
 public:
 	b2ChainShape();
 
-	/// The destructor frees the vertices using b2Free.
+	/// The destructor frees the vertices.
 	~b2ChainShape();
 
 	/// Create a loop. This automatically adjusts connectivity.
@@ -55,7 +57,7 @@ public:
 	/// Don't call this for loops.
 	void SetNextVertex(const b2Vec2& nextVertex);
 
-	/// Implement b2Shape. Vertices are cloned using b2Alloc.
+	/// Implement b2Shape. Vertices are cloned using the allocator behind the block allocator.
 	b2Shape* Clone(b2BlockAllocator* allocator) const;
 
 	/// @see b2Shape::GetChildCount
@@ -79,6 +81,13 @@ public:
 	/// @see b2Shape::ComputeMass
 	void ComputeMass(b2MassData* massData, float32 density) const;
 
+	/// @see b2Shape::ComputeSubmergedArea
+	float32 ComputeSubmergedArea(const b2Vec2& normal, float32 offset,
+								const b2Transform& xf, b2Vec2* c) const;
+
+	/// Provides the vertices.
+	b2Allocator* m_allocator;
+
 	/// The vertices. Owned by this class.
 	b2Vec2* m_vertices;
 
@@ -93,6 +102,7 @@ inline b2ChainShape::b2ChainShape()
 {
 	m_type = e_chain;
 	m_radius = b2_polygonRadius;
+	m_allocator = b2GetDefaultAllocator();
 	m_vertices = NULL;
 	m_count = 0;
 	m_hasPrevVertex = false;
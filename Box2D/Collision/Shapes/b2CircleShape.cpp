@@ -97,3 +97,34 @@ void b2CircleShape::ComputeMass(b2MassData* massData, float32 density) const
 	// inertia about the local origin
 	massData->I = massData->mass * (0.5f * m_radius * m_radius + b2Dot(m_p, m_p));
 }
+
+float32 b2CircleShape::ComputeSubmergedArea(const b2Vec2& normal, float32 offset,
+											const b2Transform& xf, b2Vec2* c) const
+{
+	b2Vec2 p = b2Mul(xf, m_p);
+
+	// Depth of the circle center below the surface.
+	float32 l = offset - b2Dot(normal, p);
+	if (l <= -m_radius)
+	{
+		// Completely dry
+		return 0.0f;
+	}
+
+	float32 r2 = m_radius * m_radius;
+	if (l >= m_radius)
+	{
+		// Completely wet
+		*c = p;
+		return b2_pi * r2;
+	}
+
+	// Partially submerged: the circle minus the dry cap above the surface.
+	float32 l2 = l * l;
+	float32 area = r2 * (asinf(l / m_radius) + 0.5f * b2_pi) + l * b2Sqrt(r2 - l2);
+	float32 h = r2 - l2;
+	float32 com = -2.0f / 3.0f * h * b2Sqrt(h) / area;
+
+	*c = p + com * normal;
+	return area;
+}
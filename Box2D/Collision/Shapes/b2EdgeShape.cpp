@@ -136,3 +136,15 @@ void b2EdgeShape::ComputeMass(b2MassData* massData, float32 density) const
 	massData->center = 0.5f * (m_vertex1 + m_vertex2);
 	massData->I = 0.0f;
 }
+
+float32 b2EdgeShape::ComputeSubmergedArea(const b2Vec2& normal, float32 offset,
+									const b2Transform& xf, b2Vec2* c) const
+{
+	B2_NOT_USED(normal);
+	B2_NOT_USED(offset);
+	B2_NOT_USED(xf);
+	B2_NOT_USED(c);
+
+	// Edges have no area.
+	return 0.0f;
+}
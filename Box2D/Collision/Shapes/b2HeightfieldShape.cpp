@@ -0,0 +1,227 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Collision/Shapes/b2HeightfieldShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+#include <new>
+#include <memory.h>
+
+b2HeightfieldShape::~b2HeightfieldShape()
+{
+	if (m_heights)
+	{
+		m_allocator->Free(m_heights, m_count * sizeof(float32), "b2HeightfieldShape heights");
+	}
+	m_heights = NULL;
+	m_count = 0;
+}
+
+void b2HeightfieldShape::Create(const float32* heights, int32 count, float32 originX, float32 spacing)
+{
+	b2Assert(m_heights == NULL && m_count == 0);
+	b2Assert(count >= 2);
+	// If the code crashes here, it means your samples are too close together.
+	b2Assert(spacing > b2_linearSlop);
+
+	m_count = count;
+	m_heights = (float32*)m_allocator->Allocate(count * sizeof(float32), "b2HeightfieldShape heights");
+	memcpy(m_heights, heights, count * sizeof(float32));
+	m_originX = originX;
+	m_spacing = spacing;
+
+	m_minHeight = heights[0];
+	m_maxHeight = heights[0];
+	for (int32 i = 1; i < count; ++i)
+	{
+		m_minHeight = b2Min(m_minHeight, heights[i]);
+		m_maxHeight = b2Max(m_maxHeight, heights[i]);
+	}
+
+	m_hasPrevHeight = false;
+	m_hasNextHeight = false;
+	m_prevHeight = 0.0f;
+	m_nextHeight = 0.0f;
+}
+
+void b2HeightfieldShape::SetPrevHeight(float32 prevHeight)
+{
+	m_prevHeight = prevHeight;
+	m_hasPrevHeight = true;
+}
+
+void b2HeightfieldShape::SetNextHeight(float32 nextHeight)
+{
+	m_nextHeight = nextHeight;
+	m_hasNextHeight = true;
+}
+
+b2Shape* b2HeightfieldShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2HeightfieldShape));
+	b2HeightfieldShape* clone = new (mem) b2HeightfieldShape;
+	clone->m_allocator = allocator->GetAllocator();
+	clone->Create(m_heights, m_count, m_originX, m_spacing);
+	clone->m_radius = m_radius;
+	clone->m_prevHeight = m_prevHeight;
+	clone->m_nextHeight = m_nextHeight;
+	clone->m_hasPrevHeight = m_hasPrevHeight;
+	clone->m_hasNextHeight = m_hasNextHeight;
+	return clone;
+}
+
+int32 b2HeightfieldShape::GetChildCount() const
+{
+	return 1;
+}
+
+void b2HeightfieldShape::GetSegment(b2EdgeShape* edge, int32 index) const
+{
+	b2Assert(0 <= index && index < m_count - 1);
+	edge->m_type = b2Shape::e_edge;
+	edge->m_radius = m_radius;
+
+	edge->m_vertex1 = GetVertex(index);
+	edge->m_vertex2 = GetVertex(index + 1);
+
+	if (index > 0)
+	{
+		edge->m_vertex0 = GetVertex(index - 1);
+		edge->m_hasVertex0 = true;
+	}
+	else
+	{
+		edge->m_vertex0.Set(m_originX - m_spacing, m_prevHeight);
+		edge->m_hasVertex0 = m_hasPrevHeight;
+	}
+
+	if (index < m_count - 2)
+	{
+		edge->m_vertex3 = GetVertex(index + 2);
+		edge->m_hasVertex3 = true;
+	}
+	else
+	{
+		edge->m_vertex3.Set(m_originX + m_count * m_spacing, m_nextHeight);
+		edge->m_hasVertex3 = m_hasNextHeight;
+	}
+}
+
+bool b2HeightfieldShape::GetSegmentRange(float32 lowerX, float32 upperX, int32* first, int32* last) const
+{
+	float32 inv = 1.0f / m_spacing;
+	float32 u1 = (lowerX - m_originX) * inv;
+	float32 u2 = (upperX - m_originX) * inv;
+
+	int32 segmentCount = m_count - 1;
+	if (u2 < 0.0f || u1 > float32(segmentCount))
+	{
+		return false;
+	}
+
+	*first = int32(b2Max(u1, 0.0f));
+	*last = int32(b2Min(u2, float32(segmentCount - 1)));
+	return *first <= *last;
+}
+
+bool b2HeightfieldShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
+{
+	B2_NOT_USED(xf);
+	B2_NOT_USED(p);
+	return false;
+}
+
+bool b2HeightfieldShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+								const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	// Only the segments under the ray in local space can be hit
+	b2Vec2 p1 = b2MulT(xf, input.p1);
+	b2Vec2 p2 = b2MulT(xf, input.p2);
+	b2Vec2 p = p1 + input.maxFraction * (p2 - p1);
+
+	if (b2Min(p1.y, p.y) > m_maxHeight + m_radius)
+	{
+		return false;
+	}
+
+	int32 first, last;
+	if (GetSegmentRange(b2Min(p1.x, p.x), b2Max(p1.x, p.x), &first, &last) == false)
+	{
+		return false;
+	}
+
+	b2EdgeShape edge;
+	b2RayCastInput subInput = input;
+	bool hit = false;
+
+	for (int32 i = first; i <= last; ++i)
+	{
+		edge.m_vertex1 = GetVertex(i);
+		edge.m_vertex2 = GetVertex(i + 1);
+
+		b2RayCastOutput subOutput;
+		if (edge.RayCast(&subOutput, subInput, xf, 0))
+		{
+			// Only look for closer hits from here on
+			*output = subOutput;
+			subInput.maxFraction = subOutput.fraction;
+			hit = true;
+		}
+	}
+
+	return hit;
+}
+
+void b2HeightfieldShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	float32 x1 = m_originX;
+	float32 x2 = m_originX + (m_count - 1) * m_spacing;
+
+	b2Vec2 v1 = b2Mul(xf, b2Vec2(x1, m_minHeight));
+	b2Vec2 v2 = b2Mul(xf, b2Vec2(x2, m_minHeight));
+	b2Vec2 v3 = b2Mul(xf, b2Vec2(x2, m_maxHeight));
+	b2Vec2 v4 = b2Mul(xf, b2Vec2(x1, m_maxHeight));
+
+	b2Vec2 r(m_radius, m_radius);
+	aabb->lowerBound = b2Min(b2Min(v1, v2), b2Min(v3, v4)) - r;
+	aabb->upperBound = b2Max(b2Max(v1, v2), b2Max(v3, v4)) + r;
+}
+
+void b2HeightfieldShape::ComputeMass(b2MassData* massData, float32 density) const
+{
+	B2_NOT_USED(density);
+
+	massData->mass = 0.0f;
+	massData->center.SetZero();
+	massData->I = 0.0f;
+}
+
+float32 b2HeightfieldShape::ComputeSubmergedArea(const b2Vec2& normal, float32 offset,
+												const b2Transform& xf, b2Vec2* c) const
+{
+	B2_NOT_USED(normal);
+	B2_NOT_USED(offset);
+	B2_NOT_USED(xf);
+	B2_NOT_USED(c);
+
+	// Heightfields have no area.
+	return 0.0f;
+}
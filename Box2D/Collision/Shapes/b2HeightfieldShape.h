@@ -0,0 +1,142 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_HEIGHTFIELD_SHAPE_H
+#define B2_HEIGHTFIELD_SHAPE_H
+
+#include <Box2D/Collision/Shapes/b2Shape.h>
+#include <Box2D/Common/b2Allocator.h>
+
+class b2EdgeShape;
+
+/// A heightfield is a chain of line segments over evenly spaced samples along
+/// the local x-axis. Sample i is at (originX + i * spacing, heights[i]).
+/// Unlike a chain, a heightfield is a single child with a single broad-phase
+/// proxy. The segments near another shape are found by index arithmetic and
+/// collided in one contact, so a body sliding over the heightfield has one
+/// contact instead of one per segment.
+/// The heights are allocated like chain vertices. Like chains, heightfields have
+/// zero mass and are meant for static bodies.
+class b2HeightfieldShape : public b2Shape
+{
+public:
+	b2HeightfieldShape();
+
+	/// The destructor frees the heights.
+	~b2HeightfieldShape();
+
+	/// Create the heightfield.
+	/// @param heights an array of heights, these are copied
+	/// @param count the height count, at least 2
+	/// @param originX the local x of the first sample
+	/// @param spacing the distance between samples along x, must be positive
+	void Create(const float32* heights, int32 count, float32 originX, float32 spacing);
+
+	/// Establish connectivity to a sample that precedes the first sample.
+	void SetPrevHeight(float32 prevHeight);
+
+	/// Establish connectivity to a sample that follows the last sample.
+	void SetNextHeight(float32 nextHeight);
+
+	/// Implement b2Shape. Heights are cloned using the allocator behind the block allocator.
+	b2Shape* Clone(b2BlockAllocator* allocator) const;
+
+	/// A heightfield is one child.
+	/// @see b2Shape::GetChildCount
+	int32 GetChildCount() const;
+
+	/// Get the number of segments.
+	int32 GetSegmentCount() const;
+
+	/// Get the local position of a sample.
+	b2Vec2 GetVertex(int32 index) const;
+
+	/// Get a segment as an edge with its neighbors as ghost vertices.
+	void GetSegment(b2EdgeShape* edge, int32 index) const;
+
+	/// Get the range of segments that overlap a local x range.
+	/// @return false if there are none.
+	bool GetSegmentRange(float32 lowerX, float32 upperX, int32* first, int32* last) const;
+
+	/// This always return false.
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2Transform& transform, const b2Vec2& p) const;
+
+	/// Implement b2Shape. Reports the closest segment hit.
+	bool RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+					const b2Transform& transform, int32 childIndex) const;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2Transform& transform, int32 childIndex) const;
+
+	/// Heightfields have zero mass.
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float32 density) const;
+
+	/// @see b2Shape::ComputeSubmergedArea
+	float32 ComputeSubmergedArea(const b2Vec2& normal, float32 offset,
+								const b2Transform& xf, b2Vec2* c) const;
+
+	/// Provides the heights.
+	b2Allocator* m_allocator;
+
+	/// The heights. Owned by this class.
+	float32* m_heights;
+
+	/// The height count.
+	int32 m_count;
+
+	float32 m_originX;
+	float32 m_spacing;
+
+	/// The range of the heights.
+	float32 m_minHeight, m_maxHeight;
+
+	float32 m_prevHeight, m_nextHeight;
+	bool m_hasPrevHeight, m_hasNextHeight;
+};
+
+inline b2HeightfieldShape::b2HeightfieldShape()
+{
+	m_type = e_heightfield;
+	m_radius = b2_polygonRadius;
+	m_allocator = b2GetDefaultAllocator();
+	m_heights = NULL;
+	m_count = 0;
+	m_originX = 0.0f;
+	m_spacing = 1.0f;
+	m_minHeight = 0.0f;
+	m_maxHeight = 0.0f;
+	m_prevHeight = 0.0f;
+	m_nextHeight = 0.0f;
+	m_hasPrevHeight = false;
+	m_hasNextHeight = false;
+}
+
+inline int32 b2HeightfieldShape::GetSegmentCount() const
+{
+	return m_count - 1;
+}
+
+inline b2Vec2 b2HeightfieldShape::GetVertex(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count);
+	return b2Vec2(m_originX + index * m_spacing, m_heights[index]);
+}
+
+#endif
@@ -430,6 +430,122 @@ void b2PolygonShape::ComputeMass(b2MassData* massData, float32 density) const
 	massData->I += massData->mass * (b2Dot(massData->center, massData->center) - b2Dot(center, center));
 }
 
+float32 b2PolygonShape::ComputeSubmergedArea(const b2Vec2& normal, float32 offset,
+											const b2Transform& xf, b2Vec2* c) const
+{
+	// Transform the plane into shape coordinates.
+	b2Vec2 normalL = b2MulT(xf.q, normal);
+	float32 offsetL = offset - b2Dot(normal, xf.p);
+
+	float32 depths[b2_maxPolygonVertices];
+	int32 diveCount = 0;
+	int32 intoIndex = -1;
+	int32 outoIndex = -1;
+
+	bool lastSubmerged = false;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		depths[i] = b2Dot(normalL, m_vertices[i]) - offsetL;
+		bool isSubmerged = depths[i] < -b2_epsilon;
+		if (i > 0)
+		{
+			if (isSubmerged)
+			{
+				if (lastSubmerged == false)
+				{
+					intoIndex = i - 1;
+					++diveCount;
+				}
+			}
+			else
+			{
+				if (lastSubmerged)
+				{
+					outoIndex = i - 1;
+					++diveCount;
+				}
+			}
+		}
+		lastSubmerged = isSubmerged;
+	}
+
+	switch (diveCount)
+	{
+	case 0:
+		if (lastSubmerged)
+		{
+			// Completely submerged
+			b2MassData md;
+			ComputeMass(&md, 1.0f);
+			*c = b2Mul(xf, md.center);
+			return md.mass;
+		}
+		
+		// Completely dry
+		return 0.0f;
+
+	case 1:
+		// The other crossing is on the closing edge.
+		if (intoIndex == -1)
+		{
+			intoIndex = m_count - 1;
+		}
+		else
+		{
+			outoIndex = m_count - 1;
+		}
+		break;
+	}
+
+	int32 intoIndex2 = (intoIndex + 1) % m_count;
+	int32 outoIndex2 = (outoIndex + 1) % m_count;
+
+	float32 intoLambda = (0.0f - depths[intoIndex]) / (depths[intoIndex2] - depths[intoIndex]);
+	float32 outoLambda = (0.0f - depths[outoIndex]) / (depths[outoIndex2] - depths[outoIndex]);
+
+	b2Vec2 intoVec = (1.0f - intoLambda) * m_vertices[intoIndex] + intoLambda * m_vertices[intoIndex2];
+	b2Vec2 outoVec = (1.0f - outoLambda) * m_vertices[outoIndex] + outoLambda * m_vertices[outoIndex2];
+
+	// Fan triangulate the submerged polygon from the entry point.
+	float32 area = 0.0f;
+	b2Vec2 center(0.0f, 0.0f);
+	b2Vec2 p2 = m_vertices[intoIndex2];
+	b2Vec2 p3;
+
+	const float32 k_inv3 = 1.0f / 3.0f;
+
+	int32 i = intoIndex2;
+	while (i != outoIndex2)
+	{
+		i = (i + 1) % m_count;
+		if (i == outoIndex2)
+		{
+			p3 = outoVec;
+		}
+		else
+		{
+			p3 = m_vertices[i];
+		}
+
+		b2Vec2 e1 = p2 - intoVec;
+		b2Vec2 e2 = p3 - intoVec;
+		float32 triangleArea = 0.5f * b2Cross(e1, e2);
+		area += triangleArea;
+		center += (triangleArea * k_inv3) * (intoVec + p2 + p3);
+
+		p2 = p3;
+	}
+
+	if (area <= b2_epsilon)
+	{
+		return 0.0f;
+	}
+
+	center *= 1.0f / area;
+	*c = b2Mul(xf, center);
+	return area;
+}
+
 bool b2PolygonShape::Validate() const
 {
 	for (int32 i = 0; i < m_count; ++i)
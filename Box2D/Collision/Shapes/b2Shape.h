@@ -49,7 +49,8 @@ public:
 		e_edge = 1,
 		e_polygon = 2,
 		e_chain = 3,
-		e_typeCount = 4
+		e_heightfield = 4,
+		e_typeCount = 5
 	};
 
 	virtual ~b2Shape() {}
@@ -89,6 +90,16 @@ public:
 	/// @param density the density in kilograms per meter squared.
 	virtual void ComputeMass(b2MassData* massData, float32 density) const = 0;
 
+	/// Compute the area and centroid of the part of this shape that lies below a plane.
+	/// This is used by the buoyancy controller.
+	/// @param normal the world plane normal, pointing out of the fluid.
+	/// @param offset the plane offset along the normal.
+	/// @param xf the shape world transform.
+	/// @param c returns the world centroid of the submerged part.
+	/// @return the submerged area.
+	virtual float32 ComputeSubmergedArea(const b2Vec2& normal, float32 offset,
+										const b2Transform& xf, b2Vec2* c) const = 0;
+
 	Type m_type;
 	float32 m_radius;
 };
@@ -17,24 +17,26 @@
 */
 
 #include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Common/b2Allocator.h>
 
-b2BroadPhase::b2BroadPhase()
+b2BroadPhase::b2BroadPhase(b2Allocator* allocator)
+	: m_allocator(allocator ? allocator : b2GetDefaultAllocator()), m_tree(m_allocator)
 {
 	m_proxyCount = 0;
 
 	m_pairCapacity = 16;
 	m_pairCount = 0;
-	m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
+	m_pairBuffer = (b2Pair*)m_allocator->Allocate(m_pairCapacity * sizeof(b2Pair), "b2BroadPhase pair buffer");
 
 	m_moveCapacity = 16;
 	m_moveCount = 0;
-	m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+	m_moveBuffer = (int32*)m_allocator->Allocate(m_moveCapacity * sizeof(int32), "b2BroadPhase move buffer");
 }
 
 b2BroadPhase::~b2BroadPhase()
 {
-	b2Free(m_moveBuffer);
-	b2Free(m_pairBuffer);
+	m_allocator->Free(m_moveBuffer, m_moveCapacity * sizeof(int32), "b2BroadPhase move buffer");
+	m_allocator->Free(m_pairBuffer, m_pairCapacity * sizeof(b2Pair), "b2BroadPhase pair buffer");
 }
 
 int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
@@ -72,9 +74,9 @@ void b2BroadPhase::BufferMove(int32 proxyId)
 	{
 		int32* oldBuffer = m_moveBuffer;
 		m_moveCapacity *= 2;
-		m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+		m_moveBuffer = (int32*)m_allocator->Allocate(m_moveCapacity * sizeof(int32), "b2BroadPhase move buffer");
 		memcpy(m_moveBuffer, oldBuffer, m_moveCount * sizeof(int32));
-		b2Free(oldBuffer);
+		m_allocator->Free(oldBuffer, m_moveCount * sizeof(int32), "b2BroadPhase move buffer");
 	}
 
 	m_moveBuffer[m_moveCount] = proxyId;
@@ -92,6 +94,31 @@ void b2BroadPhase::UnBufferMove(int32 proxyId)
 	}
 }
 
+void b2BroadPhase::Reserve(int32 proxyCount, int32 pairCount)
+{
+	m_tree.Reserve(2 * proxyCount);
+
+	if (proxyCount > m_moveCapacity)
+	{
+		int32* oldBuffer = m_moveBuffer;
+		int32 oldCapacity = m_moveCapacity;
+		m_moveCapacity = proxyCount;
+		m_moveBuffer = (int32*)m_allocator->Allocate(m_moveCapacity * sizeof(int32), "b2BroadPhase move buffer");
+		memcpy(m_moveBuffer, oldBuffer, m_moveCount * sizeof(int32));
+		m_allocator->Free(oldBuffer, oldCapacity * sizeof(int32), "b2BroadPhase move buffer");
+	}
+
+	if (pairCount > m_pairCapacity)
+	{
+		b2Pair* oldBuffer = m_pairBuffer;
+		int32 oldCapacity = m_pairCapacity;
+		m_pairCapacity = pairCount;
+		m_pairBuffer = (b2Pair*)m_allocator->Allocate(m_pairCapacity * sizeof(b2Pair), "b2BroadPhase pair buffer");
+		memcpy(m_pairBuffer, oldBuffer, m_pairCount * sizeof(b2Pair));
+		m_allocator->Free(oldBuffer, oldCapacity * sizeof(b2Pair), "b2BroadPhase pair buffer");
+	}
+}
+
 // This is called from b2DynamicTree::Query when we are gathering pairs.
 bool b2BroadPhase::QueryCallback(int32 proxyId)
 {
@@ -106,9 +133,9 @@ bool b2BroadPhase::QueryCallback(int32 proxyId)
 	{
 		b2Pair* oldBuffer = m_pairBuffer;
 		m_pairCapacity *= 2;
-		m_pairBuffer = (b2Pair*)b2Alloc(m_pairCapacity * sizeof(b2Pair));
+		m_pairBuffer = (b2Pair*)m_allocator->Allocate(m_pairCapacity * sizeof(b2Pair), "b2BroadPhase pair buffer");
 		memcpy(m_pairBuffer, oldBuffer, m_pairCount * sizeof(b2Pair));
-		b2Free(oldBuffer);
+		m_allocator->Free(oldBuffer, m_pairCount * sizeof(b2Pair), "b2BroadPhase pair buffer");
 	}
 
 	m_pairBuffer[m_pairCount].proxyIdA = b2Min(proxyId, m_queryProxyId);
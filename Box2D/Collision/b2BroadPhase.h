@@ -42,7 +42,8 @@ public:
 		e_nullProxy = -1
 	};
 
-	b2BroadPhase();
+	/// @param allocator provides the tree and buffers, or NULL to use b2Alloc.
+	b2BroadPhase(b2Allocator* allocator = NULL);
 	~b2BroadPhase();
 
 	/// Create a proxy with an initial AABB. Pairs are not reported until
@@ -104,6 +105,10 @@ public:
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Size the tree and the move buffer for proxyCount proxies and the pair
+	/// buffer for pairCount pairs per update, so they don't grow later.
+	void Reserve(int32 proxyCount, int32 pairCount);
+
 private:
 
 	friend class b2DynamicTree;
@@ -113,6 +118,8 @@ private:
 
 	bool QueryCallback(int32 proxyId);
 
+	b2Allocator* m_allocator;
+
 	b2DynamicTree m_tree;
 
 	int32 m_proxyCount;
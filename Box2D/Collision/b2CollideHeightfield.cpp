@@ -0,0 +1,303 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Collision/b2Collision.h>
+#include <Box2D/Collision/b2Distance.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+#include <Box2D/Collision/Shapes/b2HeightfieldShape.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
+
+// Find the segments of the heightfield under a shape with the given bounds in
+// the heightfield frame.
+static bool b2FindSegments(int32* first, int32* last, const b2HeightfieldShape* heightfield, const b2AABB& box)
+{
+	float32 radius = heightfield->m_radius;
+	if (box.lowerBound.y > heightfield->m_maxHeight + radius)
+	{
+		return false;
+	}
+
+	return heightfield->GetSegmentRange(box.lowerBound.x - radius, box.upperBound.x + radius, first, last);
+}
+
+// Is the segment entirely below the box?
+static bool b2IsSegmentBelow(const b2HeightfieldShape* heightfield, int32 index, const b2AABB& box)
+{
+	float32 top = b2Max(heightfield->m_heights[index], heightfield->m_heights[index + 1]);
+	return top + heightfield->m_radius < box.lowerBound.y;
+}
+
+static float32 b2GetMinSeparation(const b2Manifold* manifold,
+								  const b2Transform& xfA, float32 radiusA,
+								  const b2Transform& xfB, float32 radiusB)
+{
+	b2WorldManifold worldManifold;
+	worldManifold.Initialize(manifold, xfA, radiusA, xfB, radiusB);
+
+	float32 separation = b2_maxFloat;
+	for (int32 i = 0; i < manifold->pointCount; ++i)
+	{
+		separation = b2Min(separation, worldManifold.separations[i]);
+	}
+	return separation;
+}
+
+// Add the points of manifold2 to manifold1. Both must be face A manifolds with
+// about the same normal. The points are measured against the plane of
+// manifold1. The deepest point is kept along with the point farthest from it
+// along the face, so a shape resting across many segments keeps its full
+// support and its corner ids stay the same from step to step.
+static void b2MergeManifolds(b2Manifold* manifold1, const b2Manifold* manifold2, const b2Transform& xf)
+{
+	const int32 maxCount = 2 * b2_maxManifoldPoints;
+	b2ManifoldPoint points[maxCount];
+	float32 separations[maxCount];
+	float32 offsets[maxCount];
+	int32 count = 0;
+
+	b2Vec2 tangent = b2Cross(manifold1->localNormal, 1.0f);
+
+	const b2Manifold* manifolds[2] = { manifold1, manifold2 };
+	for (int32 i = 0; i < 2; ++i)
+	{
+		for (int32 j = 0; j < manifolds[i]->pointCount; ++j)
+		{
+			const b2ManifoldPoint& mp = manifolds[i]->points[j];
+
+			// The same polygon point can come from both segments
+			bool duplicate = false;
+			for (int32 k = 0; k < count; ++k)
+			{
+				if (b2DistanceSquared(points[k].localPoint, mp.localPoint) < b2_linearSlop * b2_linearSlop)
+				{
+					duplicate = true;
+					break;
+				}
+			}
+
+			if (duplicate)
+			{
+				continue;
+			}
+
+			// Points are in the frame of B, the plane is in the frame of A
+			b2Vec2 d = b2Mul(xf, mp.localPoint) - manifold1->localPoint;
+			points[count] = mp;
+			separations[count] = b2Dot(d, manifold1->localNormal);
+			offsets[count] = b2Dot(d, tangent);
+			++count;
+		}
+	}
+
+	if (count == 0)
+	{
+		manifold1->pointCount = 0;
+		return;
+	}
+
+	int32 deepest = 0;
+	for (int32 i = 1; i < count; ++i)
+	{
+		if (separations[i] < separations[deepest])
+		{
+			deepest = i;
+		}
+	}
+
+	int32 farthest = deepest;
+	float32 maxOffset = 0.0f;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 offset = b2Abs(offsets[i] - offsets[deepest]);
+		if (offset > maxOffset)
+		{
+			farthest = i;
+			maxOffset = offset;
+		}
+	}
+
+	manifold1->points[0] = points[deepest];
+	manifold1->pointCount = 1;
+	if (farthest != deepest)
+	{
+		manifold1->points[1] = points[farthest];
+		manifold1->pointCount = 2;
+	}
+}
+
+void b2CollideHeightfieldAndCircle(b2Manifold* manifold,
+								   const b2HeightfieldShape* heightfieldA, const b2Transform& xfA,
+								   const b2CircleShape* circleB, const b2Transform& xfB)
+{
+	manifold->pointCount = 0;
+
+	b2Transform xf = b2MulT(xfA, xfB);
+	b2AABB box;
+	circleB->ComputeAABB(&box, xf, 0);
+
+	int32 first, last;
+	if (b2FindSegments(&first, &last, heightfieldA, box) == false)
+	{
+		return;
+	}
+
+	float32 radiusA = heightfieldA->m_radius;
+	float32 radiusB = circleB->m_radius;
+	float32 bestSeparation = b2_maxFloat;
+
+	b2EdgeShape edge;
+	for (int32 i = first; i <= last; ++i)
+	{
+		if (b2IsSegmentBelow(heightfieldA, i, box))
+		{
+			continue;
+		}
+
+		heightfieldA->GetSegment(&edge, i);
+
+		b2Manifold segmentManifold;
+		b2CollideEdgeAndCircle(&segmentManifold, &edge, xfA, circleB, xfB);
+		if (segmentManifold.pointCount == 0)
+		{
+			continue;
+		}
+
+		// A circle touches in one point, keep the deepest
+		float32 separation = b2GetMinSeparation(&segmentManifold, xfA, radiusA, xfB, radiusB);
+		if (separation < bestSeparation)
+		{
+			*manifold = segmentManifold;
+			bestSeparation = separation;
+		}
+	}
+}
+
+void b2CollideHeightfieldAndPolygon(b2Manifold* manifold,
+									const b2HeightfieldShape* heightfieldA, const b2Transform& xfA,
+									const b2PolygonShape* polygonB, const b2Transform& xfB)
+{
+	manifold->pointCount = 0;
+
+	b2Transform xf = b2MulT(xfA, xfB);
+	b2AABB box;
+	polygonB->ComputeAABB(&box, xf, 0);
+
+	int32 first, last;
+	if (b2FindSegments(&first, &last, heightfieldA, box) == false)
+	{
+		return;
+	}
+
+	// Segments within the angular slop of each other are treated as one face
+	const float32 mergeTolerance = cosf(b2_angularSlop);
+
+	float32 radiusA = heightfieldA->m_radius;
+	float32 radiusB = polygonB->m_radius;
+	float32 bestSeparation = b2_maxFloat;
+
+	b2EdgeShape edge;
+	for (int32 i = first; i <= last; ++i)
+	{
+		if (b2IsSegmentBelow(heightfieldA, i, box))
+		{
+			continue;
+		}
+
+		heightfieldA->GetSegment(&edge, i);
+
+		b2Manifold segmentManifold;
+		b2CollideEdgeAndPolygon(&segmentManifold, &edge, xfA, polygonB, xfB);
+		if (segmentManifold.pointCount == 0)
+		{
+			continue;
+		}
+
+		float32 separation = b2GetMinSeparation(&segmentManifold, xfA, radiusA, xfB, radiusB);
+
+		bool mergeable = manifold->pointCount > 0 &&
+			manifold->type == b2Manifold::e_faceA &&
+			segmentManifold.type == b2Manifold::e_faceA &&
+			b2Dot(manifold->localNormal, segmentManifold.localNormal) >= mergeTolerance;
+
+		if (mergeable)
+		{
+			// Measure against the plane of the deeper segment
+			if (separation < bestSeparation)
+			{
+				b2MergeManifolds(&segmentManifold, manifold, xf);
+				*manifold = segmentManifold;
+				bestSeparation = separation;
+			}
+			else
+			{
+				b2MergeManifolds(manifold, &segmentManifold, xf);
+			}
+		}
+		else if (separation < bestSeparation)
+		{
+			// A segment facing another way. Only the deepest face is kept.
+			*manifold = segmentManifold;
+			bestSeparation = separation;
+		}
+	}
+}
+
+bool b2TestHeightfieldOverlap(const b2HeightfieldShape* heightfieldA, const b2Transform& xfA,
+							  const b2Shape* shapeB, int32 indexB, const b2Transform& xfB)
+{
+	b2Transform xf = b2MulT(xfA, xfB);
+	b2AABB box;
+	shapeB->ComputeAABB(&box, xf, indexB);
+
+	int32 first, last;
+	if (b2FindSegments(&first, &last, heightfieldA, box) == false)
+	{
+		return false;
+	}
+
+	b2DistanceInput input;
+	input.proxyB.Set(shapeB, indexB);
+	input.transformA = xfA;
+	input.transformB = xfB;
+	input.useRadii = true;
+
+	for (int32 i = first; i <= last; ++i)
+	{
+		if (b2IsSegmentBelow(heightfieldA, i, box))
+		{
+			continue;
+		}
+
+		// The distance proxy of a heightfield is one segment
+		input.proxyA.Set(heightfieldA, i);
+
+		b2SimplexCache cache;
+		cache.count = 0;
+
+		b2DistanceOutput output;
+		b2Distance(&output, &cache, &input);
+
+		if (output.distance < 10.0f * b2_epsilon)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
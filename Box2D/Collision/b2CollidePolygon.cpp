@@ -19,37 +19,44 @@
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 
+// Get the vertices of a polygon in another frame as separate x and y arrays.
+static void b2GetVertices(float32* xs, float32* ys, const b2PolygonShape* poly, const b2Transform& xf)
+{
+	int32 count = poly->m_count;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Vec2 v = b2Mul(xf, poly->m_vertices[i]);
+		xs[i] = v.x;
+		ys[i] = v.y;
+	}
+}
+
+// Separation of poly2 from edge i of poly1. The vertices of poly2 are in poly1's frame.
+static float32 b2EdgeSeparation(const b2PolygonShape* poly1, int32 i,
+								const float32* xs2, const float32* ys2, int32 count2)
+{
+	b2Vec2 n = poly1->m_normals[i];
+	float32 s = b2_maxFloat;
+	for (int32 j = 0; j < count2; ++j)
+	{
+		float32 sj = n.x * xs2[j] + n.y * ys2[j];
+		s = sj < s ? sj : s;
+	}
+	return s - b2Dot(n, poly1->m_vertices[i]);
+}
+
 // Find the max separation between poly1 and poly2 using edge normals from poly1.
-static float32 b2FindMaxSeparation(int32* edgeIndex,
-								 const b2PolygonShape* poly1, const b2Transform& xf1,
-								 const b2PolygonShape* poly2, const b2Transform& xf2)
+// The vertices of poly2 are in poly1's frame.
+static float32 b2FindMaxSeparation(int32* edgeIndex, const b2PolygonShape* poly1,
+								   const float32* xs2, const float32* ys2, int32 count2)
 {
 	int32 count1 = poly1->m_count;
-	int32 count2 = poly2->m_count;
-	const b2Vec2* n1s = poly1->m_normals;
-	const b2Vec2* v1s = poly1->m_vertices;
-	const b2Vec2* v2s = poly2->m_vertices;
-	b2Transform xf = b2MulT(xf2, xf1);
 
 	int32 bestIndex = 0;
 	float32 maxSeparation = -b2_maxFloat;
 	for (int32 i = 0; i < count1; ++i)
 	{
-		// Get poly1 normal in frame2.
-		b2Vec2 n = b2Mul(xf.q, n1s[i]);
-		b2Vec2 v1 = b2Mul(xf, v1s[i]);
-
-		// Find deepest point for normal i.
-		float32 si = b2_maxFloat;
-		for (int32 j = 0; j < count2; ++j)
-		{
-			float32 sij = b2Dot(n, v2s[j] - v1);
-			if (sij < si)
-			{
-				si = sij;
-			}
-		}
-
+		float32 si = b2EdgeSeparation(poly1, i, xs2, ys2, count2);
 		if (si > maxSeparation)
 		{
 			maxSeparation = si;
@@ -112,23 +119,66 @@ static void b2FindIncidentEdge(b2ClipVertex c[2],
 // Find incident edge
 // Clip
 
-// The normal points from 1 to 2
 void b2CollidePolygons(b2Manifold* manifold,
 					  const b2PolygonShape* polyA, const b2Transform& xfA,
 					  const b2PolygonShape* polyB, const b2Transform& xfB)
+{
+	b2SATCache cache;
+	cache.type = b2SATCache::e_empty;
+	cache.index = 0;
+	b2CollidePolygons(manifold, polyA, xfA, polyB, xfB, &cache);
+}
+
+// The normal points from 1 to 2
+void b2CollidePolygons(b2Manifold* manifold,
+					  const b2PolygonShape* polyA, const b2Transform& xfA,
+					  const b2PolygonShape* polyB, const b2Transform& xfB,
+					  b2SATCache* cache)
 {
 	manifold->pointCount = 0;
 	float32 totalRadius = polyA->m_radius + polyB->m_radius;
 
+	// A separating axis found last time usually still separates the polygons.
+	// If so the full search below would also report a separation.
+	float32 xsB[b2_maxPolygonVertices], ysB[b2_maxPolygonVertices];
+	b2GetVertices(xsB, ysB, polyB, b2MulT(xfA, xfB));
+	if (cache->type == b2SATCache::e_faceA && cache->index < polyA->m_count)
+	{
+		if (b2EdgeSeparation(polyA, cache->index, xsB, ysB, polyB->m_count) > totalRadius)
+		{
+			return;
+		}
+	}
+
+	float32 xsA[b2_maxPolygonVertices], ysA[b2_maxPolygonVertices];
+	b2GetVertices(xsA, ysA, polyA, b2MulT(xfB, xfA));
+	if (cache->type == b2SATCache::e_faceB && cache->index < polyB->m_count)
+	{
+		if (b2EdgeSeparation(polyB, cache->index, xsA, ysA, polyA->m_count) > totalRadius)
+		{
+			return;
+		}
+	}
+
+	cache->type = b2SATCache::e_empty;
+
 	int32 edgeA = 0;
-	float32 separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
+	float32 separationA = b2FindMaxSeparation(&edgeA, polyA, xsB, ysB, polyB->m_count);
 	if (separationA > totalRadius)
+	{
+		cache->type = b2SATCache::e_faceA;
+		cache->index = (uint8)edgeA;
 		return;
+	}
 
 	int32 edgeB = 0;
-	float32 separationB = b2FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
+	float32 separationB = b2FindMaxSeparation(&edgeB, polyB, xsA, ysA, polyA->m_count);
 	if (separationB > totalRadius)
+	{
+		cache->type = b2SATCache::e_faceB;
+		cache->index = (uint8)edgeB;
 		return;
+	}
 
 	const b2PolygonShape* poly1;	// reference polygon
 	const b2PolygonShape* poly2;	// incident polygon
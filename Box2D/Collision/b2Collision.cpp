@@ -18,6 +18,7 @@
 
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Collision/b2Distance.h>
+#include <Box2D/Collision/Shapes/b2Shape.h>
 
 void b2WorldManifold::Initialize(const b2Manifold* manifold,
 						  const b2Transform& xfA, float32 radiusA,
@@ -234,6 +235,17 @@ bool b2TestOverlap(	const b2Shape* shapeA, int32 indexA,
 					const b2Shape* shapeB, int32 indexB,
 					const b2Transform& xfA, const b2Transform& xfB)
 {
+	// The child index of a heightfield is always 0, the segments are found here.
+	if (shapeA->GetType() == b2Shape::e_heightfield)
+	{
+		return b2TestHeightfieldOverlap((const b2HeightfieldShape*)shapeA, xfA, shapeB, indexB, xfB);
+	}
+
+	if (shapeB->GetType() == b2Shape::e_heightfield)
+	{
+		return b2TestHeightfieldOverlap((const b2HeightfieldShape*)shapeB, xfB, shapeA, indexA, xfA);
+	}
+
 	b2DistanceInput input;
 	input.proxyA.Set(shapeA, indexA);
 	input.proxyB.Set(shapeB, indexB);
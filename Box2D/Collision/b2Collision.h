@@ -30,9 +30,33 @@ class b2Shape;
 class b2CircleShape;
 class b2EdgeShape;
 class b2PolygonShape;
+class b2HeightfieldShape;
 
 const uint8 b2_nullFeature = UCHAR_MAX;
 
+/// This holds contact filtering data.
+struct b2Filter
+{
+	b2Filter()
+	{
+		categoryBits = 0x0001;
+		maskBits = 0xFFFF;
+		groupIndex = 0;
+	}
+
+	/// The collision category bits. Normally you would just set one bit.
+	uint16 categoryBits;
+
+	/// The collision mask bits. This states the categories that this
+	/// shape would accept for collision.
+	uint16 maskBits;
+
+	/// Collision groups allow a certain group of objects to never collide (negative)
+	/// or always collide (positive). Zero means no collision group. Non-zero group
+	/// filtering always wins against the mask bits.
+	int16 groupIndex;
+};
+
 /// The features that intersect to form the contact point
 /// This must be 4 bytes or less.
 struct b2ContactFeature
@@ -215,6 +239,22 @@ struct b2AABB
 	b2Vec2 upperBound;	///< the upper vertex
 };
 
+/// Remembers the separating axis found by b2CollidePolygons. While that axis
+/// still separates the polygons, the next call tests only this axis instead
+/// of every edge normal of both polygons. Start with type e_empty.
+struct b2SATCache
+{
+	enum Type
+	{
+		e_empty,
+		e_faceA,
+		e_faceB
+	};
+
+	uint8 type;		///< b2SATCache::Type
+	uint8 index;	///< the edge of the separating axis
+};
+
 /// Compute the collision manifold between two circles.
 void b2CollideCircles(b2Manifold* manifold,
 					  const b2CircleShape* circleA, const b2Transform& xfA,
@@ -230,6 +270,13 @@ void b2CollidePolygons(b2Manifold* manifold,
 					   const b2PolygonShape* polygonA, const b2Transform& xfA,
 					   const b2PolygonShape* polygonB, const b2Transform& xfB);
 
+/// Compute the collision manifold between two polygons, starting from the
+/// separating axis of the previous call for the same pair.
+void b2CollidePolygons(b2Manifold* manifold,
+					   const b2PolygonShape* polygonA, const b2Transform& xfA,
+					   const b2PolygonShape* polygonB, const b2Transform& xfB,
+					   b2SATCache* cache);
+
 /// Compute the collision manifold between an edge and a circle.
 void b2CollideEdgeAndCircle(b2Manifold* manifold,
 							   const b2EdgeShape* polygonA, const b2Transform& xfA,
@@ -240,11 +287,29 @@ void b2CollideEdgeAndPolygon(b2Manifold* manifold,
 							   const b2EdgeShape* edgeA, const b2Transform& xfA,
 							   const b2PolygonShape* circleB, const b2Transform& xfB);
 
+/// Compute the collision manifold between a heightfield and a circle. Only the
+/// deepest of the segments under the circle produces the manifold.
+void b2CollideHeightfieldAndCircle(b2Manifold* manifold,
+								   const b2HeightfieldShape* heightfieldA, const b2Transform& xfA,
+								   const b2CircleShape* circleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a heightfield and a polygon. The points
+/// of segments that face the same way as the deepest one are merged into its manifold.
+void b2CollideHeightfieldAndPolygon(b2Manifold* manifold,
+									const b2HeightfieldShape* heightfieldA, const b2Transform& xfA,
+									const b2PolygonShape* polygonB, const b2Transform& xfB);
+
+/// Determine if a heightfield and child indexB of shapeB overlap. Only the
+/// segments under the bounds of shapeB are tested.
+bool b2TestHeightfieldOverlap(const b2HeightfieldShape* heightfieldA, const b2Transform& xfA,
+							  const b2Shape* shapeB, int32 indexB, const b2Transform& xfB);
+
 /// Clipping for contact manifolds.
 int32 b2ClipSegmentToLine(b2ClipVertex vOut[2], const b2ClipVertex vIn[2],
 							const b2Vec2& normal, float32 offset, int32 vertexIndexA);
 
-/// Determine if two generic shapes overlap.
+/// Determine if two generic shapes overlap. A heightfield is one child, all
+/// of its segments are tested.
 bool b2TestOverlap(	const b2Shape* shapeA, int32 indexA,
 					const b2Shape* shapeB, int32 indexB,
 					const b2Transform& xfA, const b2Transform& xfB);
@@ -20,6 +20,7 @@
 #include <Box2D/Collision/Shapes/b2CircleShape.h>
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2HeightfieldShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 
 // GJK using Voronoi regions (Christer Ericson) and Barycentric coordinates.
@@ -68,6 +69,21 @@ void b2DistanceProxy::Set(const b2Shape* shape, int32 index)
 		}
 		break;
 
+	case b2Shape::e_heightfield:
+		{
+			// The index is a segment, like for chains
+			const b2HeightfieldShape* heightfield = static_cast<const b2HeightfieldShape*>(shape);
+			b2Assert(0 <= index && index < heightfield->m_count - 1);
+
+			m_buffer[0] = heightfield->GetVertex(index);
+			m_buffer[1] = heightfield->GetVertex(index + 1);
+
+			m_vertices = m_buffer;
+			m_count = 2;
+			m_radius = heightfield->m_radius;
+		}
+		break;
+
 	case b2Shape::e_edge:
 		{
 			const b2EdgeShape* edge = static_cast<const b2EdgeShape*>(shape);
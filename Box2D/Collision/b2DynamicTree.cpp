@@ -17,15 +17,18 @@
 */
 
 #include <Box2D/Collision/b2DynamicTree.h>
+#include <Box2D/Common/b2Allocator.h>
 #include <memory.h>
 
-b2DynamicTree::b2DynamicTree()
+b2DynamicTree::b2DynamicTree(b2Allocator* allocator)
 {
+	m_allocator = allocator ? allocator : b2GetDefaultAllocator();
+
 	m_root = b2_nullNode;
 
 	m_nodeCapacity = 16;
 	m_nodeCount = 0;
-	m_nodes = (b2TreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2TreeNode));
+	m_nodes = (b2TreeNode*)m_allocator->Allocate(m_nodeCapacity * sizeof(b2TreeNode), "b2DynamicTree nodes");
 	memset(m_nodes, 0, m_nodeCapacity * sizeof(b2TreeNode));
 
 	// Build a linked list for the free list.
@@ -46,7 +49,32 @@ b2DynamicTree::b2DynamicTree()
 b2DynamicTree::~b2DynamicTree()
 {
 	// This frees the entire tree in one shot.
-	b2Free(m_nodes);
+	m_allocator->Free(m_nodes, m_nodeCapacity * sizeof(b2TreeNode), "b2DynamicTree nodes");
+}
+
+void b2DynamicTree::Reserve(int32 nodeCapacity)
+{
+	if (nodeCapacity <= m_nodeCapacity)
+	{
+		return;
+	}
+
+	b2TreeNode* oldNodes = m_nodes;
+	int32 oldCapacity = m_nodeCapacity;
+	m_nodeCapacity = nodeCapacity;
+	m_nodes = (b2TreeNode*)m_allocator->Allocate(m_nodeCapacity * sizeof(b2TreeNode), "b2DynamicTree nodes");
+	memcpy(m_nodes, oldNodes, oldCapacity * sizeof(b2TreeNode));
+	m_allocator->Free(oldNodes, oldCapacity * sizeof(b2TreeNode), "b2DynamicTree nodes");
+
+	// Put the new nodes in front of the free list.
+	for (int32 i = oldCapacity; i < m_nodeCapacity - 1; ++i)
+	{
+		m_nodes[i].next = i + 1;
+		m_nodes[i].height = -1;
+	}
+	m_nodes[m_nodeCapacity-1].next = m_freeList;
+	m_nodes[m_nodeCapacity-1].height = -1;
+	m_freeList = oldCapacity;
 }
 
 // Allocate a node from the pool. Grow the pool if necessary.
@@ -59,10 +87,11 @@ int32 b2DynamicTree::AllocateNode()
 
 		// The free list is empty. Rebuild a bigger pool.
 		b2TreeNode* oldNodes = m_nodes;
+		int32 oldCapacity = m_nodeCapacity;
 		m_nodeCapacity *= 2;
-		m_nodes = (b2TreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2TreeNode));
+		m_nodes = (b2TreeNode*)m_allocator->Allocate(m_nodeCapacity * sizeof(b2TreeNode), "b2DynamicTree nodes");
 		memcpy(m_nodes, oldNodes, m_nodeCount * sizeof(b2TreeNode));
-		b2Free(oldNodes);
+		m_allocator->Free(oldNodes, oldCapacity * sizeof(b2TreeNode), "b2DynamicTree nodes");
 
 		// Build a linked list for the free list. The parent
 		// pointer becomes the "next" pointer.
@@ -693,7 +722,8 @@ int32 b2DynamicTree::GetMaxBalance() const
 
 void b2DynamicTree::RebuildBottomUp()
 {
-	int32* nodes = (int32*)b2Alloc(m_nodeCount * sizeof(int32));
+	int32 nodesSize = m_nodeCount * sizeof(int32);
+	int32* nodes = (int32*)m_allocator->Allocate(nodesSize, "b2DynamicTree rebuild");
 	int32 count = 0;
 
 	// Build array of leaves. Free the rest.
@@ -762,7 +792,7 @@ void b2DynamicTree::RebuildBottomUp()
 	}
 
 	m_root = nodes[0];
-	b2Free(nodes);
+	m_allocator->Free(nodes, nodesSize, "b2DynamicTree rebuild");
 
 	Validate();
 }
@@ -22,6 +22,8 @@
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Common/b2GrowableStack.h>
 
+class b2Allocator;
+
 #define b2_nullNode (-1)
 
 /// A node in the dynamic tree. The client does not interact with this directly.
@@ -62,7 +64,8 @@ class b2DynamicTree
 {
 public:
 	/// Constructing the tree initializes the node pool.
-	b2DynamicTree();
+	/// @param allocator provides the node pool, or NULL to use b2Alloc.
+	b2DynamicTree(b2Allocator* allocator = NULL);
 
 	/// Destroy the tree, freeing the node pool.
 	~b2DynamicTree();
@@ -123,6 +126,10 @@ public:
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Grow the node pool so it holds at least nodeCapacity nodes. A tree
+	/// with n proxies uses 2n - 1 nodes.
+	void Reserve(int32 nodeCapacity);
+
 private:
 
 	int32 AllocateNode();
@@ -139,6 +146,8 @@ private:
 	void ValidateStructure(int32 index) const;
 	void ValidateMetrics(int32 index) const;
 
+	b2Allocator* m_allocator;
+
 	int32 m_root;
 
 	b2TreeNode* m_nodes;
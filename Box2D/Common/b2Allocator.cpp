@@ -0,0 +1,340 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2Allocator.h>
+#include <Box2D/Common/b2Math.h>
+#include <string.h>
+
+class b2DefaultAllocator : public b2Allocator
+{
+public:
+	void* Allocate(int32 size, const char* tag)
+	{
+		B2_NOT_USED(tag);
+		return b2Alloc(size);
+	}
+
+	void Free(void* mem, int32 size, const char* tag)
+	{
+		B2_NOT_USED(size);
+		B2_NOT_USED(tag);
+		b2Free(mem);
+	}
+};
+
+b2Allocator* b2GetDefaultAllocator()
+{
+	static b2DefaultAllocator s_allocator;
+	return &s_allocator;
+}
+
+// Blocks are at least this big and aligned to it.
+static const int32 b2_arenaAlignment = 16;
+
+// Pages start with a header padded to the alignment.
+static const int32 b2_arenaHeaderSize = (sizeof(int32) + sizeof(void*) + b2_arenaAlignment - 1) & ~(b2_arenaAlignment - 1);
+
+static int32 b2GetSizeClass(int32 size)
+{
+	int32 sizeClass = 0;
+	while ((b2_arenaAlignment << sizeClass) < size)
+	{
+		++sizeClass;
+	}
+	return sizeClass;
+}
+
+b2ArenaAllocator::b2ArenaAllocator(int32 pageSize)
+{
+	b2Assert(pageSize >= 2 * b2_arenaAlignment);
+	m_pageSize = pageSize;
+	m_pages = NULL;
+	m_pageCount = 0;
+	m_reservedBytes = 0;
+	m_top = NULL;
+	m_end = NULL;
+	memset(m_freeLists, 0, sizeof(m_freeLists));
+}
+
+b2ArenaAllocator::~b2ArenaAllocator()
+{
+	b2ArenaPage* page = m_pages;
+	while (page)
+	{
+		b2ArenaPage* next = page->next;
+		b2Free(page);
+		page = next;
+	}
+}
+
+void* b2ArenaAllocator::AllocatePage(int32 size)
+{
+	b2ArenaPage* page = (b2ArenaPage*)b2Alloc(b2_arenaHeaderSize + size);
+	page->next = m_pages;
+	page->size = size;
+	m_pages = page;
+	++m_pageCount;
+	m_reservedBytes += b2_arenaHeaderSize + size;
+	return (char*)page + b2_arenaHeaderSize;
+}
+
+void* b2ArenaAllocator::Allocate(int32 size, const char* tag)
+{
+	B2_NOT_USED(tag);
+
+	if (size == 0)
+	{
+		return NULL;
+	}
+
+	int32 sizeClass = b2GetSizeClass(size);
+	b2Assert(sizeClass < b2_arenaSizeClasses);
+
+	b2ArenaBlock* block = m_freeLists[sizeClass];
+	if (block)
+	{
+		m_freeLists[sizeClass] = block->next;
+		return block;
+	}
+
+	int32 blockSize = b2_arenaAlignment << sizeClass;
+
+	// Big blocks get their own page so they don't waste the rest of one.
+	if (2 * blockSize > m_pageSize)
+	{
+		return AllocatePage(blockSize);
+	}
+
+	if (m_end - m_top < blockSize)
+	{
+		m_top = (char*)AllocatePage(m_pageSize);
+		m_end = m_top + m_pageSize;
+	}
+
+	void* mem = m_top;
+	m_top += blockSize;
+	return mem;
+}
+
+void b2ArenaAllocator::Free(void* mem, int32 size, const char* tag)
+{
+	B2_NOT_USED(tag);
+
+	if (mem == NULL)
+	{
+		return;
+	}
+
+	int32 sizeClass = b2GetSizeClass(size);
+	b2ArenaBlock* block = (b2ArenaBlock*)mem;
+	block->next = m_freeLists[sizeClass];
+	m_freeLists[sizeClass] = block;
+}
+
+b2CountingAllocator::b2CountingAllocator(b2Allocator* allocator)
+{
+	m_allocator = allocator ? allocator : b2GetDefaultAllocator();
+	m_count = 0;
+	m_lastTag = NULL;
+	m_armed = false;
+	m_assert = false;
+}
+
+void b2CountingAllocator::Count(const char* tag)
+{
+	if (m_armed == false)
+	{
+		return;
+	}
+
+	++m_count;
+	m_lastTag = tag;
+
+	if (m_assert)
+	{
+		b2Log("Heap used during a time step: %s\n", tag);
+		b2Assert(false);
+	}
+}
+
+void* b2CountingAllocator::Allocate(int32 size, const char* tag)
+{
+	Count(tag);
+	return m_allocator->Allocate(size, tag);
+}
+
+void b2CountingAllocator::Free(void* mem, int32 size, const char* tag)
+{
+	if (mem)
+	{
+		Count(tag);
+	}
+	m_allocator->Free(mem, size, tag);
+}
+
+b2TracingAllocator::b2TracingAllocator(b2Allocator* allocator)
+{
+	m_allocator = allocator ? allocator : b2GetDefaultAllocator();
+
+	m_recordCount = 0;
+	m_recordCapacity = 0;
+	m_records = NULL;
+
+	m_siteCount = 0;
+	m_siteCapacity = 0;
+	m_sites = NULL;
+
+	m_allocationCount = 0;
+	m_liveBytes = 0;
+	m_peakBytes = 0;
+}
+
+b2TracingAllocator::~b2TracingAllocator()
+{
+	b2Free(m_records);
+	b2Free(m_sites);
+}
+
+int32 b2TracingAllocator::FindSite(const char* tag)
+{
+	for (int32 i = 0; i < m_siteCount; ++i)
+	{
+		if (m_sites[i].tag == tag || strcmp(m_sites[i].tag, tag) == 0)
+		{
+			return i;
+		}
+	}
+
+	if (m_siteCount == m_siteCapacity)
+	{
+		b2AllocationSite* oldSites = m_sites;
+		m_siteCapacity = m_siteCapacity > 0 ? 2 * m_siteCapacity : 16;
+		m_sites = (b2AllocationSite*)b2Alloc(m_siteCapacity * sizeof(b2AllocationSite));
+		if (oldSites)
+		{
+			memcpy(m_sites, oldSites, m_siteCount * sizeof(b2AllocationSite));
+			b2Free(oldSites);
+		}
+	}
+
+	b2AllocationSite* site = m_sites + m_siteCount;
+	memset(site, 0, sizeof(b2AllocationSite));
+	site->tag = tag;
+	return m_siteCount++;
+}
+
+void* b2TracingAllocator::Allocate(int32 size, const char* tag)
+{
+	void* mem = m_allocator->Allocate(size, tag);
+	if (mem == NULL)
+	{
+		return NULL;
+	}
+
+	if (m_recordCount == m_recordCapacity)
+	{
+		b2AllocationRecord* oldRecords = m_records;
+		m_recordCapacity = m_recordCapacity > 0 ? 2 * m_recordCapacity : 64;
+		m_records = (b2AllocationRecord*)b2Alloc(m_recordCapacity * sizeof(b2AllocationRecord));
+		if (oldRecords)
+		{
+			memcpy(m_records, oldRecords, m_recordCount * sizeof(b2AllocationRecord));
+			b2Free(oldRecords);
+		}
+	}
+
+	int32 siteIndex = FindSite(tag);
+	b2AllocationSite* site = m_sites + siteIndex;
+	site->count += 1;
+	site->liveBytes += size;
+	site->totalBytes += size;
+	site->peakBytes = b2Max(site->peakBytes, site->liveBytes);
+
+	b2AllocationRecord* record = m_records + m_recordCount;
+	record->mem = mem;
+	record->size = size;
+	record->site = siteIndex;
+	record->time = m_timer.GetMilliseconds();
+	++m_recordCount;
+
+	++m_allocationCount;
+	m_liveBytes += size;
+	m_peakBytes = b2Max(m_peakBytes, m_liveBytes);
+
+	return mem;
+}
+
+void b2TracingAllocator::Free(void* mem, int32 size, const char* tag)
+{
+	if (mem == NULL)
+	{
+		return;
+	}
+
+	// Memory tends to be freed soon after it is allocated, so search from the back.
+	int32 index = m_recordCount - 1;
+	while (index >= 0 && m_records[index].mem != mem)
+	{
+		--index;
+	}
+
+	b2Assert(index >= 0);
+	if (index >= 0)
+	{
+		b2AllocationRecord* record = m_records + index;
+		b2Assert(record->size == size);
+
+		b2AllocationSite* site = m_sites + record->site;
+		float32 lifetime = m_timer.GetMilliseconds() - record->time;
+		site->freeCount += 1;
+		site->liveBytes -= record->size;
+		site->lifetime += lifetime;
+		site->maxLifetime = b2Max(site->maxLifetime, lifetime);
+
+		m_liveBytes -= record->size;
+
+		*record = m_records[m_recordCount - 1];
+		--m_recordCount;
+	}
+
+	m_allocator->Free(mem, size, tag);
+}
+
+void b2TracingAllocator::ResetPeak()
+{
+	m_peakBytes = m_liveBytes;
+	for (int32 i = 0; i < m_siteCount; ++i)
+	{
+		m_sites[i].peakBytes = m_sites[i].liveBytes;
+	}
+}
+
+void b2TracingAllocator::Dump() const
+{
+	b2Log("allocations: %d, live: %d (%d bytes), peak: %d bytes\n",
+		m_allocationCount, m_recordCount, m_liveBytes, m_peakBytes);
+
+	for (int32 i = 0; i < m_siteCount; ++i)
+	{
+		const b2AllocationSite* site = m_sites + i;
+		float32 meanLifetime = site->freeCount > 0 ? site->lifetime / site->freeCount : 0.0f;
+		b2Log("  %s: count %d, freed %d, live %d bytes, peak %d bytes, total %d bytes, lifetime %.2f ms (max %.2f ms)\n",
+			site->tag, site->count, site->freeCount, site->liveBytes, site->peakBytes, site->totalBytes,
+			meanLifetime, site->maxLifetime);
+	}
+}
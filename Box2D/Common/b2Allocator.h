@@ -0,0 +1,283 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_ALLOCATOR_H
+#define B2_ALLOCATOR_H
+
+#include <Box2D/Common/b2Settings.h>
+#include <Box2D/Common/b2Timer.h>
+
+/// Interface for the heap memory used by a world. The block allocator chunks,
+/// broad-phase buffers, tree nodes, stack overflow and shape arrays of a world
+/// all come from the allocator given to the b2World constructor.
+/// The tag names the call site and is always a string literal.
+class b2Allocator
+{
+public:
+	virtual ~b2Allocator() {}
+
+	/// Allocate size bytes, aligned for any Box2D type.
+	virtual void* Allocate(int32 size, const char* tag) = 0;
+
+	/// Free memory returned by Allocate. The size and tag match the allocation.
+	virtual void Free(void* mem, int32 size, const char* tag) = 0;
+};
+
+/// Get the allocator that forwards to b2Alloc and b2Free. This is used
+/// when no allocator is installed.
+b2Allocator* b2GetDefaultAllocator();
+
+const int32 b2_arenaPageSize = 256 * 1024;
+const int32 b2_arenaSizeClasses = 27;
+
+/// An arena that carves allocations out of large pages. Freed memory goes on
+/// a free list per power of two size and is reused, so a world that has
+/// reached its working set no longer calls b2Alloc. Pages are only returned
+/// when the arena is destroyed, so the arena must outlive the world.
+class b2ArenaAllocator : public b2Allocator
+{
+public:
+	/// @param pageSize the size of the pages requested from b2Alloc.
+	b2ArenaAllocator(int32 pageSize = b2_arenaPageSize);
+
+	/// Release all pages.
+	~b2ArenaAllocator();
+
+	/// Implement b2Allocator.
+	void* Allocate(int32 size, const char* tag);
+
+	/// Implement b2Allocator.
+	void Free(void* mem, int32 size, const char* tag);
+
+	/// Get the number of pages requested from b2Alloc.
+	int32 GetPageCount() const;
+
+	/// Get the number of bytes requested from b2Alloc.
+	int32 GetReservedBytes() const;
+
+private:
+
+	struct b2ArenaPage
+	{
+		b2ArenaPage* next;
+		int32 size;
+	};
+
+	struct b2ArenaBlock
+	{
+		b2ArenaBlock* next;
+	};
+
+	void* AllocatePage(int32 size);
+
+	int32 m_pageSize;
+	b2ArenaPage* m_pages;
+	int32 m_pageCount;
+	int32 m_reservedBytes;
+
+	char* m_top;
+	char* m_end;
+
+	b2ArenaBlock* m_freeLists[b2_arenaSizeClasses];
+};
+
+/// Wraps another allocator and records the size, call site and lifetime of
+/// every allocation. Use Dump to log a summary per call site.
+class b2TracingAllocator : public b2Allocator
+{
+public:
+	/// @param allocator the allocator that provides the memory, or NULL for the default.
+	b2TracingAllocator(b2Allocator* allocator = NULL);
+	~b2TracingAllocator();
+
+	/// Implement b2Allocator.
+	void* Allocate(int32 size, const char* tag);
+
+	/// Implement b2Allocator.
+	void Free(void* mem, int32 size, const char* tag);
+
+	/// Get the number of allocations made so far.
+	int32 GetAllocationCount() const;
+
+	/// Get the number of allocations that have not been freed.
+	int32 GetLiveCount() const;
+
+	/// Get the bytes currently allocated.
+	int32 GetLiveBytes() const;
+
+	/// Get the most bytes allocated at once since construction or ResetPeak.
+	int32 GetPeakBytes() const;
+
+	/// Restart peak tracking from the current live bytes.
+	void ResetPeak();
+
+	/// Log the allocations per call site using b2Log.
+	void Dump() const;
+
+private:
+
+	struct b2AllocationRecord
+	{
+		void* mem;
+		int32 size;
+		int32 site;
+		float32 time;
+	};
+
+	struct b2AllocationSite
+	{
+		const char* tag;
+		int32 count;
+		int32 freeCount;
+		int32 liveBytes;
+		int32 peakBytes;
+		int32 totalBytes;
+		float32 lifetime;
+		float32 maxLifetime;
+	};
+
+	int32 FindSite(const char* tag);
+
+	b2Allocator* m_allocator;
+	b2Timer m_timer;
+
+	b2AllocationRecord* m_records;
+	int32 m_recordCount;
+	int32 m_recordCapacity;
+
+	b2AllocationSite* m_sites;
+	int32 m_siteCount;
+	int32 m_siteCapacity;
+
+	int32 m_allocationCount;
+	int32 m_liveBytes;
+	int32 m_peakBytes;
+};
+
+/// Forwards to another allocator and counts the calls made while armed.
+/// The world arms one of these during a time step to find heap use in the step.
+class b2CountingAllocator : public b2Allocator
+{
+public:
+	/// @param allocator the allocator that provides the memory, or NULL for the default.
+	b2CountingAllocator(b2Allocator* allocator = NULL);
+
+	/// Implement b2Allocator.
+	void* Allocate(int32 size, const char* tag);
+
+	/// Implement b2Allocator.
+	void Free(void* mem, int32 size, const char* tag);
+
+	/// Start counting calls. This resets the count.
+	void Arm();
+
+	/// Stop counting calls.
+	void Disarm();
+
+	/// Log and assert on every call made while armed.
+	void SetAssert(bool flag);
+	bool GetAssert() const;
+
+	/// Get the number of Allocate and Free calls made while armed.
+	int32 GetCount() const;
+
+	/// Get the tag of the last call made while armed, or NULL.
+	const char* GetLastTag() const;
+
+	/// Get the allocator that provides the memory.
+	b2Allocator* GetAllocator() const;
+
+private:
+
+	void Count(const char* tag);
+
+	b2Allocator* m_allocator;
+	int32 m_count;
+	const char* m_lastTag;
+	bool m_armed;
+	bool m_assert;
+};
+
+inline int32 b2ArenaAllocator::GetPageCount() const
+{
+	return m_pageCount;
+}
+
+inline int32 b2ArenaAllocator::GetReservedBytes() const
+{
+	return m_reservedBytes;
+}
+
+inline int32 b2TracingAllocator::GetAllocationCount() const
+{
+	return m_allocationCount;
+}
+
+inline int32 b2TracingAllocator::GetLiveCount() const
+{
+	return m_recordCount;
+}
+
+inline int32 b2TracingAllocator::GetLiveBytes() const
+{
+	return m_liveBytes;
+}
+
+inline int32 b2TracingAllocator::GetPeakBytes() const
+{
+	return m_peakBytes;
+}
+
+inline void b2CountingAllocator::Arm()
+{
+	m_count = 0;
+	m_lastTag = NULL;
+	m_armed = true;
+}
+
+inline void b2CountingAllocator::Disarm()
+{
+	m_armed = false;
+}
+
+inline void b2CountingAllocator::SetAssert(bool flag)
+{
+	m_assert = flag;
+}
+
+inline bool b2CountingAllocator::GetAssert() const
+{
+	return m_assert;
+}
+
+inline int32 b2CountingAllocator::GetCount() const
+{
+	return m_count;
+}
+
+inline const char* b2CountingAllocator::GetLastTag() const
+{
+	return m_lastTag;
+}
+
+inline b2Allocator* b2CountingAllocator::GetAllocator() const
+{
+	return m_allocator;
+}
+
+#endif
@@ -17,6 +17,7 @@
 */
 
 #include <Box2D/Common/b2BlockAllocator.h>
+#include <Box2D/Common/b2Allocator.h>
 #include <limits.h>
 #include <memory.h>
 #include <stddef.h>
@@ -52,16 +53,19 @@ struct b2Block
 	b2Block* next;
 };
 
-b2BlockAllocator::b2BlockAllocator()
+b2BlockAllocator::b2BlockAllocator(b2Allocator* allocator)
 {
 	b2Assert(b2_blockSizes < UCHAR_MAX);
 
+	m_allocator = allocator ? allocator : b2GetDefaultAllocator();
+
 	m_chunkSpace = b2_chunkArrayIncrement;
 	m_chunkCount = 0;
-	m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
+	m_chunks = (b2Chunk*)m_allocator->Allocate(m_chunkSpace * sizeof(b2Chunk), "b2BlockAllocator chunk array");
 	
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 	memset(m_freeLists, 0, sizeof(m_freeLists));
+	memset(m_reservedCounts, 0, sizeof(m_reservedCounts));
 
 	if (s_blockSizeLookupInitialized == false)
 	{
@@ -88,10 +92,10 @@ b2BlockAllocator::~b2BlockAllocator()
 {
 	for (int32 i = 0; i < m_chunkCount; ++i)
 	{
-		b2Free(m_chunks[i].blocks);
+		m_allocator->Free(m_chunks[i].blocks, b2_chunkSize, "b2BlockAllocator chunk");
 	}
 
-	b2Free(m_chunks);
+	m_allocator->Free(m_chunks, m_chunkSpace * sizeof(b2Chunk), "b2BlockAllocator chunk array");
 }
 
 void* b2BlockAllocator::Allocate(int32 size)
@@ -103,52 +107,88 @@ void* b2BlockAllocator::Allocate(int32 size)
 
 	if (size > b2_maxBlockSize)
 	{
-		return b2Alloc(size);
+		return m_allocator->Allocate(size, "b2BlockAllocator large block");
 	}
 
 	int32 index = s_blockSizeLookup[size];
 	b2Assert(0 <= index && index < b2_blockSizes);
 
-	if (m_freeLists[index])
+	if (m_freeLists[index] == NULL)
 	{
-		b2Block* block = m_freeLists[index];
-		m_freeLists[index] = block->next;
-		return block;
+		AllocateChunk(index);
 	}
-	else
+
+	b2Block* block = m_freeLists[index];
+	m_freeLists[index] = block->next;
+	if (m_reservedCounts[index] > 0)
 	{
-		if (m_chunkCount == m_chunkSpace)
-		{
-			b2Chunk* oldChunks = m_chunks;
-			m_chunkSpace += b2_chunkArrayIncrement;
-			m_chunks = (b2Chunk*)b2Alloc(m_chunkSpace * sizeof(b2Chunk));
-			memcpy(m_chunks, oldChunks, m_chunkCount * sizeof(b2Chunk));
-			memset(m_chunks + m_chunkCount, 0, b2_chunkArrayIncrement * sizeof(b2Chunk));
-			b2Free(oldChunks);
-		}
+		--m_reservedCounts[index];
+	}
+	return block;
+}
 
-		b2Chunk* chunk = m_chunks + m_chunkCount;
-		chunk->blocks = (b2Block*)b2Alloc(b2_chunkSize);
+// Carve a new chunk into blocks and put them on the free list.
+void b2BlockAllocator::AllocateChunk(int32 index)
+{
+	if (m_chunkCount == m_chunkSpace)
+	{
+		b2Chunk* oldChunks = m_chunks;
+		int32 oldSpace = m_chunkSpace;
+		m_chunkSpace += b2_chunkArrayIncrement;
+		m_chunks = (b2Chunk*)m_allocator->Allocate(m_chunkSpace * sizeof(b2Chunk), "b2BlockAllocator chunk array");
+		memcpy(m_chunks, oldChunks, m_chunkCount * sizeof(b2Chunk));
+		memset(m_chunks + m_chunkCount, 0, b2_chunkArrayIncrement * sizeof(b2Chunk));
+		m_allocator->Free(oldChunks, oldSpace * sizeof(b2Chunk), "b2BlockAllocator chunk array");
+	}
+
+	b2Chunk* chunk = m_chunks + m_chunkCount;
+	chunk->blocks = (b2Block*)m_allocator->Allocate(b2_chunkSize, "b2BlockAllocator chunk");
 #if defined(_DEBUG)
-		memset(chunk->blocks, 0xcd, b2_chunkSize);
+	memset(chunk->blocks, 0xcd, b2_chunkSize);
 #endif
-		int32 blockSize = s_blockSizes[index];
-		chunk->blockSize = blockSize;
-		int32 blockCount = b2_chunkSize / blockSize;
-		b2Assert(blockCount * blockSize <= b2_chunkSize);
-		for (int32 i = 0; i < blockCount - 1; ++i)
-		{
-			b2Block* block = (b2Block*)((int8*)chunk->blocks + blockSize * i);
-			b2Block* next = (b2Block*)((int8*)chunk->blocks + blockSize * (i + 1));
-			block->next = next;
-		}
-		b2Block* last = (b2Block*)((int8*)chunk->blocks + blockSize * (blockCount - 1));
-		last->next = NULL;
+	int32 blockSize = s_blockSizes[index];
+	chunk->blockSize = blockSize;
+	int32 blockCount = b2_chunkSize / blockSize;
+	b2Assert(blockCount * blockSize <= b2_chunkSize);
+	for (int32 i = 0; i < blockCount - 1; ++i)
+	{
+		b2Block* block = (b2Block*)((int8*)chunk->blocks + blockSize * i);
+		b2Block* next = (b2Block*)((int8*)chunk->blocks + blockSize * (i + 1));
+		block->next = next;
+	}
+	b2Block* last = (b2Block*)((int8*)chunk->blocks + blockSize * (blockCount - 1));
+	last->next = m_freeLists[index];
 
-		m_freeLists[index] = chunk->blocks->next;
-		++m_chunkCount;
+	m_freeLists[index] = chunk->blocks;
+	++m_chunkCount;
+}
+
+void b2BlockAllocator::Reserve(int32 size, int32 count)
+{
+	b2Assert(0 < size && size <= b2_maxBlockSize);
+
+	int32 index = s_blockSizeLookup[size];
+	b2Assert(0 <= index && index < b2_blockSizes);
 
-		return chunk->blocks;
+	if (count <= 0)
+	{
+		return;
+	}
+
+	// Earlier reservations in this class may hold on to the free blocks already
+	m_reservedCounts[index] += count;
+
+	int32 freeCount = 0;
+	for (b2Block* block = m_freeLists[index]; block; block = block->next)
+	{
+		++freeCount;
+	}
+
+	int32 blockCount = b2_chunkSize / s_blockSizes[index];
+	while (freeCount < m_reservedCounts[index])
+	{
+		AllocateChunk(index);
+		freeCount += blockCount;
 	}
 }
 
@@ -163,7 +203,7 @@ void b2BlockAllocator::Free(void* p, int32 size)
 
 	if (size > b2_maxBlockSize)
 	{
-		b2Free(p);
+		m_allocator->Free(p, size, "b2BlockAllocator large block");
 		return;
 	}
 
@@ -205,11 +245,12 @@ void b2BlockAllocator::Clear()
 {
 	for (int32 i = 0; i < m_chunkCount; ++i)
 	{
-		b2Free(m_chunks[i].blocks);
+		m_allocator->Free(m_chunks[i].blocks, b2_chunkSize, "b2BlockAllocator chunk");
 	}
 
 	m_chunkCount = 0;
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 
 	memset(m_freeLists, 0, sizeof(m_freeLists));
+	memset(m_reservedCounts, 0, sizeof(m_reservedCounts));
 }
@@ -21,6 +21,8 @@
 
 #include <Box2D/Common/b2Settings.h>
 
+class b2Allocator;
+
 const int32 b2_chunkSize = 16 * 1024;
 const int32 b2_maxBlockSize = 640;
 const int32 b2_blockSizes = 14;
@@ -35,28 +37,50 @@ struct b2Chunk;
 class b2BlockAllocator
 {
 public:
-	b2BlockAllocator();
+	/// @param allocator provides the chunks, or NULL to use b2Alloc.
+	b2BlockAllocator(b2Allocator* allocator = NULL);
 	~b2BlockAllocator();
 
-	/// Allocate memory. This will use b2Alloc if the size is larger than b2_maxBlockSize.
+	/// Allocate memory. This will use the backing allocator directly if the size
+	/// is larger than b2_maxBlockSize.
 	void* Allocate(int32 size);
 
-	/// Free memory. This will use b2Free if the size is larger than b2_maxBlockSize.
+	/// Free memory. This will use the backing allocator directly if the size
+	/// is larger than b2_maxBlockSize.
 	void Free(void* p, int32 size);
 
 	void Clear();
 
+	/// Make sure count more blocks of the given size can be allocated without
+	/// requesting a chunk from the backing allocator. Reservations add up:
+	/// sizes that share a block size class share one count of reserved
+	/// blocks, and every block handed out by Allocate uses up one of them.
+	void Reserve(int32 size, int32 count);
+
+	/// Get the allocator that provides the chunks.
+	b2Allocator* GetAllocator() const;
+
 private:
 
+	void AllocateChunk(int32 index);
+
+	b2Allocator* m_allocator;
+
 	b2Chunk* m_chunks;
 	int32 m_chunkCount;
 	int32 m_chunkSpace;
 
 	b2Block* m_freeLists[b2_blockSizes];
+	int32 m_reservedCounts[b2_blockSizes];
 
 	static int32 s_blockSizes[b2_blockSizes];
 	static uint8 s_blockSizeLookup[b2_maxBlockSize + 1];
 	static bool s_blockSizeLookupInitialized;
 };
 
+inline b2Allocator* b2BlockAllocator::GetAllocator() const
+{
+	return m_allocator;
+}
+
 #endif
@@ -0,0 +1,286 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_HANDLE_POOL_H
+#define B2_HANDLE_POOL_H
+
+#include <Box2D/Common/b2Settings.h>
+#include <Box2D/Common/b2Allocator.h>
+#include <memory.h>
+
+/// A weak reference to an object in a b2HandlePool. A handle to a destroyed
+/// object is detected by its generation, so handles may outlive their object.
+/// Generations start at one, so a zeroed handle is null.
+struct b2Handle
+{
+	int32 index;
+	int32 generation;
+};
+
+inline bool operator==(const b2Handle& a, const b2Handle& b)
+{
+	return a.index == b.index && a.generation == b.generation;
+}
+
+inline bool operator!=(const b2Handle& a, const b2Handle& b)
+{
+	return a.index != b.index || a.generation != b.generation;
+}
+
+const int32 b2_handlePoolBlockSize = 64;
+
+/// Storage for objects of type T in blocks of b2_handlePoolBlockSize slots.
+/// Slots never move, so objects can also be referenced by pointer. Freed
+/// slots are reused before the pool grows, so neighbors in a block tend to be
+/// live. The live objects are also kept in a dense array for iteration.
+/// The capacity doubles when the pool is full, so the side arrays are copied
+/// O(log n) times while n objects are created.
+/// The pool only manages memory, construct and destruct objects in place.
+template <typename T>
+class b2HandlePool
+{
+public:
+	b2HandlePool(b2Allocator* allocator)
+	{
+		m_allocator = allocator;
+		m_blocks = NULL;
+		m_blockCount = 0;
+		m_slots = NULL;
+		m_objects = NULL;
+		m_objectSlots = NULL;
+		m_count = 0;
+		m_freeList = b2_nullSlot;
+		m_sorted = true;
+	}
+
+	~b2HandlePool()
+	{
+		for (int32 i = 0; i < m_blockCount; ++i)
+		{
+			m_allocator->Free(m_blocks[i], b2_handlePoolBlockSize * sizeof(T), "b2HandlePool block");
+		}
+
+		int32 capacity = GetCapacity();
+		m_allocator->Free(m_blocks, m_blockCount * sizeof(T*), "b2HandlePool block array");
+		m_allocator->Free(m_slots, capacity * sizeof(b2HandleSlot), "b2HandlePool slots");
+		m_allocator->Free(m_objects, capacity * sizeof(T*), "b2HandlePool objects");
+		m_allocator->Free(m_objectSlots, capacity * sizeof(int32), "b2HandlePool objects");
+	}
+
+	/// Allocate memory for an object and get its handle.
+	T* Allocate(b2Handle* handle)
+	{
+		if (m_freeList == b2_nullSlot)
+		{
+			Grow(2 * GetCapacity());
+		}
+
+		int32 index = m_freeList;
+		b2HandleSlot* slot = m_slots + index;
+		m_freeList = slot->next;
+
+		slot->next = m_count;
+		slot->alive = true;
+		m_objects[m_count] = GetSlot(index);
+		m_objectSlots[m_count] = index;
+		++m_count;
+
+		handle->index = index;
+		handle->generation = slot->generation;
+		return m_objects[slot->next];
+	}
+
+	/// Free the memory of a live object. Its handles become stale.
+	void Free(const b2Handle& handle)
+	{
+		b2Assert(Get(handle) != NULL);
+		b2HandleSlot* slot = m_slots + handle.index;
+
+		// Move the last object into the hole of the dense array.
+		int32 denseIndex = slot->next;
+		--m_count;
+		m_objects[denseIndex] = m_objects[m_count];
+		m_objectSlots[denseIndex] = m_objectSlots[m_count];
+		m_slots[m_objectSlots[denseIndex]].next = denseIndex;
+
+		// Generations skip zero so null handles stay invalid.
+		slot->generation = slot->generation == b2_maxGeneration ? 1 : slot->generation + 1;
+		slot->next = m_freeList;
+		slot->alive = false;
+		m_freeList = handle.index;
+		m_sorted = false;
+	}
+
+	/// Get the object of a handle, or NULL if the handle is stale.
+	T* Get(const b2Handle& handle) const
+	{
+		if (handle.index < 0 || handle.index >= GetCapacity())
+		{
+			return NULL;
+		}
+
+		const b2HandleSlot* slot = m_slots + handle.index;
+		if (slot->alive == false || slot->generation != handle.generation)
+		{
+			return NULL;
+		}
+
+		return GetSlot(handle.index);
+	}
+
+	/// Put the dense array back in slot order after objects were freed, so
+	/// iterating it walks memory forward. This does nothing if no object was
+	/// freed since the last sort.
+	void Sort()
+	{
+		if (m_sorted)
+		{
+			return;
+		}
+
+		int32 count = 0;
+		int32 capacity = GetCapacity();
+		for (int32 i = 0; i < capacity; ++i)
+		{
+			if (m_slots[i].alive)
+			{
+				m_slots[i].next = count;
+				m_objects[count] = GetSlot(i);
+				m_objectSlots[count] = i;
+				++count;
+			}
+		}
+
+		b2Assert(count == m_count);
+		m_sorted = true;
+	}
+
+	/// Make room for count objects.
+	void Reserve(int32 count)
+	{
+		if (GetCapacity() < count)
+		{
+			Grow(count);
+		}
+	}
+
+	/// Get the live objects. The order changes when an object is freed.
+	T* const* GetObjects() const
+	{
+		return m_objects;
+	}
+
+	/// Get the number of live objects.
+	int32 GetCount() const
+	{
+		return m_count;
+	}
+
+	int32 GetCapacity() const
+	{
+		return m_blockCount * b2_handlePoolBlockSize;
+	}
+
+private:
+
+	enum
+	{
+		b2_nullSlot = -1,
+		b2_maxGeneration = 0x7fffffff
+	};
+
+	struct b2HandleSlot
+	{
+		int32 generation;
+
+		// The dense index of a live slot or the next free slot.
+		int32 next;
+
+		bool alive;
+	};
+
+	T* GetSlot(int32 index) const
+	{
+		return m_blocks[index / b2_handlePoolBlockSize] + index % b2_handlePoolBlockSize;
+	}
+
+	// Grow to at least minCapacity slots, at least one block, with a single
+	// reallocation of the side arrays. The new slots go on the free list in order.
+	void Grow(int32 minCapacity)
+	{
+		int32 oldCapacity = GetCapacity();
+		int32 blockCount = (minCapacity + b2_handlePoolBlockSize - 1) / b2_handlePoolBlockSize;
+		if (blockCount <= m_blockCount)
+		{
+			blockCount = m_blockCount + 1;
+		}
+		int32 capacity = blockCount * b2_handlePoolBlockSize;
+
+		T** newBlocks = (T**)m_allocator->Allocate(blockCount * sizeof(T*), "b2HandlePool block array");
+		b2HandleSlot* newSlots = (b2HandleSlot*)m_allocator->Allocate(capacity * sizeof(b2HandleSlot), "b2HandlePool slots");
+		T** newObjects = (T**)m_allocator->Allocate(capacity * sizeof(T*), "b2HandlePool objects");
+		int32* newObjectSlots = (int32*)m_allocator->Allocate(capacity * sizeof(int32), "b2HandlePool objects");
+
+		if (m_blockCount > 0)
+		{
+			memcpy(newBlocks, m_blocks, m_blockCount * sizeof(T*));
+			memcpy(newSlots, m_slots, oldCapacity * sizeof(b2HandleSlot));
+			memcpy(newObjects, m_objects, m_count * sizeof(T*));
+			memcpy(newObjectSlots, m_objectSlots, m_count * sizeof(int32));
+
+			m_allocator->Free(m_blocks, m_blockCount * sizeof(T*), "b2HandlePool block array");
+			m_allocator->Free(m_slots, oldCapacity * sizeof(b2HandleSlot), "b2HandlePool slots");
+			m_allocator->Free(m_objects, oldCapacity * sizeof(T*), "b2HandlePool objects");
+			m_allocator->Free(m_objectSlots, oldCapacity * sizeof(int32), "b2HandlePool objects");
+		}
+
+		for (int32 i = m_blockCount; i < blockCount; ++i)
+		{
+			newBlocks[i] = (T*)m_allocator->Allocate(b2_handlePoolBlockSize * sizeof(T), "b2HandlePool block");
+		}
+		m_blockCount = blockCount;
+
+		m_blocks = newBlocks;
+		m_slots = newSlots;
+		m_objects = newObjects;
+		m_objectSlots = newObjectSlots;
+
+		for (int32 i = capacity - 1; i >= oldCapacity; --i)
+		{
+			m_slots[i].generation = 1;
+			m_slots[i].next = m_freeList;
+			m_slots[i].alive = false;
+			m_freeList = i;
+		}
+	}
+
+	b2Allocator* m_allocator;
+
+	T** m_blocks;
+	int32 m_blockCount;
+
+	b2HandleSlot* m_slots;
+	T** m_objects;
+	int32* m_objectSlots;
+	int32 m_count;
+
+	int32 m_freeList;
+	bool m_sorted;
+};
+
+#endif
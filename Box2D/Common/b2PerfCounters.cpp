@@ -0,0 +1,168 @@
+/*
+* Copyright (c) 2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2PerfCounters.h>
+
+#if defined(__linux__)
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <string.h>
+
+static int32 b2OpenPerfEvent(uint32 type, uint64 config, int32 groupFd)
+{
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.disabled = groupFd == -1 ? 1 : 0;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP;
+	return int32(syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+b2PerfCounters::b2PerfCounters()
+{
+	static const uint32 types[e_perfEventCount] =
+	{
+		PERF_TYPE_HARDWARE,
+		PERF_TYPE_HARDWARE,
+		PERF_TYPE_HW_CACHE,
+		PERF_TYPE_HARDWARE,
+		PERF_TYPE_HARDWARE
+	};
+
+	static const uint64 configs[e_perfEventCount] =
+	{
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES
+	};
+
+	m_leader = -1;
+	m_count = 0;
+	for (int32 i = 0; i < e_perfEventCount; ++i)
+	{
+		m_fds[i] = b2OpenPerfEvent(types[i], configs[i], m_leader);
+		m_slots[i] = -1;
+		if (m_fds[i] != -1)
+		{
+			if (m_leader == -1)
+			{
+				m_leader = m_fds[i];
+			}
+
+			// The group read returns the values in the order the events were opened.
+			m_slots[i] = m_count++;
+		}
+	}
+
+	if (m_leader != -1)
+	{
+		ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+b2PerfCounters::~b2PerfCounters()
+{
+	for (int32 i = 0; i < e_perfEventCount; ++i)
+	{
+		if (m_fds[i] != -1)
+		{
+			close(m_fds[i]);
+		}
+	}
+}
+
+void b2PerfCounters::Read(b2PerfSample* sample) const
+{
+	memset(sample, 0, sizeof(b2PerfSample));
+	if (m_leader == -1)
+	{
+		return;
+	}
+
+	// Layout of PERF_FORMAT_GROUP: the number of values, then the values.
+	uint64 buffer[1 + e_perfEventCount];
+	ssize_t size = read(m_leader, buffer, sizeof(buffer));
+	if (size < ssize_t(sizeof(uint64) * (1 + m_count)))
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < e_perfEventCount; ++i)
+	{
+		if (m_slots[i] != -1)
+		{
+			sample->values[i] = buffer[1 + m_slots[i]];
+		}
+	}
+}
+
+#else
+
+b2PerfCounters::b2PerfCounters()
+{
+	m_leader = -1;
+	m_count = 0;
+	for (int32 i = 0; i < e_perfEventCount; ++i)
+	{
+		m_fds[i] = -1;
+		m_slots[i] = -1;
+	}
+}
+
+b2PerfCounters::~b2PerfCounters()
+{
+}
+
+void b2PerfCounters::Read(b2PerfSample* sample) const
+{
+	for (int32 i = 0; i < e_perfEventCount; ++i)
+	{
+		sample->values[i] = 0;
+	}
+}
+
+#endif
+
+bool b2PerfCounters::IsAvailable(b2PerfEvent event) const
+{
+	return m_slots[event] != -1;
+}
+
+const char* b2PerfCounters::GetName(b2PerfEvent event)
+{
+	static const char* names[e_perfEventCount] =
+	{
+		"cycles",
+		"instructions",
+		"L1 misses",
+		"LLC misses",
+		"branch misses"
+	};
+
+	return names[event];
+}
@@ -0,0 +1,98 @@
+/*
+* Copyright (c) 2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_PERF_COUNTERS_H
+#define B2_PERF_COUNTERS_H
+
+#include <Box2D/Common/b2Settings.h>
+
+/// The hardware events counted by b2PerfCounters.
+enum b2PerfEvent
+{
+	e_perfCycles,
+	e_perfInstructions,
+	e_perfL1Misses,
+	e_perfLLCMisses,
+	e_perfBranchMisses,
+	e_perfEventCount
+};
+
+/// Event counts of the calling thread. Counters that could not be opened
+/// stay zero.
+struct b2PerfSample
+{
+	uint64 values[e_perfEventCount];
+};
+
+/// Per phase event counts of the last time step, see b2Profile.
+struct b2PerfProfile
+{
+	b2PerfSample step;
+	b2PerfSample collide;
+	b2PerfSample solve;
+	b2PerfSample broadphase;
+	b2PerfSample solveTOI;
+};
+
+/// Hardware performance counters of the calling thread. These use
+/// perf_event_open and are only available on Linux. The kernel may refuse
+/// some or all counters, for example in virtual machines or when
+/// /proc/sys/kernel/perf_event_paranoid is too strict. Reading the counters
+/// is a system call, so install them on a world for benchmarks only.
+class b2PerfCounters
+{
+public:
+	/// Open and start the counters.
+	b2PerfCounters();
+
+	/// Close the counters.
+	~b2PerfCounters();
+
+	/// Is the event counted?
+	bool IsAvailable(b2PerfEvent event) const;
+
+	/// Read the counts since construction. Unavailable counters read zero.
+	void Read(b2PerfSample* sample) const;
+
+	/// Get the name of an event for reports.
+	static const char* GetName(b2PerfEvent event);
+
+private:
+
+	b2PerfCounters(const b2PerfCounters&);
+	b2PerfCounters& operator=(const b2PerfCounters&);
+
+	// The counters form one group so a single read returns all of them.
+	int32 m_leader;
+	int32 m_fds[e_perfEventCount];
+	int32 m_slots[e_perfEventCount];
+	int32 m_count;
+};
+
+/// Set phase to the counts between start and the current counts.
+inline void b2ReadPerfPhase(const b2PerfCounters* counters, const b2PerfSample& start, b2PerfSample* phase)
+{
+	b2PerfSample end;
+	counters->Read(&end);
+	for (int32 i = 0; i < e_perfEventCount; ++i)
+	{
+		phase->values[i] = end.values[i] - start.values[i];
+	}
+}
+
+#endif
@@ -0,0 +1,192 @@
+/*
+* Copyright (c) 2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2Profiler.h>
+#include <Box2D/Common/b2Math.h>
+
+#if defined(B2_PROFILER)
+
+#include <atomic>
+#include <mutex>
+#include <stdio.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+struct b2ProfileEvent
+{
+	const char* name;
+	uint64 start;
+	uint64 end;
+};
+
+// Written only by the owning thread. The count is published after the
+// event so the exporting thread never sees an event before it is stored.
+struct b2ProfileBuffer
+{
+	b2ProfileEvent events[b2_profileEventCapacity];
+	std::atomic<uint32> count;
+	int32 threadIndex;
+	b2ProfileBuffer* next;
+};
+
+static std::mutex s_profileMutex;
+static b2ProfileBuffer* s_profileBuffers = NULL;
+static int32 s_profileThreadCount = 0;
+static uint64 s_baseTicks = 0;
+static float64 s_baseNanoseconds = 0.0;
+static uint64 s_clearTicks = 0;
+
+static thread_local b2ProfileBuffer* t_profileBuffer = NULL;
+
+// The reference clock used to convert ticks to time.
+static float64 b2GetProfileNanoseconds()
+{
+#if defined(_WIN32)
+	LARGE_INTEGER frequency, count;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&count);
+	return 1.0e9 * float64(count.QuadPart) / float64(frequency.QuadPart);
+#elif defined(__linux__) || defined(__APPLE__)
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+	return 1.0e9 * float64(t.tv_sec) + float64(t.tv_nsec);
+#else
+	return 0.0;
+#endif
+}
+
+#if !defined(B2_PROFILER_TSC)
+uint64 b2GetProfileTicks()
+{
+	return uint64(b2GetProfileNanoseconds());
+}
+#endif
+
+static b2ProfileBuffer* b2CreateProfileBuffer()
+{
+	b2ProfileBuffer* buffer = (b2ProfileBuffer*)b2Alloc(sizeof(b2ProfileBuffer));
+	buffer->count.store(0, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(s_profileMutex);
+	if (s_profileThreadCount == 0)
+	{
+		s_baseTicks = b2GetProfileTicks();
+		s_baseNanoseconds = b2GetProfileNanoseconds();
+	}
+
+	buffer->threadIndex = s_profileThreadCount++;
+	buffer->next = s_profileBuffers;
+	s_profileBuffers = buffer;
+
+	// Buffers are kept after their thread exits so its scopes can still
+	// be exported.
+	t_profileBuffer = buffer;
+	return buffer;
+}
+
+void b2RecordProfileScope(const char* name, uint64 start, uint64 end)
+{
+	b2ProfileBuffer* buffer = t_profileBuffer;
+	if (buffer == NULL)
+	{
+		buffer = b2CreateProfileBuffer();
+	}
+
+	uint32 count = buffer->count.load(std::memory_order_relaxed);
+	b2ProfileEvent* event = buffer->events + (count & (b2_profileEventCapacity - 1));
+	event->name = name;
+	event->start = start;
+	event->end = end;
+	buffer->count.store(count + 1, std::memory_order_release);
+}
+
+bool b2WriteProfileTrace(const char* path)
+{
+	std::lock_guard<std::mutex> lock(s_profileMutex);
+	if (s_profileBuffers == NULL)
+	{
+		return false;
+	}
+
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	// Calibrate the ticks against the reference clock over the whole run.
+	float64 ticksPerMicrosecond = 1.0;
+	float64 elapsed = b2GetProfileNanoseconds() - s_baseNanoseconds;
+	if (elapsed > 0.0)
+	{
+		ticksPerMicrosecond = 1000.0 * float64(b2GetProfileTicks() - s_baseTicks) / elapsed;
+	}
+	float64 microsecondsPerTick = 1.0 / ticksPerMicrosecond;
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	const char* separator = "\n";
+	for (b2ProfileBuffer* buffer = s_profileBuffers; buffer; buffer = buffer->next)
+	{
+		uint32 count = buffer->count.load(std::memory_order_acquire);
+		uint32 n = b2Min(count, uint32(b2_profileEventCapacity));
+		for (uint32 i = count - n; i != count; ++i)
+		{
+			const b2ProfileEvent* event = buffer->events + (i & (b2_profileEventCapacity - 1));
+			if (event->start < s_clearTicks)
+			{
+				continue;
+			}
+
+			float64 ts = (float64(event->start) - float64(s_baseTicks)) * microsecondsPerTick;
+			float64 dur = float64(event->end - event->start) * microsecondsPerTick;
+			fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				separator, event->name, buffer->threadIndex, ts, dur);
+			separator = ",\n";
+		}
+	}
+	fprintf(file, "\n]}\n");
+
+	bool ok = ferror(file) == 0;
+	ok = (fclose(file) == 0) && ok;
+	return ok;
+}
+
+void b2ClearProfile()
+{
+	std::lock_guard<std::mutex> lock(s_profileMutex);
+	s_clearTicks = b2GetProfileTicks();
+}
+
+#else
+
+bool b2WriteProfileTrace(const char* path)
+{
+	B2_NOT_USED(path);
+	return false;
+}
+
+void b2ClearProfile()
+{
+}
+
+#endif
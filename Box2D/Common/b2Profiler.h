@@ -0,0 +1,107 @@
+/*
+* Copyright (c) 2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_PROFILER_H
+#define B2_PROFILER_H
+
+#include <Box2D/Common/b2Settings.h>
+
+/// Scope profiler. Define B2_PROFILER when building Box2D and the
+/// application to record B2_PROFILE_SCOPE blocks. Without it the macro
+/// expands to nothing and the functions below do nothing.
+///
+/// Each thread records into its own ring buffer of the last
+/// b2_profileEventCapacity scopes, so recording takes no locks. Scopes
+/// are stored as raw ticks and converted to microseconds on export.
+/// The name is kept by pointer and must be a string literal.
+
+/// The number of scopes kept per thread.
+const int32 b2_profileEventCapacity = 1 << 15;
+
+/// Write the scopes recorded by all threads as Chrome trace JSON. Open the
+/// file with chrome://tracing or ui.perfetto.dev. Scopes recorded while
+/// the file is written may be missing or partly overwritten.
+/// @return false if profiling is disabled or the file cannot be written.
+bool b2WriteProfileTrace(const char* path);
+
+/// Drop the scopes recorded by all threads. Call this while no thread is
+/// inside a scope.
+void b2ClearProfile();
+
+#if defined(B2_PROFILER)
+
+#if (defined(_MSC_VER) || defined(__GNUC__)) && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#define B2_PROFILER_TSC
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+/// Read the profiler clock. This is the time stamp counter where it is
+/// available and CLOCK_MONOTONIC_RAW or the performance counter elsewhere.
+#if defined(B2_PROFILER_TSC)
+inline uint64 b2GetProfileTicks()
+{
+	return __rdtsc();
+}
+#else
+uint64 b2GetProfileTicks();
+#endif
+
+/// Store a finished scope in the buffer of the calling thread.
+void b2RecordProfileScope(const char* name, uint64 start, uint64 end);
+
+/// Records the time between construction and destruction.
+class b2ProfileScope
+{
+public:
+	explicit b2ProfileScope(const char* name)
+	{
+		m_name = name;
+		m_start = b2GetProfileTicks();
+	}
+
+	~b2ProfileScope()
+	{
+		b2RecordProfileScope(m_name, m_start, b2GetProfileTicks());
+	}
+
+private:
+
+	b2ProfileScope(const b2ProfileScope&);
+	b2ProfileScope& operator=(const b2ProfileScope&);
+
+	const char* m_name;
+	uint64 m_start;
+};
+
+#define B2_PROFILE_CONCAT2(a, b) a##b
+#define B2_PROFILE_CONCAT(a, b) B2_PROFILE_CONCAT2(a, b)
+
+/// Profile the rest of the enclosing block under the given name.
+#define B2_PROFILE_SCOPE(name) b2ProfileScope B2_PROFILE_CONCAT(b2_profileScope, __LINE__)(name)
+
+#else
+
+#define B2_PROFILE_SCOPE(name)
+
+#endif
+
+#endif
@@ -17,10 +17,14 @@
 */
 
 #include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Common/b2Allocator.h>
 #include <Box2D/Common/b2Math.h>
 
-b2StackAllocator::b2StackAllocator()
+b2StackAllocator::b2StackAllocator(b2Allocator* allocator)
 {
+	m_allocator = allocator ? allocator : b2GetDefaultAllocator();
+	m_data = m_inlineData;
+	m_capacity = b2_stackSize;
 	m_index = 0;
 	m_allocation = 0;
 	m_maxAllocation = 0;
@@ -31,6 +35,11 @@ b2StackAllocator::~b2StackAllocator()
 {
 	b2Assert(m_index == 0);
 	b2Assert(m_entryCount == 0);
+
+	if (m_data != m_inlineData)
+	{
+		m_allocator->Free(m_data, m_capacity, "b2StackAllocator stack");
+	}
 }
 
 void* b2StackAllocator::Allocate(int32 size)
@@ -39,9 +48,9 @@ void* b2StackAllocator::Allocate(int32 size)
 
 	b2StackEntry* entry = m_entries + m_entryCount;
 	entry->size = size;
-	if (m_index + size > b2_stackSize)
+	if (m_index + size > m_capacity)
 	{
-		entry->data = (char*)b2Alloc(size);
+		entry->data = (char*)m_allocator->Allocate(size, "b2StackAllocator overflow");
 		entry->usedMalloc = true;
 	}
 	else
@@ -65,7 +74,7 @@ void b2StackAllocator::Free(void* p)
 	b2Assert(p == entry->data);
 	if (entry->usedMalloc)
 	{
-		b2Free(p);
+		m_allocator->Free(p, entry->size, "b2StackAllocator overflow");
 	}
 	else
 	{
@@ -77,6 +86,23 @@ void b2StackAllocator::Free(void* p)
 	p = NULL;
 }
 
+void b2StackAllocator::Reserve(int32 size)
+{
+	b2Assert(m_entryCount == 0);
+	if (size <= m_capacity)
+	{
+		return;
+	}
+
+	if (m_data != m_inlineData)
+	{
+		m_allocator->Free(m_data, m_capacity, "b2StackAllocator stack");
+	}
+
+	m_data = (char*)m_allocator->Allocate(size, "b2StackAllocator stack");
+	m_capacity = size;
+}
+
 int32 b2StackAllocator::GetMaxAllocation() const
 {
 	return m_maxAllocation;
@@ -21,6 +21,8 @@
 
 #include <Box2D/Common/b2Settings.h>
 
+class b2Allocator;
+
 const int32 b2_stackSize = 100 * 1024;	// 100k
 const int32 b2_maxStackEntries = 32;
 
@@ -37,17 +39,27 @@ struct b2StackEntry
 class b2StackAllocator
 {
 public:
-	b2StackAllocator();
+	/// @param allocator provides the memory for allocations that don't fit on
+	/// the stack, or NULL to use b2Alloc.
+	b2StackAllocator(b2Allocator* allocator = NULL);
 	~b2StackAllocator();
 
 	void* Allocate(int32 size);
 	void Free(void* p);
 
+	/// Grow the stack so allocations up to the given total size don't need
+	/// the backing allocator. This must be called with nothing allocated.
+	void Reserve(int32 size);
+
 	int32 GetMaxAllocation() const;
 
 private:
 
-	char m_data[b2_stackSize];
+	b2Allocator* m_allocator;
+
+	char m_inlineData[b2_stackSize];
+	char* m_data;
+	int32 m_capacity;
 	int32 m_index;
 
 	int32 m_allocation;
@@ -80,7 +80,10 @@ float32 b2Timer::GetMilliseconds() const
 {
     timeval t;
     gettimeofday(&t, 0);
-    return 1000.0f * (t.tv_sec - m_start_sec) + 0.001f * (t.tv_usec - m_start_usec);
+    // The microseconds wrap each second, subtract them as signed values.
+    long sec = long(t.tv_sec) - long(m_start_sec);
+    long usec = long(t.tv_usec) - long(m_start_usec);
+    return 1000.0f * sec + 0.001f * usec;
 }
 
 #else
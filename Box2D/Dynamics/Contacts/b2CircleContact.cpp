@@ -17,6 +17,7 @@
 */
 
 #include <Box2D/Dynamics/Contacts/b2CircleContact.h>
+#include <Box2D/Dynamics/Contacts/b2ContactTraits.h>
 #include <Box2D/Dynamics/b2Body.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
@@ -46,7 +47,7 @@ b2CircleContact::b2CircleContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
 
 void b2CircleContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
 {
-	b2CollideCircles(manifold,
-					(b2CircleShape*)m_fixtureA->GetShape(), xfA,
-					(b2CircleShape*)m_fixtureB->GetShape(), xfB);
+	b2ContactTraits<b2Shape::e_circle, b2Shape::e_circle>::Collide(manifold,
+		m_fixtureA->GetShape(), m_indexA, xfA,
+		m_fixtureB->GetShape(), m_indexB, xfB, &m_satCache);
 }
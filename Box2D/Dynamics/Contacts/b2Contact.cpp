@@ -24,6 +24,8 @@
 #include <Box2D/Dynamics/Contacts/b2EdgeAndPolygonContact.h>
 #include <Box2D/Dynamics/Contacts/b2ChainAndCircleContact.h>
 #include <Box2D/Dynamics/Contacts/b2ChainAndPolygonContact.h>
+#include <Box2D/Dynamics/Contacts/b2HeightfieldAndCircleContact.h>
+#include <Box2D/Dynamics/Contacts/b2HeightfieldAndPolygonContact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 
 #include <Box2D/Collision/b2Collision.h>
@@ -46,6 +48,8 @@ void b2Contact::InitializeRegisters()
 	AddType(b2EdgeAndPolygonContact::Create, b2EdgeAndPolygonContact::Destroy, b2Shape::e_edge, b2Shape::e_polygon);
 	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, b2Shape::e_chain, b2Shape::e_circle);
 	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, b2Shape::e_chain, b2Shape::e_polygon);
+	AddType(b2HeightfieldAndCircleContact::Create, b2HeightfieldAndCircleContact::Destroy, b2Shape::e_heightfield, b2Shape::e_circle);
+	AddType(b2HeightfieldAndPolygonContact::Create, b2HeightfieldAndPolygonContact::Destroy, b2Shape::e_heightfield, b2Shape::e_polygon);
 }
 
 void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destoryFcn,
@@ -109,8 +113,11 @@ void b2Contact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
 		fixtureA->IsSensor() == false &&
 		fixtureB->IsSensor() == false)
 	{
-		fixtureA->GetBody()->SetAwake(true);
-		fixtureB->GetBody()->SetAwake(true);
+		b2Body* bodyA = fixtureA->GetBody();
+		b2Body* bodyB = fixtureB->GetBody();
+		bodyA->SetAwake(true);
+		bodyB->SetAwake(true);
+		bodyA->m_world->m_islandManager.Unlink(bodyA, bodyB);
 	}
 
 	b2Shape::Type typeA = fixtureA->GetType();
@@ -133,8 +140,15 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 	m_indexA = indexA;
 	m_indexB = indexB;
 
+	m_proxyIdA = b2BroadPhase::e_nullProxy;
+	m_proxyIdB = b2BroadPhase::e_nullProxy;
+	m_managerIndex = -1;
+
 	m_manifold.pointCount = 0;
 
+	m_satCache.type = b2SATCache::e_empty;
+	m_satCache.index = 0;
+
 	m_prev = NULL;
 	m_next = NULL;
 
@@ -162,6 +176,16 @@ void b2Contact::Update(b2ContactListener* listener)
 {
 	b2Manifold oldManifold = m_manifold;
 
+	if (m_fixtureA->IsSensor() == false && m_fixtureB->IsSensor() == false)
+	{
+		Evaluate(&m_manifold, m_fixtureA->GetBody()->GetTransform(), m_fixtureB->GetBody()->GetTransform());
+	}
+
+	Update(listener, oldManifold);
+}
+
+void b2Contact::Update(b2ContactListener* listener, const b2Manifold& oldManifold)
+{
 	// Re-enable this contact.
 	m_flags |= e_enabledFlag;
 
@@ -186,10 +210,14 @@ void b2Contact::Update(b2ContactListener* listener)
 
 		// Sensors don't generate manifolds.
 		m_manifold.pointCount = 0;
+
+		if (touching != wasTouching)
+		{
+			bodyA->m_world->m_contactManager.AddSensorEvents(this, touching);
+		}
 	}
 	else
 	{
-		Evaluate(&m_manifold, xfA, xfB);
 		touching = m_manifold.pointCount > 0;
 
 		// Match old contact ids to new contact ids and copy the
@@ -203,7 +231,7 @@ void b2Contact::Update(b2ContactListener* listener)
 
 			for (int32 j = 0; j < oldManifold.pointCount; ++j)
 			{
-				b2ManifoldPoint* mp1 = oldManifold.points + j;
+				const b2ManifoldPoint* mp1 = oldManifold.points + j;
 
 				if (mp1->id.key == id2.key)
 				{
@@ -218,6 +246,16 @@ void b2Contact::Update(b2ContactListener* listener)
 		{
 			bodyA->SetAwake(true);
 			bodyB->SetAwake(true);
+
+			b2IslandManager* islandManager = &bodyA->m_world->m_islandManager;
+			if (touching)
+			{
+				islandManager->Link(bodyA, bodyB);
+			}
+			else
+			{
+				islandManager->Unlink(bodyA, bodyB);
+			}
 		}
 	}
 
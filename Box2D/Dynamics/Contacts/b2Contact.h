@@ -189,6 +189,11 @@ protected:
 
 	void Update(b2ContactListener* listener);
 
+	// Finish the update once Evaluate has filled in the manifold of a
+	// non-sensor contact. The contact manager evaluates a batch of contacts
+	// of the same type this way without going through the vtable.
+	void Update(b2ContactListener* listener, const b2Manifold& oldManifold);
+
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
 
@@ -208,8 +213,19 @@ protected:
 	int32 m_indexA;
 	int32 m_indexB;
 
+	// The broad-phase pair, kept for the contact manager's pair table
+	// because the proxies may be destroyed before the contact.
+	int32 m_proxyIdA;
+	int32 m_proxyIdB;
+
+	// Index in the contact manager's contact array.
+	int32 m_managerIndex;
+
 	b2Manifold m_manifold;
 
+	// Separating axis of the last evaluation of a polygon pair.
+	b2SATCache m_satCache;
+
 	int32 m_toiCount;
 	float32 m_toi;
 
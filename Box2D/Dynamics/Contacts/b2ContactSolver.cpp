@@ -128,6 +128,11 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 	}
 }
 
+int32 b2ContactSolver::GetStackSize(int32 count)
+{
+	return count * (sizeof(b2ContactPositionConstraint) + sizeof(b2ContactVelocityConstraint));
+}
+
 b2ContactSolver::~b2ContactSolver()
 {
 	m_allocator->Free(m_velocityConstraints);
@@ -663,11 +668,13 @@ struct b2PositionSolverManifold
 };
 
 // Sequential solver.
-bool b2ContactSolver::SolvePositionConstraints()
+bool b2ContactSolver::SolvePositionConstraints(int32 begin, int32 end)
 {
+	b2Assert(0 <= begin && begin <= end && end <= m_count);
+
 	float32 minSeparation = 0.0f;
 
-	for (int32 i = 0; i < m_count; ++i)
+	for (int32 i = begin; i < end; ++i)
 	{
 		b2ContactPositionConstraint* pc = m_positionConstraints + i;
 
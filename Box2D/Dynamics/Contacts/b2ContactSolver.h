@@ -72,13 +72,17 @@ public:
 	b2ContactSolver(b2ContactSolverDef* def);
 	~b2ContactSolver();
 
+	/// Get the stack memory used to solve count contacts.
+	static int32 GetStackSize(int32 count);
+
 	void InitializeVelocityConstraints();
 
 	void WarmStart();
 	void SolveVelocityConstraints();
 	void StoreImpulses();
 
-	bool SolvePositionConstraints();
+	/// Solve the position constraints of the contacts in [begin, end).
+	bool SolvePositionConstraints(int32 begin, int32 end);
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
 	b2TimeStep m_step;
@@ -0,0 +1,176 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_CONTACT_TRAITS_H
+#define B2_CONTACT_TRAITS_H
+
+#include <Box2D/Collision/b2Collision.h>
+#include <Box2D/Collision/Shapes/b2Shape.h>
+#include <Box2D/Collision/Shapes/b2CircleShape.h>
+#include <Box2D/Collision/Shapes/b2EdgeShape.h>
+#include <Box2D/Collision/Shapes/b2PolygonShape.h>
+#include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2HeightfieldShape.h>
+
+/// This is an internal structure.
+/// The narrow phase of a shape pair, chosen at compile time. Shape A has
+/// typeA and shape B has typeB, in the order the contact registers use.
+/// Only the registered pairs are specialized. The contact classes evaluate
+/// through these and the contact manager instantiates its batch loop on
+/// them, so the collision function is a direct call the compiler can see.
+/// The cache belongs to the contact and is only used by polygon pairs.
+template <int32 typeA, int32 typeB>
+struct b2ContactTraits;
+
+template <>
+struct b2ContactTraits<b2Shape::e_circle, b2Shape::e_circle>
+{
+	static void Collide(b2Manifold* manifold,
+						const b2Shape* shapeA, int32 indexA, const b2Transform& xfA,
+						const b2Shape* shapeB, int32 indexB, const b2Transform& xfB,
+						b2SATCache* cache)
+	{
+		B2_NOT_USED(indexA);
+		B2_NOT_USED(indexB);
+		B2_NOT_USED(cache);
+		b2CollideCircles(manifold, (const b2CircleShape*)shapeA, xfA, (const b2CircleShape*)shapeB, xfB);
+	}
+};
+
+template <>
+struct b2ContactTraits<b2Shape::e_polygon, b2Shape::e_circle>
+{
+	static void Collide(b2Manifold* manifold,
+						const b2Shape* shapeA, int32 indexA, const b2Transform& xfA,
+						const b2Shape* shapeB, int32 indexB, const b2Transform& xfB,
+						b2SATCache* cache)
+	{
+		B2_NOT_USED(indexA);
+		B2_NOT_USED(indexB);
+		B2_NOT_USED(cache);
+		b2CollidePolygonAndCircle(manifold, (const b2PolygonShape*)shapeA, xfA, (const b2CircleShape*)shapeB, xfB);
+	}
+};
+
+template <>
+struct b2ContactTraits<b2Shape::e_polygon, b2Shape::e_polygon>
+{
+	static void Collide(b2Manifold* manifold,
+						const b2Shape* shapeA, int32 indexA, const b2Transform& xfA,
+						const b2Shape* shapeB, int32 indexB, const b2Transform& xfB,
+						b2SATCache* cache)
+	{
+		B2_NOT_USED(indexA);
+		B2_NOT_USED(indexB);
+		b2CollidePolygons(manifold, (const b2PolygonShape*)shapeA, xfA, (const b2PolygonShape*)shapeB, xfB, cache);
+	}
+};
+
+template <>
+struct b2ContactTraits<b2Shape::e_edge, b2Shape::e_circle>
+{
+	static void Collide(b2Manifold* manifold,
+						const b2Shape* shapeA, int32 indexA, const b2Transform& xfA,
+						const b2Shape* shapeB, int32 indexB, const b2Transform& xfB,
+						b2SATCache* cache)
+	{
+		B2_NOT_USED(indexA);
+		B2_NOT_USED(indexB);
+		B2_NOT_USED(cache);
+		b2CollideEdgeAndCircle(manifold, (const b2EdgeShape*)shapeA, xfA, (const b2CircleShape*)shapeB, xfB);
+	}
+};
+
+template <>
+struct b2ContactTraits<b2Shape::e_edge, b2Shape::e_polygon>
+{
+	static void Collide(b2Manifold* manifold,
+						const b2Shape* shapeA, int32 indexA, const b2Transform& xfA,
+						const b2Shape* shapeB, int32 indexB, const b2Transform& xfB,
+						b2SATCache* cache)
+	{
+		B2_NOT_USED(indexA);
+		B2_NOT_USED(indexB);
+		B2_NOT_USED(cache);
+		b2CollideEdgeAndPolygon(manifold, (const b2EdgeShape*)shapeA, xfA, (const b2PolygonShape*)shapeB, xfB);
+	}
+};
+
+template <>
+struct b2ContactTraits<b2Shape::e_chain, b2Shape::e_circle>
+{
+	static void Collide(b2Manifold* manifold,
+						const b2Shape* shapeA, int32 indexA, const b2Transform& xfA,
+						const b2Shape* shapeB, int32 indexB, const b2Transform& xfB,
+						b2SATCache* cache)
+	{
+		B2_NOT_USED(indexB);
+		B2_NOT_USED(cache);
+		b2EdgeShape edge;
+		((const b2ChainShape*)shapeA)->GetChildEdge(&edge, indexA);
+		b2CollideEdgeAndCircle(manifold, &edge, xfA, (const b2CircleShape*)shapeB, xfB);
+	}
+};
+
+template <>
+struct b2ContactTraits<b2Shape::e_chain, b2Shape::e_polygon>
+{
+	static void Collide(b2Manifold* manifold,
+						const b2Shape* shapeA, int32 indexA, const b2Transform& xfA,
+						const b2Shape* shapeB, int32 indexB, const b2Transform& xfB,
+						b2SATCache* cache)
+	{
+		B2_NOT_USED(indexB);
+		B2_NOT_USED(cache);
+		b2EdgeShape edge;
+		((const b2ChainShape*)shapeA)->GetChildEdge(&edge, indexA);
+		b2CollideEdgeAndPolygon(manifold, &edge, xfA, (const b2PolygonShape*)shapeB, xfB);
+	}
+};
+
+template <>
+struct b2ContactTraits<b2Shape::e_heightfield, b2Shape::e_circle>
+{
+	static void Collide(b2Manifold* manifold,
+						const b2Shape* shapeA, int32 indexA, const b2Transform& xfA,
+						const b2Shape* shapeB, int32 indexB, const b2Transform& xfB,
+						b2SATCache* cache)
+	{
+		B2_NOT_USED(indexA);
+		B2_NOT_USED(indexB);
+		B2_NOT_USED(cache);
+		b2CollideHeightfieldAndCircle(manifold, (const b2HeightfieldShape*)shapeA, xfA, (const b2CircleShape*)shapeB, xfB);
+	}
+};
+
+template <>
+struct b2ContactTraits<b2Shape::e_heightfield, b2Shape::e_polygon>
+{
+	static void Collide(b2Manifold* manifold,
+						const b2Shape* shapeA, int32 indexA, const b2Transform& xfA,
+						const b2Shape* shapeB, int32 indexB, const b2Transform& xfB,
+						b2SATCache* cache)
+	{
+		B2_NOT_USED(indexA);
+		B2_NOT_USED(indexB);
+		B2_NOT_USED(cache);
+		b2CollideHeightfieldAndPolygon(manifold, (const b2HeightfieldShape*)shapeA, xfA, (const b2PolygonShape*)shapeB, xfB);
+	}
+};
+
+#endif
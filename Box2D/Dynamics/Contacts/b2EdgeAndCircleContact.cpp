@@ -17,6 +17,7 @@
 */
 
 #include <Box2D/Dynamics/Contacts/b2EdgeAndCircleContact.h>
+#include <Box2D/Dynamics/Contacts/b2ContactTraits.h>
 #include <Box2D/Common/b2BlockAllocator.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 
@@ -43,7 +44,7 @@ b2EdgeAndCircleContact::b2EdgeAndCircleContact(b2Fixture* fixtureA, b2Fixture* f
 
 void b2EdgeAndCircleContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
 {
-	b2CollideEdgeAndCircle(	manifold,
-								(b2EdgeShape*)m_fixtureA->GetShape(), xfA,
-								(b2CircleShape*)m_fixtureB->GetShape(), xfB);
+	b2ContactTraits<b2Shape::e_edge, b2Shape::e_circle>::Collide(manifold,
+		m_fixtureA->GetShape(), m_indexA, xfA,
+		m_fixtureB->GetShape(), m_indexB, xfB, &m_satCache);
 }
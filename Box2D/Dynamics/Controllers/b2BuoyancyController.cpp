@@ -0,0 +1,171 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/Controllers/b2BuoyancyController.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/b2TimeStep.h>
+#include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Common/b2Draw.h>
+
+b2BuoyancyController::b2BuoyancyController(const b2BuoyancyControllerDef* def)
+: b2Controller(def)
+{
+	m_normal = def->normal;
+	m_normal.Normalize();
+	m_offset = def->offset;
+	m_density = def->density;
+	m_velocity = def->velocity;
+	m_linearDrag = def->linearDrag;
+	m_quadraticDrag = def->quadraticDrag;
+	m_angularDrag = def->angularDrag;
+	m_useDensity = def->useDensity;
+	m_useWorldGravity = def->useWorldGravity;
+	m_gravity = def->gravity;
+}
+
+void b2BuoyancyController::SetSurface(const b2Vec2& normal, float32 offset)
+{
+	m_normal = normal;
+	m_normal.Normalize();
+	m_offset = offset;
+}
+
+void b2BuoyancyController::SetDrag(float32 linearDrag, float32 quadraticDrag, float32 angularDrag)
+{
+	m_linearDrag = linearDrag;
+	m_quadraticDrag = quadraticDrag;
+	m_angularDrag = angularDrag;
+}
+
+float32 b2BuoyancyController::ComputeSubmergedArea(const b2Body* body, b2Vec2* centroid) const
+{
+	const b2Transform& xf = body->GetTransform();
+
+	float32 area = 0.0f;
+	b2Vec2 areac(0.0f, 0.0f);
+	for (const b2Fixture* f = body->GetFixtureList(); f; f = f->GetNext())
+	{
+		if (f->IsSensor())
+		{
+			continue;
+		}
+
+		b2Vec2 sc(0.0f, 0.0f);
+		float32 sarea = f->GetShape()->ComputeSubmergedArea(m_normal, m_offset, xf, &sc);
+		area += sarea;
+		areac += sarea * sc;
+	}
+
+	if (area > b2_epsilon)
+	{
+		*centroid = (1.0f / area) * areac;
+	}
+
+	return area;
+}
+
+void b2BuoyancyController::Step(const b2TimeStep& step)
+{
+	if (m_bodyCount == 0 || step.dt == 0.0f)
+	{
+		return;
+	}
+
+	b2Vec2 gravity = m_useWorldGravity ? m_world->GetGravity() : m_gravity;
+
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* body = m_bodies[i];
+
+		// Sleeping bodies are at rest in the fluid already, don't wake them.
+		if (body->GetType() != b2_dynamicBody || body->IsAwake() == false)
+		{
+			continue;
+		}
+
+		const b2Transform& xf = body->GetTransform();
+
+		float32 area = 0.0f;
+		float32 mass = 0.0f;
+		b2Vec2 areac(0.0f, 0.0f);
+		b2Vec2 massc(0.0f, 0.0f);
+		for (b2Fixture* f = body->GetFixtureList(); f; f = f->GetNext())
+		{
+			if (f->IsSensor())
+			{
+				continue;
+			}
+
+			b2Vec2 sc(0.0f, 0.0f);
+			float32 sarea = f->GetShape()->ComputeSubmergedArea(m_normal, m_offset, xf, &sc);
+			float32 shapeDensity = m_useDensity ? f->GetDensity() : 1.0f;
+
+			area += sarea;
+			areac += sarea * sc;
+			mass += sarea * shapeDensity;
+			massc += (sarea * shapeDensity) * sc;
+		}
+
+		if (area <= b2_epsilon || mass <= b2_epsilon)
+		{
+			continue;
+		}
+
+		areac *= 1.0f / area;
+		massc *= 1.0f / mass;
+
+		// Buoyancy acts at the center of the displaced fluid.
+		b2Vec2 buoyancyForce = (-m_density * area) * gravity;
+		body->ApplyForce(buoyancyForce, massc, false);
+
+		// Drag acts at the centroid of the wetted area. The quadratic term is
+		// clamped so a single step can at most stop the body relative to the
+		// fluid, never reverse it. This keeps large drag stable at any step size.
+		b2Vec2 relVel = body->GetLinearVelocityFromWorldPoint(areac) - m_velocity;
+		float32 speed = relVel.Length();
+		if (speed > b2_epsilon)
+		{
+			float32 dragMagnitude = area * (m_linearDrag + m_quadraticDrag * speed) * speed;
+			float32 maxDrag = body->GetMass() * speed * step.inv_dt;
+			dragMagnitude = b2Min(dragMagnitude, maxDrag);
+			body->ApplyForce((-dragMagnitude / speed) * relVel, areac, false);
+		}
+
+		// Rotational inertia about the center of mass.
+		float32 bodyMass = body->GetMass();
+		b2Vec2 localCenter = body->GetLocalCenter();
+		float32 I = body->GetInertia() - bodyMass * b2Dot(localCenter, localCenter);
+
+		float32 w = body->GetAngularVelocity();
+		float32 angularDrag = area * m_angularDrag * I / bodyMass * w;
+		float32 maxAngularDrag = I * b2Abs(w) * step.inv_dt;
+		angularDrag = b2Clamp(angularDrag, -maxAngularDrag, maxAngularDrag);
+		body->ApplyTorque(-angularDrag, false);
+	}
+}
+
+void b2BuoyancyController::Draw(b2Draw* draw)
+{
+	const float32 r = 1000.0f;
+	b2Vec2 p1 = m_offset * m_normal + r * b2Cross(m_normal, 1.0f);
+	b2Vec2 p2 = m_offset * m_normal - r * b2Cross(m_normal, 1.0f);
+
+	b2Color color(0.0f, 0.0f, 0.8f);
+	draw->DrawSegment(p1, p2, color);
+}
@@ -0,0 +1,133 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_BUOYANCY_CONTROLLER_H
+#define B2_BUOYANCY_CONTROLLER_H
+
+#include <Box2D/Dynamics/Controllers/b2Controller.h>
+
+/// Buoyancy controller definition. The fluid occupies the half plane
+/// below the surface, i.e. points x with dot(normal, x) < offset.
+struct b2BuoyancyControllerDef : public b2ControllerDef
+{
+	b2BuoyancyControllerDef()
+	{
+		type = e_buoyancyController;
+		normal.Set(0.0f, 1.0f);
+		offset = 0.0f;
+		density = 1.0f;
+		velocity.SetZero();
+		linearDrag = 0.0f;
+		quadraticDrag = 0.0f;
+		angularDrag = 0.0f;
+		useDensity = false;
+		useWorldGravity = true;
+		gravity.SetZero();
+	}
+
+	/// The outer surface normal.
+	b2Vec2 normal;
+
+	/// The height of the fluid surface along the normal.
+	float32 offset;
+
+	/// The fluid density in kilograms per meter squared.
+	float32 density;
+
+	/// Fluid velocity, for drag calculations.
+	b2Vec2 velocity;
+
+	/// Linear drag coefficient. Drag grows linearly with the relative speed.
+	float32 linearDrag;
+
+	/// Quadratic drag coefficient. Drag grows with the square of the relative speed.
+	float32 quadraticDrag;
+
+	/// Angular drag coefficient.
+	float32 angularDrag;
+
+	/// If true, the fixture densities are used to find the center of mass of the
+	/// submerged part. This matters for bodies made of several fixtures.
+	bool useDensity;
+
+	/// If true, gravity is taken from the world instead of the gravity parameter.
+	bool useWorldGravity;
+
+	/// Gravity vector, if the world's gravity is not used.
+	b2Vec2 gravity;
+};
+
+/// Calculates buoyancy and fluid drag forces for bodies submerged in a
+/// fluid below a plane. The submerged area and centroid are computed per
+/// fixture, so any convex shape works and partially submerged bodies tip
+/// over naturally. Forces are accumulated on the bodies and integrated by
+/// the island solver in the same step, so the result does not depend on
+/// how often the host application polls the bodies.
+class b2BuoyancyController : public b2Controller
+{
+public:
+
+	/// Set/Get the fluid surface.
+	void SetSurface(const b2Vec2& normal, float32 offset);
+	const b2Vec2& GetNormal() const { return m_normal; }
+	float32 GetOffset() const { return m_offset; }
+
+	/// Set/Get the fluid density.
+	void SetDensity(float32 density) { m_density = density; }
+	float32 GetDensity() const { return m_density; }
+
+	/// Set/Get the fluid velocity.
+	void SetVelocity(const b2Vec2& velocity) { m_velocity = velocity; }
+	const b2Vec2& GetVelocity() const { return m_velocity; }
+
+	/// Set the drag coefficients.
+	void SetDrag(float32 linearDrag, float32 quadraticDrag, float32 angularDrag);
+	float32 GetLinearDrag() const { return m_linearDrag; }
+	float32 GetQuadraticDrag() const { return m_quadraticDrag; }
+	float32 GetAngularDrag() const { return m_angularDrag; }
+
+	/// Compute the submerged area and centroid of a body.
+	/// @param body the body to test.
+	/// @param centroid returns the world centroid of the submerged area.
+	/// @return the submerged area, zero if the body is dry.
+	float32 ComputeSubmergedArea(const b2Body* body, b2Vec2* centroid) const;
+
+	/// @see b2Controller::Step
+	void Step(const b2TimeStep& step);
+
+	/// @see b2Controller::Draw
+	void Draw(b2Draw* draw);
+
+protected:
+	friend class b2Controller;
+
+	b2BuoyancyController(const b2BuoyancyControllerDef* def);
+
+	b2Vec2 m_normal;
+	float32 m_offset;
+	float32 m_density;
+	b2Vec2 m_velocity;
+	float32 m_linearDrag;
+	float32 m_quadraticDrag;
+	float32 m_angularDrag;
+	bool m_useDensity;
+	bool m_useWorldGravity;
+	b2Vec2 m_gravity;
+};
+
+#endif
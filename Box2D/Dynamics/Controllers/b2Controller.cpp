@@ -0,0 +1,159 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/Controllers/b2Controller.h>
+#include <Box2D/Dynamics/Controllers/b2BuoyancyController.h>
+#include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Common/b2BlockAllocator.h>
+#include <string.h>
+#include <new>
+
+b2Controller* b2Controller::Create(const b2ControllerDef* def, b2BlockAllocator* allocator)
+{
+	b2Controller* controller = NULL;
+
+	switch (def->type)
+	{
+	case e_buoyancyController:
+		{
+			void* mem = allocator->Allocate(sizeof(b2BuoyancyController));
+			controller = new (mem) b2BuoyancyController(static_cast<const b2BuoyancyControllerDef*>(def));
+		}
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+
+	return controller;
+}
+
+void b2Controller::Destroy(b2Controller* controller, b2BlockAllocator* allocator)
+{
+	b2ControllerType type = controller->m_type;
+	controller->~b2Controller();
+	switch (type)
+	{
+	case e_buoyancyController:
+		allocator->Free(controller, sizeof(b2BuoyancyController));
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+}
+
+b2Controller::b2Controller(const b2ControllerDef* def)
+{
+	m_type = def->type;
+	m_prev = NULL;
+	m_next = NULL;
+	m_world = NULL;
+
+	m_bodies = NULL;
+	m_edges = NULL;
+	m_bodyCount = 0;
+	m_bodyCapacity = 0;
+
+	m_userData = def->userData;
+}
+
+b2Controller::~b2Controller()
+{
+	Clear();
+	if (m_bodies)
+	{
+		m_world->m_countingAllocator.Free(m_bodies, m_bodyCapacity * sizeof(b2Body*), "b2Controller bodies");
+		m_world->m_countingAllocator.Free(m_edges, m_bodyCapacity * sizeof(b2ControllerEdge*), "b2Controller edges");
+	}
+}
+
+void b2Controller::AddBody(b2Body* body)
+{
+	// A body is only in a few controllers, this doesn't depend on the body count
+	for (b2ControllerEdge* edge = body->m_controllerList; edge; edge = edge->next)
+	{
+		if (edge->controller == this)
+		{
+			return;
+		}
+	}
+
+	if (m_bodyCount == m_bodyCapacity)
+	{
+		b2Allocator* allocator = &m_world->m_countingAllocator;
+		b2Body** oldBodies = m_bodies;
+		b2ControllerEdge** oldEdges = m_edges;
+		int32 oldCapacity = m_bodyCapacity;
+		m_bodyCapacity = m_bodyCapacity > 0 ? 2 * m_bodyCapacity : 16;
+		m_bodies = (b2Body**)allocator->Allocate(m_bodyCapacity * sizeof(b2Body*), "b2Controller bodies");
+		m_edges = (b2ControllerEdge**)allocator->Allocate(m_bodyCapacity * sizeof(b2ControllerEdge*), "b2Controller edges");
+		if (oldBodies)
+		{
+			memcpy(m_bodies, oldBodies, m_bodyCount * sizeof(b2Body*));
+			memcpy(m_edges, oldEdges, m_bodyCount * sizeof(b2ControllerEdge*));
+			allocator->Free(oldBodies, oldCapacity * sizeof(b2Body*), "b2Controller bodies");
+			allocator->Free(oldEdges, oldCapacity * sizeof(b2ControllerEdge*), "b2Controller edges");
+		}
+	}
+
+	b2ControllerEdge* edge = (b2ControllerEdge*)m_world->m_blockAllocator.Allocate(sizeof(b2ControllerEdge));
+	edge->controller = this;
+	edge->index = m_bodyCount;
+	edge->next = body->m_controllerList;
+	body->m_controllerList = edge;
+
+	m_bodies[m_bodyCount] = body;
+	m_edges[m_bodyCount] = edge;
+	++m_bodyCount;
+}
+
+void b2Controller::RemoveBody(b2Body* body)
+{
+	b2ControllerEdge** link = &body->m_controllerList;
+	while (*link && (*link)->controller != this)
+	{
+		link = &(*link)->next;
+	}
+
+	b2ControllerEdge* edge = *link;
+	if (edge == NULL)
+	{
+		return;
+	}
+	*link = edge->next;
+
+	// Swap with the last body to keep the array dense.
+	int32 index = edge->index;
+	--m_bodyCount;
+	m_bodies[index] = m_bodies[m_bodyCount];
+	m_edges[index] = m_edges[m_bodyCount];
+	m_edges[index]->index = index;
+
+	m_world->m_blockAllocator.Free(edge, sizeof(b2ControllerEdge));
+}
+
+void b2Controller::Clear()
+{
+	while (m_bodyCount > 0)
+	{
+		RemoveBody(m_bodies[m_bodyCount - 1]);
+	}
+}
@@ -0,0 +1,174 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_CONTROLLER_H
+#define B2_CONTROLLER_H
+
+#include <Box2D/Common/b2Math.h>
+
+class b2Body;
+class b2Controller;
+class b2BlockAllocator;
+class b2Draw;
+class b2World;
+struct b2TimeStep;
+
+enum b2ControllerType
+{
+	e_unknownController,
+	e_buoyancyController
+};
+
+/// Links a body to a controller it belongs to. Each body keeps a list of its
+/// controllers, so adding and removing a body doesn't scan the controller.
+struct b2ControllerEdge
+{
+	b2Controller* controller;	///< the controller
+	int32 index;				///< the body's position in the controller's body array
+	b2ControllerEdge* next;		///< the next controller of the body
+};
+
+/// Controller definitions are used to construct controllers.
+struct b2ControllerDef
+{
+	b2ControllerDef()
+	{
+		type = e_unknownController;
+		userData = NULL;
+	}
+
+	/// The controller type is set automatically for concrete controller types.
+	b2ControllerType type;
+
+	/// Use this to attach application specific data to your controllers.
+	void* userData;
+};
+
+/// Controllers apply forces to a set of bodies once per time step, before the
+/// bodies are integrated by the island solver. The bodies are kept in a dense
+/// array so a controller can process any number of them in a single pass.
+/// Controllers are created via b2World::CreateController.
+class b2Controller
+{
+public:
+
+	/// Get the type of the concrete controller.
+	b2ControllerType GetType() const;
+
+	/// Add a body to the controller. Adding the same body twice has no effect.
+	void AddBody(b2Body* body);
+
+	/// Remove a body from the controller. The body order is not preserved.
+	/// Removing a body that isn't in the controller has no effect.
+	void RemoveBody(b2Body* body);
+
+	/// Remove all bodies from the controller.
+	void Clear();
+
+	/// Get the bodies affected by this controller.
+	b2Body** GetBodyList();
+	int32 GetBodyCount() const;
+
+	/// Get the next controller in the world controller list.
+	b2Controller* GetNext();
+	const b2Controller* GetNext() const;
+
+	/// Get the parent world of this controller.
+	b2World* GetWorld();
+	const b2World* GetWorld() const;
+
+	/// Get the user data pointer.
+	void* GetUserData() const;
+
+	/// Set the user data pointer.
+	void SetUserData(void* data);
+
+	/// Apply the controller forces for this time step.
+	virtual void Step(const b2TimeStep& step) = 0;
+
+	/// Draw debug data for this controller.
+	virtual void Draw(b2Draw* draw) { B2_NOT_USED(draw); }
+
+protected:
+	friend class b2World;
+
+	static b2Controller* Create(const b2ControllerDef* def, b2BlockAllocator* allocator);
+	static void Destroy(b2Controller* controller, b2BlockAllocator* allocator);
+
+	b2Controller(const b2ControllerDef* def);
+	virtual ~b2Controller();
+
+	b2ControllerType m_type;
+	b2Controller* m_prev;
+	b2Controller* m_next;
+	b2World* m_world;
+
+	b2Body** m_bodies;
+	b2ControllerEdge** m_edges;	// The edge of each body, to fix its index when bodies move
+	int32 m_bodyCount;
+	int32 m_bodyCapacity;
+
+	void* m_userData;
+};
+
+inline b2ControllerType b2Controller::GetType() const
+{
+	return m_type;
+}
+
+inline b2Body** b2Controller::GetBodyList()
+{
+	return m_bodies;
+}
+
+inline int32 b2Controller::GetBodyCount() const
+{
+	return m_bodyCount;
+}
+
+inline b2Controller* b2Controller::GetNext()
+{
+	return m_next;
+}
+
+inline const b2Controller* b2Controller::GetNext() const
+{
+	return m_next;
+}
+
+inline b2World* b2Controller::GetWorld()
+{
+	return m_world;
+}
+
+inline const b2World* b2Controller::GetWorld() const
+{
+	return m_world;
+}
+
+inline void* b2Controller::GetUserData() const
+{
+	return m_userData;
+}
+
+inline void b2Controller::SetUserData(void* data)
+{
+	m_userData = data;
+}
+
+#endif
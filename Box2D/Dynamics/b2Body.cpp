@@ -55,6 +55,8 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	}
 
 	m_world = world;
+	m_handle.index = 0;
+	m_handle.generation = 0;
 
 	m_xf.p = bd->position;
 	m_xf.q.Set(bd->angle);
@@ -68,6 +70,7 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 
 	m_jointList = NULL;
 	m_contactList = NULL;
+	m_controllerList = NULL;
 	m_prev = NULL;
 	m_next = NULL;
 
@@ -83,6 +86,10 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 
 	m_sleepTime = 0.0f;
 
+	m_islandId = b2_nullIsland;
+	m_islandPrev = NULL;
+	m_islandNext = NULL;
+
 	m_type = bd->type;
 
 	if (m_type == b2_dynamicBody)
@@ -136,6 +143,19 @@ void b2Body::SetType(b2BodyType type)
 		SynchronizeFixtures();
 	}
 
+	// Static bodies don't belong to islands.
+	if (m_flags & e_activeFlag)
+	{
+		if (m_type == b2_staticBody)
+		{
+			m_world->m_islandManager.RemoveBody(this);
+		}
+		else if (m_islandId == b2_nullIsland)
+		{
+			AddToIsland();
+		}
+	}
+
 	SetAwake(true);
 
 	m_force.SetZero();
@@ -173,8 +193,10 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 
 	b2BlockAllocator* allocator = &m_world->m_blockAllocator;
 
-	void* memory = allocator->Allocate(sizeof(b2Fixture));
+	b2Handle handle;
+	void* memory = m_world->m_fixturePool.Allocate(&handle);
 	b2Fixture* fixture = new (memory) b2Fixture;
+	fixture->m_handle = handle;
 	fixture->Create(allocator, this, def);
 
 	if (m_flags & e_activeFlag)
@@ -269,8 +291,9 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 	fixture->Destroy(allocator);
 	fixture->m_body = NULL;
 	fixture->m_next = NULL;
+	b2Handle handle = fixture->m_handle;
 	fixture->~b2Fixture();
-	allocator->Free(fixture, sizeof(b2Fixture));
+	m_world->m_fixturePool.Free(handle);
 
 	--m_fixtureCount;
 
@@ -464,6 +487,11 @@ void b2Body::SetActive(bool flag)
 	{
 		m_flags |= e_activeFlag;
 
+		if (m_type != b2_staticBody)
+		{
+			AddToIsland();
+		}
+
 		// Create all proxies.
 		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
@@ -477,6 +505,8 @@ void b2Body::SetActive(bool flag)
 	{
 		m_flags &= ~e_activeFlag;
 
+		m_world->m_islandManager.RemoveBody(this);
+
 		// Destroy all proxies.
 		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
 		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
@@ -496,6 +526,59 @@ void b2Body::SetActive(bool flag)
 	}
 }
 
+void b2Body::SetAwake(bool flag)
+{
+	if (m_islandId != b2_nullIsland)
+	{
+		// The whole island changes state.
+		if (flag)
+		{
+			if ((m_flags & e_awakeFlag) == 0)
+			{
+				m_world->m_islandManager.Wake(m_islandId);
+			}
+		}
+		else
+		{
+			m_world->m_islandManager.Sleep(m_islandId);
+		}
+		return;
+	}
+
+	if (flag)
+	{
+		if ((m_flags & e_awakeFlag) == 0)
+		{
+			m_flags |= e_awakeFlag;
+			m_sleepTime = 0.0f;
+		}
+	}
+	else
+	{
+		m_flags &= ~e_awakeFlag;
+		m_sleepTime = 0.0f;
+		m_linearVelocity.SetZero();
+		m_angularVelocity = 0.0f;
+		m_force.SetZero();
+		m_torque = 0.0f;
+	}
+}
+
+void b2Body::AddToIsland()
+{
+	b2IslandManager* islandManager = &m_world->m_islandManager;
+	islandManager->AddBody(this);
+
+	// Joints to this body were ignored while it had no island.
+	for (b2JointEdge* je = m_jointList; je; je = je->next)
+	{
+		if (je->other->IsActive())
+		{
+			islandManager->Link(this, je->other);
+		}
+	}
+}
+
 void b2Body::SetFixedRotation(bool flag)
 {
 	bool status = (m_flags & e_fixedRotationFlag) == e_fixedRotationFlag;
@@ -20,6 +20,7 @@
 #define B2_BODY_H
 
 #include <Box2D/Common/b2Math.h>
+#include <Box2D/Common/b2HandlePool.h>
 #include <Box2D/Collision/Shapes/b2Shape.h>
 #include <memory>
 
@@ -31,6 +32,7 @@ class b2World;
 struct b2FixtureDef;
 struct b2JointEdge;
 struct b2ContactEdge;
+struct b2ControllerEdge;
 
 /// The body type.
 /// static: zero mass, zero velocity, may be manually moved
@@ -319,7 +321,12 @@ public:
 	bool IsSleepingAllowed() const;
 
 	/// Set the sleep state of the body. A sleeping body has very
-	/// low CPU cost.
+	/// low CPU cost. Bodies sleep and wake together with their island,
+	/// the bodies connected to them by touching contacts and joints.
+	/// So SetAwake(false) also puts every other body of the island to
+	/// sleep and zeroes their velocities, forces and torques, and
+	/// SetAwake(true) wakes them all. Static and inactive bodies have no
+	/// island and only change themselves.
 	/// @param flag set to true to wake the body, false to put it to sleep.
 	void SetAwake(bool flag);
 
@@ -380,6 +387,10 @@ public:
 	b2World* GetWorld();
 	const b2World* GetWorld() const;
 
+	/// Get the handle of this body. Use b2World::GetBody to look it up, which
+	/// returns NULL once the body is destroyed.
+	b2Handle GetHandle() const;
+
 	/// Dump this body to a log file
 	void Dump();
 
@@ -387,9 +398,12 @@ private:
 
 	friend class b2World;
 	friend class b2Island;
+	friend class b2BodyStore;
+	friend class b2IslandManager;
 	friend class b2ContactManager;
 	friend class b2ContactSolver;
 	friend class b2Contact;
+	friend class b2Controller;
 	
 	friend class b2DistanceJoint;
 	friend class b2FrictionJoint;
@@ -412,7 +426,8 @@ private:
 		e_bulletFlag		= 0x0008,
 		e_fixedRotationFlag	= 0x0010,
 		e_activeFlag		= 0x0020,
-		e_toiFlag			= 0x0040
+		e_toiFlag			= 0x0040,
+		e_debugDrawFlag		= 0x0080
 	};
 
 	b2Body(const b2BodyDef* bd, b2World* world);
@@ -421,6 +436,9 @@ private:
 	void SynchronizeFixtures();
 	void SynchronizeTransform();
 
+	// Give the body an island and link the joints it already has.
+	void AddToIsland();
+
 	// This is used to prevent connected bodies from colliding.
 	// It may lie, depending on the collideConnected flag.
 	bool ShouldCollide(const b2Body* other) const;
@@ -433,6 +451,11 @@ private:
 
 	int32 m_islandIndex;
 
+	// The persistent island, b2_nullIsland for static and inactive bodies.
+	int32 m_islandId;
+	b2Body* m_islandPrev;
+	b2Body* m_islandNext;
+
 	b2Transform m_xf;		// the body origin transform
 	b2Sweep m_sweep;		// the swept motion for CCD
 
@@ -443,6 +466,7 @@ private:
 	float32 m_torque;
 
 	b2World* m_world;
+	b2Handle m_handle;
 	b2Body* m_prev;
 	b2Body* m_next;
 
@@ -451,6 +475,7 @@ private:
 
 	b2JointEdge* m_jointList;
 	b2ContactEdge* m_contactList;
+	b2ControllerEdge* m_controllerList;
 
 	float32 m_mass, m_invMass;
 
@@ -630,27 +655,6 @@ inline bool b2Body::IsBullet() const
 	return (m_flags & e_bulletFlag) == e_bulletFlag;
 }
 
-inline void b2Body::SetAwake(bool flag)
-{
-	if (flag)
-	{
-		if ((m_flags & e_awakeFlag) == 0)
-		{
-			m_flags |= e_awakeFlag;
-			m_sleepTime = 0.0f;
-		}
-	}
-	else
-	{
-		m_flags &= ~e_awakeFlag;
-		m_sleepTime = 0.0f;
-		m_linearVelocity.SetZero();
-		m_angularVelocity = 0.0f;
-		m_force.SetZero();
-		m_torque = 0.0f;
-	}
-}
-
 inline bool b2Body::IsAwake() const
 {
 	return (m_flags & e_awakeFlag) == e_awakeFlag;
@@ -857,4 +861,9 @@ inline const b2World* b2Body::GetWorld() const
 	return m_world;
 }
 
+inline b2Handle b2Body::GetHandle() const
+{
+	return m_handle;
+}
+
 #endif
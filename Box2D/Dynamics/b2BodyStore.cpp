@@ -0,0 +1,414 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2BodyStore.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2WorldCallbacks.h>
+#include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
+#include <Box2D/Dynamics/Joints/b2Joint.h>
+#include <Box2D/Common/b2Allocator.h>
+#include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2Profiler.h>
+
+b2BodyStore::b2BodyStore(b2Allocator* allocator)
+{
+	m_allocator = allocator;
+
+	m_bodyData = NULL;
+	m_contactData = NULL;
+	m_jointData = NULL;
+
+	m_bodies = NULL;
+	m_positions = NULL;
+	m_velocities = NULL;
+	m_invMass = NULL;
+	m_invI = NULL;
+	m_gravityScale = NULL;
+	m_linearDamping = NULL;
+	m_angularDamping = NULL;
+	m_forceX = NULL;
+	m_forceY = NULL;
+	m_torque = NULL;
+	m_islands = NULL;
+	m_contacts = NULL;
+	m_joints = NULL;
+
+	m_bodyCount = 0;
+	m_contactCount = 0;
+	m_jointCount = 0;
+	m_islandCount = 0;
+
+	m_bodyCapacity = 0;
+	m_contactCapacity = 0;
+	m_jointCapacity = 0;
+}
+
+const int32 b2BodyStore::s_bodyStride = sizeof(b2Body*) + sizeof(b2Position) + sizeof(b2Velocity)
+	+ 8 * sizeof(float32) + sizeof(b2IslandRange);
+
+b2BodyStore::~b2BodyStore()
+{
+	m_allocator->Free(m_jointData, m_jointCapacity * sizeof(b2Joint*), "b2BodyStore joints");
+	m_allocator->Free(m_contactData, m_contactCapacity * sizeof(b2Contact*), "b2BodyStore contacts");
+	m_allocator->Free(m_bodyData, m_bodyCapacity * s_bodyStride, "b2BodyStore bodies");
+}
+
+void b2BodyStore::Reserve(int32 bodyCount, int32 contactCount, int32 jointCount)
+{
+	// The contents are refilled every step, so nothing is copied.
+	if (bodyCount > m_bodyCapacity)
+	{
+		b2Assert(m_bodyCount == 0);
+		m_allocator->Free(m_bodyData, m_bodyCapacity * s_bodyStride, "b2BodyStore bodies");
+		m_bodyCapacity = b2Max(bodyCount, 2 * m_bodyCapacity);
+		m_bodyData = m_allocator->Allocate(m_bodyCapacity * s_bodyStride, "b2BodyStore bodies");
+
+		// Pointers first, everything after needs 4 byte alignment.
+		int32 n = m_bodyCapacity;
+		m_bodies = (b2Body**)m_bodyData;
+		m_positions = (b2Position*)(m_bodies + n);
+		m_velocities = (b2Velocity*)(m_positions + n);
+		m_invMass = (float32*)(m_velocities + n);
+		m_invI = m_invMass + n;
+		m_gravityScale = m_invI + n;
+		m_linearDamping = m_gravityScale + n;
+		m_angularDamping = m_linearDamping + n;
+		m_forceX = m_angularDamping + n;
+		m_forceY = m_forceX + n;
+		m_torque = m_forceY + n;
+		m_islands = (b2IslandRange*)(m_torque + n);
+	}
+
+	if (contactCount > m_contactCapacity)
+	{
+		b2Assert(m_contactCount == 0);
+		m_allocator->Free(m_contactData, m_contactCapacity * sizeof(b2Contact*), "b2BodyStore contacts");
+		m_contactCapacity = b2Max(contactCount, 2 * m_contactCapacity);
+		m_contactData = m_allocator->Allocate(m_contactCapacity * sizeof(b2Contact*), "b2BodyStore contacts");
+		m_contacts = (b2Contact**)m_contactData;
+	}
+
+	if (jointCount > m_jointCapacity)
+	{
+		b2Assert(m_jointCount == 0);
+		m_allocator->Free(m_jointData, m_jointCapacity * sizeof(b2Joint*), "b2BodyStore joints");
+		m_jointCapacity = b2Max(jointCount, 2 * m_jointCapacity);
+		m_jointData = m_allocator->Allocate(m_jointCapacity * sizeof(b2Joint*), "b2BodyStore joints");
+		m_joints = (b2Joint**)m_jointData;
+	}
+}
+
+void b2BodyStore::Clear(int32 bodyCount, int32 contactCount, int32 jointCount)
+{
+	m_bodyCount = 0;
+	m_contactCount = 0;
+	m_jointCount = 0;
+	m_islandCount = 0;
+
+	Reserve(bodyCount, contactCount, jointCount);
+}
+
+void b2BodyStore::BeginIsland(int32 islandId)
+{
+	b2Assert(m_islandCount < m_bodyCapacity);
+	b2IslandRange* island = m_islands + m_islandCount;
+	island->islandId = islandId;
+	island->bodyStart = m_bodyCount;
+	island->contactStart = m_contactCount;
+	island->jointStart = m_jointCount;
+}
+
+void b2BodyStore::EndIsland()
+{
+	b2IslandRange* island = m_islands + m_islandCount;
+	island->bodyCount = m_bodyCount - island->bodyStart;
+	island->contactCount = m_contactCount - island->contactStart;
+	island->jointCount = m_jointCount - island->jointStart;
+	++m_islandCount;
+}
+
+void b2BodyStore::Add(b2Body* body)
+{
+	b2Assert(m_bodyCount < m_bodyCapacity);
+	int32 i = m_bodyCount++;
+	body->m_islandIndex = i;
+	m_bodies[i] = body;
+
+	// Store positions for continuous collision.
+	body->m_sweep.c0 = body->m_sweep.c;
+	body->m_sweep.a0 = body->m_sweep.a;
+
+	m_positions[i].c = body->m_sweep.c;
+	m_positions[i].a = body->m_sweep.a;
+	m_velocities[i].v = body->m_linearVelocity;
+	m_velocities[i].w = body->m_angularVelocity;
+
+	if (body->m_type == b2_dynamicBody)
+	{
+		m_invMass[i] = body->m_invMass;
+		m_invI[i] = body->m_invI;
+		m_gravityScale[i] = body->m_gravityScale;
+		m_linearDamping[i] = body->m_linearDamping;
+		m_angularDamping[i] = body->m_angularDamping;
+		m_forceX[i] = body->m_force.x;
+		m_forceY[i] = body->m_force.y;
+		m_torque[i] = body->m_torque;
+	}
+	else
+	{
+		// This leaves the velocity untouched.
+		m_invMass[i] = 0.0f;
+		m_invI[i] = 0.0f;
+		m_gravityScale[i] = 0.0f;
+		m_linearDamping[i] = 0.0f;
+		m_angularDamping[i] = 0.0f;
+		m_forceX[i] = 0.0f;
+		m_forceY[i] = 0.0f;
+		m_torque[i] = 0.0f;
+	}
+}
+
+void b2BodyStore::IntegrateVelocities(float32 h, const b2Vec2& gravity)
+{
+	// Apply damping.
+	// ODE: dv/dt + c * v = 0
+	// Solution: v(t) = v0 * exp(-c * t)
+	// Time step: v(t + dt) = v0 * exp(-c * (t + dt)) = v0 * exp(-c * t) * exp(-c * dt) = v * exp(-c * dt)
+	// v2 = exp(-c * dt) * v1
+	// Pade approximation:
+	// v2 = v1 * 1 / (1 + c * dt)
+	int32 count = m_bodyCount;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 linearScale = 1.0f / (1.0f + h * m_linearDamping[i]);
+		float32 angularScale = 1.0f / (1.0f + h * m_angularDamping[i]);
+
+		b2Velocity* velocity = m_velocities + i;
+		float32 vx = velocity->v.x + h * (m_gravityScale[i] * gravity.x + m_invMass[i] * m_forceX[i]);
+		float32 vy = velocity->v.y + h * (m_gravityScale[i] * gravity.y + m_invMass[i] * m_forceY[i]);
+		float32 w = velocity->w + h * m_invI[i] * m_torque[i];
+
+		velocity->v.x = linearScale * vx;
+		velocity->v.y = linearScale * vy;
+		velocity->w = angularScale * w;
+	}
+}
+
+void b2BodyStore::IntegratePositions(float32 h)
+{
+	int32 count = m_bodyCount;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Vec2 c = m_positions[i].c;
+		float32 a = m_positions[i].a;
+		b2Vec2 v = m_velocities[i].v;
+		float32 w = m_velocities[i].w;
+
+		// Check for large velocities
+		b2Vec2 translation = h * v;
+		if (b2Dot(translation, translation) > b2_maxTranslationSquared)
+		{
+			float32 ratio = b2_maxTranslation / translation.Length();
+			v *= ratio;
+		}
+
+		float32 rotation = h * w;
+		if (rotation * rotation > b2_maxRotationSquared)
+		{
+			float32 ratio = b2_maxRotation / b2Abs(rotation);
+			w *= ratio;
+		}
+
+		// Integrate
+		c += h * v;
+		a += h * w;
+
+		m_positions[i].c = c;
+		m_positions[i].a = a;
+		m_velocities[i].v = v;
+		m_velocities[i].w = w;
+	}
+}
+
+void b2BodyStore::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep,
+						b2StackAllocator* stackAllocator, b2ContactListener* listener)
+{
+	B2_PROFILE_SCOPE("b2BodyStore::Solve");
+	b2Timer timer;
+
+	float32 h = step.dt;
+
+	IntegrateVelocities(h, gravity);
+
+	// Solver data
+	b2SolverData solverData;
+	solverData.step = step;
+	solverData.positions = m_positions;
+	solverData.velocities = m_velocities;
+
+	// Initialize velocity constraints. One contact solver covers all
+	// islands, the body indices are global.
+	b2ContactSolverDef contactSolverDef;
+	contactSolverDef.step = step;
+	contactSolverDef.contacts = m_contacts;
+	contactSolverDef.count = m_contactCount;
+	contactSolverDef.positions = m_positions;
+	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.allocator = stackAllocator;
+
+	b2ContactSolver contactSolver(&contactSolverDef);
+	contactSolver.InitializeVelocityConstraints();
+
+	if (step.warmStarting)
+	{
+		contactSolver.WarmStart();
+	}
+
+	for (int32 i = 0; i < m_jointCount; ++i)
+	{
+		m_joints[i]->InitVelocityConstraints(solverData);
+	}
+
+	profile->solveInit = timer.GetMilliseconds();
+
+	// Solve velocity constraints. Islands share no dynamic bodies, so
+	// sweeping all of them per iteration gives the same result as solving
+	// them one after another.
+	timer.Reset();
+	for (int32 i = 0; i < step.velocityIterations; ++i)
+	{
+		for (int32 j = 0; j < m_jointCount; ++j)
+		{
+			m_joints[j]->SolveVelocityConstraints(solverData);
+		}
+
+		contactSolver.SolveVelocityConstraints();
+	}
+
+	// Store impulses for warm starting
+	contactSolver.StoreImpulses();
+	profile->solveVelocity = timer.GetMilliseconds();
+
+	IntegratePositions(h);
+
+	// Position iterations stop early per island, so these run island by island.
+	timer.Reset();
+	const float32 linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
+	const float32 angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
+	for (int32 k = 0; k < m_islandCount; ++k)
+	{
+		b2IslandRange* island = m_islands + k;
+		int32 contactEnd = island->contactStart + island->contactCount;
+		int32 jointEnd = island->jointStart + island->jointCount;
+
+		bool positionSolved = false;
+		for (int32 i = 0; i < step.positionIterations; ++i)
+		{
+			bool contactsOkay = contactSolver.SolvePositionConstraints(island->contactStart, contactEnd);
+
+			bool jointsOkay = true;
+			for (int32 j = island->jointStart; j < jointEnd; ++j)
+			{
+				bool jointOkay = m_joints[j]->SolvePositionConstraints(solverData);
+				jointsOkay = jointsOkay && jointOkay;
+			}
+
+			if (contactsOkay && jointsOkay)
+			{
+				// Exit early if the position errors are small.
+				positionSolved = true;
+				break;
+			}
+		}
+
+		// Copy the state back to the bodies and track the sleep time.
+		float32 minSleepTime = b2_maxFloat;
+		float32 maxSleepTime = 0.0f;
+		int32 bodyEnd = island->bodyStart + island->bodyCount;
+		for (int32 i = island->bodyStart; i < bodyEnd; ++i)
+		{
+			b2Body* b = m_bodies[i];
+			if (b->m_type == b2_staticBody)
+			{
+				continue;
+			}
+
+			b2Vec2 v = m_velocities[i].v;
+			float32 w = m_velocities[i].w;
+
+			b->m_sweep.c = m_positions[i].c;
+			b->m_sweep.a = m_positions[i].a;
+			b->m_linearVelocity = v;
+			b->m_angularVelocity = w;
+			b->SynchronizeTransform();
+
+			if (allowSleep == false)
+			{
+				continue;
+			}
+
+			if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
+				w * w > angTolSqr ||
+				b2Dot(v, v) > linTolSqr)
+			{
+				b->m_sleepTime = 0.0f;
+			}
+			else
+			{
+				b->m_sleepTime += h;
+			}
+
+			minSleepTime = b2Min(minSleepTime, b->m_sleepTime);
+			maxSleepTime = b2Max(maxSleepTime, b->m_sleepTime);
+		}
+
+		island->minSleepTime = minSleepTime;
+		island->maxSleepTime = maxSleepTime;
+		island->positionSolved = positionSolved;
+	}
+
+	profile->solvePosition = timer.GetMilliseconds();
+
+	Report(contactSolver.m_velocityConstraints, listener);
+}
+
+void b2BodyStore::Report(const b2ContactVelocityConstraint* constraints, b2ContactListener* listener)
+{
+	if (listener == NULL)
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < m_contactCount; ++i)
+	{
+		b2Contact* c = m_contacts[i];
+
+		const b2ContactVelocityConstraint* vc = constraints + i;
+		
+		b2ContactImpulse impulse;
+		impulse.count = vc->pointCount;
+		for (int32 j = 0; j < vc->pointCount; ++j)
+		{
+			impulse.normalImpulses[j] = vc->points[j].normalImpulse;
+			impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
+		}
+
+		listener->PostSolve(c, &impulse);
+	}
+}
@@ -0,0 +1,148 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_BODY_STORE_H
+#define B2_BODY_STORE_H
+
+#include <Box2D/Common/b2Math.h>
+#include <Box2D/Dynamics/b2TimeStep.h>
+
+class b2Allocator;
+class b2Body;
+class b2Contact;
+class b2Joint;
+class b2StackAllocator;
+class b2ContactListener;
+struct b2ContactVelocityConstraint;
+
+/// This is an internal class.
+/// Staging buffers for the solver state of all awake islands. The bodies
+/// still own their state: every step the world copies the sweep, velocities,
+/// forces and damping of each awake body in with Add, and Solve copies the
+/// results back. The sleep test reads the body flags as before. What the
+/// store saves over b2Island is the per island setup: the islands are laid
+/// out back to back, so the integration and the velocity iterations run once
+/// over contiguous arrays for the whole step. Positions and velocities use
+/// the layout of the constraint solvers. The inputs of the velocity
+/// integration are split into separate arrays so that loop vectorizes. The
+/// buffers are kept between steps.
+class b2BodyStore
+{
+public:
+	b2BodyStore(b2Allocator* allocator);
+	~b2BodyStore();
+
+	/// Make room for the given number of bodies, contacts and joints.
+	void Reserve(int32 bodyCount, int32 contactCount, int32 jointCount);
+
+	/// Empty the store and make room for the given counts.
+	void Clear(int32 bodyCount, int32 contactCount, int32 jointCount);
+
+	/// Islands are added between these calls.
+	void BeginIsland(int32 islandId);
+	void EndIsland();
+
+	/// Add a body and copy its state in. Static bodies may be shared by
+	/// islands and must only be added once.
+	void Add(b2Body* body);
+
+	void Add(b2Contact* contact)
+	{
+		b2Assert(m_contactCount < m_contactCapacity);
+		m_contacts[m_contactCount++] = contact;
+	}
+
+	void Add(b2Joint* joint)
+	{
+		b2Assert(m_jointCount < m_jointCapacity);
+		m_joints[m_jointCount++] = joint;
+	}
+
+	/// Solve all islands, copy the state back to the bodies and advance
+	/// their sleep timers.
+	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep,
+			   b2StackAllocator* stackAllocator, b2ContactListener* listener);
+
+	int32 GetBodyCount() const { return m_bodyCount; }
+	b2Body* GetBody(int32 index) const { return m_bodies[index]; }
+
+	int32 GetIslandCount() const { return m_islandCount; }
+	int32 GetIslandId(int32 index) const { return m_islands[index].islandId; }
+
+	/// The smallest and largest sleep time of the island's bodies.
+	float32 GetMinSleepTime(int32 index) const { return m_islands[index].minSleepTime; }
+	float32 GetMaxSleepTime(int32 index) const { return m_islands[index].maxSleepTime; }
+	bool IsPositionSolved(int32 index) const { return m_islands[index].positionSolved; }
+
+private:
+
+	struct b2IslandRange
+	{
+		int32 islandId;
+		int32 bodyStart, bodyCount;
+		int32 contactStart, contactCount;
+		int32 jointStart, jointCount;
+		float32 minSleepTime, maxSleepTime;
+		bool positionSolved;
+	};
+
+	// Bytes of all per body arrays for one body.
+	static const int32 s_bodyStride;
+
+	void IntegrateVelocities(float32 h, const b2Vec2& gravity);
+	void IntegratePositions(float32 h);
+	void Report(const b2ContactVelocityConstraint* constraints, b2ContactListener* listener);
+
+	b2Allocator* m_allocator;
+
+	// One allocation for each of bodies, contacts and joints.
+	void* m_bodyData;
+	void* m_contactData;
+	void* m_jointData;
+
+	b2Body** m_bodies;
+	b2Position* m_positions;
+	b2Velocity* m_velocities;
+
+	// Velocity integration inputs. Zero for static and kinematic bodies.
+	float32* m_invMass;
+	float32* m_invI;
+	float32* m_gravityScale;
+	float32* m_linearDamping;
+	float32* m_angularDamping;
+	float32* m_forceX;
+	float32* m_forceY;
+	float32* m_torque;
+
+	// There are never more islands than bodies.
+	b2IslandRange* m_islands;
+
+	b2Contact** m_contacts;
+	b2Joint** m_joints;
+
+	int32 m_bodyCount;
+	int32 m_contactCount;
+	int32 m_jointCount;
+	int32 m_islandCount;
+
+	int32 m_bodyCapacity;
+	int32 m_contactCapacity;
+	int32 m_jointCapacity;
+};
+
+#endif
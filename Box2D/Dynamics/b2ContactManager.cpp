@@ -21,17 +21,228 @@
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Dynamics/Contacts/b2ContactTraits.h>
+#include <Box2D/Common/b2Allocator.h>
+#include <Box2D/Common/b2Profiler.h>
+#include <memory.h>
 
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
 
-b2ContactManager::b2ContactManager()
+// The narrow phase of each batch, indexed like b2ContactManager::GetBatch.
+typedef void (b2ContactManager::*b2CollideFcn)(int32 batch);
+static b2CollideFcn s_collideFcns[b2_contactBatchCount];
+static bool s_collideFcnsInitialized = false;
+
+static void b2AddCollideFcn(b2CollideFcn collideFcn, b2Shape::Type typeA, b2Shape::Type typeB)
+{
+	s_collideFcns[typeA * b2Shape::e_typeCount + typeB] = collideFcn;
+}
+
+b2ContactManager::b2ContactManager(b2Allocator* allocator)
+	: m_broadPhase(allocator), m_pairTable(allocator)
 {
 	m_contactList = NULL;
 	m_contactCount = 0;
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
 	m_allocator = NULL;
+
+	m_contacts = NULL;
+	m_collideContacts = NULL;
+	m_contactCapacity = 0;
+	m_slotCount = 0;
+	m_collideCount = 0;
+	m_compacting = false;
+	m_sensorEvents = NULL;
+	m_sensorEventCount = 0;
+	m_sensorEventCapacity = 0;
+	m_sensorEventsEnabled = false;
+	for (int32 i = 0; i <= b2_contactBatchCount; ++i)
+	{
+		m_batchStart[i] = 0;
+	}
+
+	m_heapAllocator = allocator;
+
+	if (s_collideFcnsInitialized == false)
+	{
+		// Fixture A has the first type, as registered in b2Contact::InitializeRegisters.
+		b2AddCollideFcn(&b2ContactManager::CollideBatch<b2Shape::e_circle, b2Shape::e_circle>, b2Shape::e_circle, b2Shape::e_circle);
+		b2AddCollideFcn(&b2ContactManager::CollideBatch<b2Shape::e_polygon, b2Shape::e_circle>, b2Shape::e_polygon, b2Shape::e_circle);
+		b2AddCollideFcn(&b2ContactManager::CollideBatch<b2Shape::e_polygon, b2Shape::e_polygon>, b2Shape::e_polygon, b2Shape::e_polygon);
+		b2AddCollideFcn(&b2ContactManager::CollideBatch<b2Shape::e_edge, b2Shape::e_circle>, b2Shape::e_edge, b2Shape::e_circle);
+		b2AddCollideFcn(&b2ContactManager::CollideBatch<b2Shape::e_edge, b2Shape::e_polygon>, b2Shape::e_edge, b2Shape::e_polygon);
+		b2AddCollideFcn(&b2ContactManager::CollideBatch<b2Shape::e_chain, b2Shape::e_circle>, b2Shape::e_chain, b2Shape::e_circle);
+		b2AddCollideFcn(&b2ContactManager::CollideBatch<b2Shape::e_chain, b2Shape::e_polygon>, b2Shape::e_chain, b2Shape::e_polygon);
+		b2AddCollideFcn(&b2ContactManager::CollideBatch<b2Shape::e_heightfield, b2Shape::e_circle>, b2Shape::e_heightfield, b2Shape::e_circle);
+		b2AddCollideFcn(&b2ContactManager::CollideBatch<b2Shape::e_heightfield, b2Shape::e_polygon>, b2Shape::e_heightfield, b2Shape::e_polygon);
+		s_collideFcnsInitialized = true;
+	}
+}
+
+b2ContactManager::~b2ContactManager()
+{
+	m_heapAllocator->Free(m_collideContacts, m_contactCapacity * sizeof(b2Contact*), "b2ContactManager contacts");
+	m_heapAllocator->Free(m_contacts, m_contactCapacity * sizeof(b2Contact*), "b2ContactManager contacts");
+	m_heapAllocator->Free(m_sensorEvents, m_sensorEventCapacity * sizeof(b2SensorEvent), "b2ContactManager sensor events");
+}
+
+void b2ContactManager::Reserve(int32 contactCount)
+{
+	m_pairTable.Reserve(contactCount);
+
+	// A step rarely begins or ends more sensor overlaps than there are contacts.
+	if (m_sensorEventsEnabled)
+	{
+		ReserveSensorEvents(contactCount);
+	}
+
+	if (contactCount <= m_contactCapacity)
+	{
+		return;
+	}
+
+	b2Contact** oldContacts = m_contacts;
+	b2Contact** oldCollideContacts = m_collideContacts;
+	int32 oldCapacity = m_contactCapacity;
+
+	m_contactCapacity = contactCount;
+	m_contacts = (b2Contact**)m_heapAllocator->Allocate(m_contactCapacity * sizeof(b2Contact*), "b2ContactManager contacts");
+	m_collideContacts = (b2Contact**)m_heapAllocator->Allocate(m_contactCapacity * sizeof(b2Contact*), "b2ContactManager contacts");
+	if (oldCapacity > 0)
+	{
+		memcpy(m_contacts, oldContacts, m_slotCount * sizeof(b2Contact*));
+	}
+
+	m_heapAllocator->Free(oldCollideContacts, oldCapacity * sizeof(b2Contact*), "b2ContactManager contacts");
+	m_heapAllocator->Free(oldContacts, oldCapacity * sizeof(b2Contact*), "b2ContactManager contacts");
+}
+
+void b2ContactManager::ReserveSensorEvents(int32 eventCount)
+{
+	if (eventCount <= m_sensorEventCapacity)
+	{
+		return;
+	}
+
+	b2SensorEvent* oldEvents = m_sensorEvents;
+	int32 oldCapacity = m_sensorEventCapacity;
+
+	m_sensorEventCapacity = eventCount;
+	m_sensorEvents = (b2SensorEvent*)m_heapAllocator->Allocate(m_sensorEventCapacity * sizeof(b2SensorEvent), "b2ContactManager sensor events");
+	if (oldCapacity > 0)
+	{
+		memcpy(m_sensorEvents, oldEvents, m_sensorEventCount * sizeof(b2SensorEvent));
+	}
+
+	m_heapAllocator->Free(oldEvents, oldCapacity * sizeof(b2SensorEvent), "b2ContactManager sensor events");
+}
+
+void b2ContactManager::AddSensorEvents(b2Contact* c, bool begin)
+{
+	if (m_sensorEventsEnabled == false)
+	{
+		return;
+	}
+
+	b2Fixture* fixtureA = c->GetFixtureA();
+	b2Fixture* fixtureB = c->GetFixtureB();
+	int32 eventCount = (fixtureA->IsSensor() ? 1 : 0) + (fixtureB->IsSensor() ? 1 : 0);
+	if (m_sensorEventCount + eventCount > m_sensorEventCapacity)
+	{
+		ReserveSensorEvents(b2Max(16, 2 * m_sensorEventCapacity));
+	}
+
+	if (fixtureA->IsSensor())
+	{
+		b2SensorEvent* event = m_sensorEvents + m_sensorEventCount++;
+		event->sensorFixture = fixtureA;
+		event->visitorFixture = fixtureB;
+		event->visitorBody = fixtureB->GetBody();
+		event->begin = begin;
+	}
+
+	if (fixtureB->IsSensor())
+	{
+		b2SensorEvent* event = m_sensorEvents + m_sensorEventCount++;
+		event->sensorFixture = fixtureB;
+		event->visitorFixture = fixtureA;
+		event->visitorBody = fixtureA->GetBody();
+		event->begin = begin;
+	}
+}
+
+int32 b2ContactManager::GetBatch(const b2Contact* c)
+{
+	return c->m_fixtureA->GetType() * b2Shape::e_typeCount + c->m_fixtureB->GetType();
+}
+
+void b2ContactManager::InsertContact(b2Contact* c)
+{
+	if (m_slotCount == m_contactCapacity)
+	{
+		// m_contactCount does not include the new contact yet.
+		if (m_contactCount < m_contactCapacity)
+		{
+			Compact();
+		}
+		else
+		{
+			Reserve(b2Max(64, 2 * m_contactCapacity));
+		}
+	}
+
+	// The contact joins its batch in the next Collide.
+	m_contacts[m_slotCount] = c;
+	c->m_managerIndex = m_slotCount;
+	++m_slotCount;
+}
+
+void b2ContactManager::RemoveContact(b2Contact* c)
+{
+	b2Assert(0 <= c->m_managerIndex && c->m_managerIndex < m_slotCount);
+	b2Assert(m_contacts[c->m_managerIndex] == c);
+	m_contacts[c->m_managerIndex] = NULL;
+	c->m_managerIndex = -1;
+}
+
+void b2ContactManager::Compact()
+{
+	int32 count = 0;
+	for (int32 batch = 0; batch < b2_contactBatchCount; ++batch)
+	{
+		int32 begin = m_batchStart[batch];
+		int32 end = m_batchStart[batch + 1];
+		m_batchStart[batch] = count;
+
+		for (int32 i = begin; i < end; ++i)
+		{
+			b2Contact* c = m_contacts[i];
+			if (c != NULL)
+			{
+				m_contacts[count] = c;
+				c->m_managerIndex = count;
+				++count;
+			}
+		}
+	}
+
+	int32 newBegin = m_batchStart[b2_contactBatchCount];
+	m_batchStart[b2_contactBatchCount] = count;
+
+	for (int32 i = newBegin; i < m_slotCount; ++i)
+	{
+		b2Contact* c = m_contacts[i];
+		if (c != NULL)
+		{
+			m_contacts[count] = c;
+			c->m_managerIndex = count;
+			++count;
+		}
+	}
+
+	m_slotCount = count;
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -46,6 +257,11 @@ void b2ContactManager::Destroy(b2Contact* c)
 		m_contactListener->EndContact(c);
 	}
 
+	if (c->IsTouching() && (fixtureA->IsSensor() || fixtureB->IsSensor()))
+	{
+		AddSensorEvents(c, false);
+	}
+
 	// Remove from the world.
 	if (c->m_prev)
 	{
@@ -94,6 +310,9 @@ void b2ContactManager::Destroy(b2Contact* c)
 		bodyB->m_contactList = c->m_nodeB.next;
 	}
 
+	m_pairTable.Remove(c->m_proxyIdA, c->m_proxyIdB);
+	RemoveContact(c);
+
 	// Call the factory.
 	b2Contact::Destroy(c, m_allocator);
 	--m_contactCount;
@@ -104,73 +323,160 @@ void b2ContactManager::Destroy(b2Contact* c)
 // contact list.
 void b2ContactManager::Collide()
 {
-	// Update awake contacts.
-	b2Contact* c = m_contactList;
-	while (c)
-	{
-		b2Fixture* fixtureA = c->GetFixtureA();
-		b2Fixture* fixtureB = c->GetFixtureB();
-		int32 indexA = c->GetChildIndexA();
-		int32 indexB = c->GetChildIndexB();
-		b2Body* bodyA = fixtureA->GetBody();
-		b2Body* bodyB = fixtureB->GetBody();
-		 
-		// Is this contact flagged for filtering?
-		if (c->m_flags & b2Contact::e_filterFlag)
+	B2_PROFILE_SCOPE("b2ContactManager::Collide");
+
+	bool newContacts = m_batchStart[b2_contactBatchCount] < m_slotCount;
+
+	// Without new contacts or NULL slots the contacts are updated in place.
+	// Otherwise the contacts that are kept go to the other buffer in the
+	// same order, followed by the new contacts of their batch.
+	m_compacting = newContacts || m_contactCount < m_slotCount;
+	if (m_compacting == false)
+	{
+		for (int32 batch = 0; batch < b2_contactBatchCount; ++batch)
 		{
-			// Should these bodies collide?
-			if (bodyB->ShouldCollide(bodyA) == false)
+			if (m_batchStart[batch] < m_batchStart[batch + 1])
 			{
-				b2Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
-				continue;
+				b2CollideFcn collideFcn = s_collideFcns[batch];
+				b2Assert(collideFcn != NULL);
+				(this->*collideFcn)(batch);
 			}
+		}
+		return;
+	}
 
-			// Check user filtering.
-			if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
-			{
-				b2Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
-				continue;
-			}
+	int32 batchStart[b2_contactBatchCount + 1];
+	m_collideCount = 0;
+	for (int32 batch = 0; batch < b2_contactBatchCount; ++batch)
+	{
+		batchStart[batch] = m_collideCount;
 
-			// Clear the filtering flag.
-			c->m_flags &= ~b2Contact::e_filterFlag;
+		b2CollideFcn collideFcn = s_collideFcns[batch];
+		if (m_batchStart[batch] < m_batchStart[batch + 1] || (newContacts && collideFcn != NULL))
+		{
+			b2Assert(collideFcn != NULL);
+			(this->*collideFcn)(batch);
 		}
+	}
+	batchStart[b2_contactBatchCount] = m_collideCount;
 
-		bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
-		bool activeB = bodyB->IsAwake() && bodyB->m_type != b2_staticBody;
+	b2Swap(m_contacts, m_collideContacts);
+	m_slotCount = m_collideCount;
+	for (int32 i = 0; i <= b2_contactBatchCount; ++i)
+	{
+		m_batchStart[i] = batchStart[i];
+	}
+}
+
+template <int32 typeA, int32 typeB>
+void b2ContactManager::CollideBatch(int32 batch)
+{
+	int32 begin = m_batchStart[batch];
+	int32 end = m_batchStart[batch + 1];
 
-		// At least one body must be awake and it must be dynamic or kinematic.
-		if (activeA == false && activeB == false)
+	if (m_compacting == false)
+	{
+		// A destroyed contact leaves a NULL slot.
+		for (int32 i = begin; i < end; ++i)
 		{
-			c = c->GetNext();
-			continue;
+			CollideContact<typeA, typeB>(m_contacts[i]);
 		}
+		return;
+	}
 
-		int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
-		int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
-		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+	for (int32 i = begin; i < end; ++i)
+	{
+		b2Contact* c = m_contacts[i];
+		if (c != NULL && CollideContact<typeA, typeB>(c))
+		{
+			m_collideContacts[m_collideCount] = c;
+			c->m_managerIndex = m_collideCount;
+			++m_collideCount;
+		}
+	}
 
-		// Here we destroy contacts that cease to overlap in the broad-phase.
-		if (overlap == false)
+	begin = m_batchStart[b2_contactBatchCount];
+	end = m_slotCount;
+	for (int32 i = begin; i < end; ++i)
+	{
+		b2Contact* c = m_contacts[i];
+		if (c != NULL && GetBatch(c) == batch && CollideContact<typeA, typeB>(c))
 		{
-			b2Contact* cNuke = c;
-			c = cNuke->GetNext();
-			Destroy(cNuke);
-			continue;
+			m_collideContacts[m_collideCount] = c;
+			c->m_managerIndex = m_collideCount;
+			++m_collideCount;
 		}
+	}
+}
+
+// All contacts of the batch have the same shape types, so the collision
+// function is chosen at compile time instead of through the vtable.
+// Returns false if the contact was destroyed.
+template <int32 typeA, int32 typeB>
+bool b2ContactManager::CollideContact(b2Contact* c)
+{
+	b2Fixture* fixtureA = c->m_fixtureA;
+	b2Fixture* fixtureB = c->m_fixtureB;
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+	 
+	// Is this contact flagged for filtering?
+	if (c->m_flags & b2Contact::e_filterFlag)
+	{
+		// Should these bodies collide?
+		if (bodyB->ShouldCollide(bodyA) == false)
+		{
+			Destroy(c);
+			return false;
+		}
+
+		// Check user filtering.
+		if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+		{
+			Destroy(c);
+			return false;
+		}
+
+		// Clear the filtering flag.
+		c->m_flags &= ~b2Contact::e_filterFlag;
+	}
+
+	bool activeA = bodyA->IsAwake() && bodyA->m_type != b2_staticBody;
+	bool activeB = bodyB->IsAwake() && bodyB->m_type != b2_staticBody;
+
+	// At least one body must be awake and it must be dynamic or kinematic.
+	if (activeA == false && activeB == false)
+	{
+		return true;
+	}
+
+	int32 proxyIdA = fixtureA->m_proxies[c->m_indexA].proxyId;
+	int32 proxyIdB = fixtureB->m_proxies[c->m_indexB].proxyId;
+	bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+
+	// Here we destroy contacts that cease to overlap in the broad-phase.
+	if (overlap == false)
+	{
+		Destroy(c);
+		return false;
+	}
 
-		// The contact persists.
-		c->Update(m_contactListener);
-		c = c->GetNext();
+	// The contact persists.
+	b2Manifold oldManifold = c->m_manifold;
+	if (fixtureA->IsSensor() == false && fixtureB->IsSensor() == false)
+	{
+		b2ContactTraits<typeA, typeB>::Collide(&c->m_manifold,
+			fixtureA->GetShape(), c->m_indexA, bodyA->GetTransform(),
+			fixtureB->GetShape(), c->m_indexB, bodyB->GetTransform(), &c->m_satCache);
 	}
+
+	c->Update(m_contactListener, oldManifold);
+	return true;
 }
 
 void b2ContactManager::FindNewContacts()
 {
+	B2_PROFILE_SCOPE("b2ContactManager::FindNewContacts");
 	m_broadPhase.UpdatePairs(this);
 }
 
@@ -194,33 +500,10 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 		return;
 	}
 
-	// TODO_ERIN use a hash table to remove a potential bottleneck when both
-	// bodies have a lot of contacts.
 	// Does a contact already exist?
-	b2ContactEdge* edge = bodyB->GetContactList();
-	while (edge)
+	if (m_pairTable.Find(proxyA->proxyId, proxyB->proxyId) != NULL)
 	{
-		if (edge->other == bodyA)
-		{
-			b2Fixture* fA = edge->contact->GetFixtureA();
-			b2Fixture* fB = edge->contact->GetFixtureB();
-			int32 iA = edge->contact->GetChildIndexA();
-			int32 iB = edge->contact->GetChildIndexB();
-
-			if (fA == fixtureA && fB == fixtureB && iA == indexA && iB == indexB)
-			{
-				// A contact already exists.
-				return;
-			}
-
-			if (fA == fixtureB && fB == fixtureA && iA == indexB && iB == indexA)
-			{
-				// A contact already exists.
-				return;
-			}
-		}
-
-		edge = edge->next;
+		return;
 	}
 
 	// Does a joint override collision? Is at least one body dynamic?
@@ -250,6 +533,11 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 	bodyA = fixtureA->GetBody();
 	bodyB = fixtureB->GetBody();
 
+	c->m_proxyIdA = proxyA->proxyId;
+	c->m_proxyIdB = proxyB->proxyId;
+	m_pairTable.Insert(c->m_proxyIdA, c->m_proxyIdB, c);
+	InsertContact(c);
+
 	// Insert into the world.
 	c->m_prev = NULL;
 	c->m_next = m_contactList;
@@ -20,17 +20,41 @@
 #define B2_CONTACT_MANAGER_H
 
 #include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Collision/Shapes/b2Shape.h>
+#include <Box2D/Dynamics/b2PairTable.h>
 
 class b2Contact;
+class b2Body;
+class b2Fixture;
 class b2ContactFilter;
 class b2ContactListener;
+class b2Allocator;
 class b2BlockAllocator;
 
+/// Contacts are grouped by the shape types of fixture A and fixture B.
+const int32 b2_contactBatchCount = b2Shape::e_typeCount * b2Shape::e_typeCount;
+
+/// A sensor fixture began or stopped overlapping another fixture. An end
+/// event may outlive the fixtures and the visitor body when it was recorded
+/// because one of them was destroyed. The pointers then only identify them
+/// and must not be dereferenced.
+struct b2SensorEvent
+{
+	b2Fixture* sensorFixture;	///< the sensor
+	b2Fixture* visitorFixture;	///< the fixture that entered or left the sensor
+	b2Body* visitorBody;		///< the body of the visitor fixture
+	bool begin;					///< true when the overlap began, false when it ended
+};
+
 // Delegate of b2World.
 class b2ContactManager
 {
 public:
-	b2ContactManager();
+	b2ContactManager(b2Allocator* allocator);
+	~b2ContactManager();
+
+	// Make room for the given number of contacts.
+	void Reserve(int32 contactCount);
 
 	// Broad-phase callback.
 	void AddPair(void* proxyUserDataA, void* proxyUserDataB);
@@ -40,6 +64,13 @@ public:
 	void Destroy(b2Contact* c);
 
 	void Collide();
+
+	// Get the batch of a contact from the shape types of its fixtures.
+	static int32 GetBatch(const b2Contact* c);
+
+	// Record the begin or end of a sensor contact's overlap, once for each
+	// sensor fixture of the contact.
+	void AddSensorEvents(b2Contact* c, bool begin);
             
 	b2BroadPhase m_broadPhase;
 	b2Contact* m_contactList;
@@ -47,6 +78,52 @@ public:
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
 	b2BlockAllocator* m_allocator;
+
+	// Existing contacts by proxy pair.
+	b2PairTable m_pairTable;
+
+	// All contacts, batch after batch, followed by the contacts added since
+	// the last Collide. Batch i occupies [m_batchStart[i], m_batchStart[i + 1])
+	// and the new contacts occupy [m_batchStart[b2_contactBatchCount], m_slotCount).
+	// Destroyed contacts leave NULL slots. When there are new contacts or NULL
+	// slots, Collide copies the contacts it keeps to m_collideContacts and
+	// swaps the buffers. Each batch stays in the order its contacts were
+	// created, which follows the broad-phase pair order and keeps neighboring
+	// contacts close in memory.
+	b2Contact** m_contacts;
+	b2Contact** m_collideContacts;
+	int32 m_contactCapacity;
+	int32 m_slotCount;
+	int32 m_batchStart[b2_contactBatchCount + 1];
+
+	// Sensor overlaps that began or ended since the owner last cleared them,
+	// in the order they happened. Only recorded when m_sensorEventsEnabled
+	// is set. Kept apart from the contact listener so sensor consumers do not
+	// need a virtual call per contact.
+	b2SensorEvent* m_sensorEvents;
+	int32 m_sensorEventCount;
+	int32 m_sensorEventCapacity;
+	bool m_sensorEventsEnabled;
+
+private:
+
+	template <int32 typeA, int32 typeB>
+	void CollideBatch(int32 batch);
+
+	template <int32 typeA, int32 typeB>
+	bool CollideContact(b2Contact* c);
+
+	void InsertContact(b2Contact* c);
+	void RemoveContact(b2Contact* c);
+
+	// Squeeze out the NULL slots without changing the order.
+	void Compact();
+
+	void ReserveSensorEvents(int32 eventCount);
+
+	int32 m_collideCount;
+	bool m_compacting;
+	b2Allocator* m_heapAllocator;
 };
 
 #endif
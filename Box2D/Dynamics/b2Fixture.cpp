@@ -23,6 +23,7 @@
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2HeightfieldShape.h>
 #include <Box2D/Collision/b2BroadPhase.h>
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Common/b2BlockAllocator.h>
@@ -32,6 +33,8 @@ b2Fixture::b2Fixture()
 	m_userData = NULL;
 	m_body = NULL;
 	m_next = NULL;
+	m_handle.index = 0;
+	m_handle.generation = 0;
 	m_proxies = NULL;
 	m_proxyCount = 0;
 	m_shape = NULL;
@@ -111,6 +114,14 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 		}
 		break;
 
+	case b2Shape::e_heightfield:
+		{
+			b2HeightfieldShape* s = (b2HeightfieldShape*)m_shape;
+			s->~b2HeightfieldShape();
+			allocator->Free(s, sizeof(b2HeightfieldShape));
+		}
+		break;
+
 	default:
 		b2Assert(false);
 		break;
@@ -223,6 +234,34 @@ void b2Fixture::SetSensor(bool sensor)
 	{
 		m_body->SetAwake(true);
 		m_isSensor = sensor;
+
+		// Touching contacts of this fixture start or stop joining islands.
+		b2IslandManager* islandManager = &m_body->GetWorld()->m_islandManager;
+		for (b2ContactEdge* edge = m_body->GetContactList(); edge; edge = edge->next)
+		{
+			b2Contact* contact = edge->contact;
+			b2Fixture* fixtureA = contact->GetFixtureA();
+			b2Fixture* fixtureB = contact->GetFixtureB();
+			if ((fixtureA != this && fixtureB != this) || contact->IsTouching() == false)
+			{
+				continue;
+			}
+
+			b2Fixture* other = fixtureA == this ? fixtureB : fixtureA;
+			if (other->IsSensor())
+			{
+				continue;
+			}
+
+			if (sensor)
+			{
+				islandManager->Unlink(m_body, edge->other);
+			}
+			else
+			{
+				islandManager->Link(m_body, edge->other);
+			}
+		}
 	}
 }
 
@@ -292,6 +331,23 @@ void b2Fixture::Dump(int32 bodyIndex)
 		}
 		break;
 
+	case b2Shape::e_heightfield:
+		{
+			b2HeightfieldShape* s = (b2HeightfieldShape*)m_shape;
+			b2Log("    b2HeightfieldShape shape;\n");
+			b2Log("    float32 hs[%d];\n", s->m_count);
+			for (int32 i = 0; i < s->m_count; ++i)
+			{
+				b2Log("    hs[%d] = %.15lef;\n", i, s->m_heights[i]);
+			}
+			b2Log("    shape.Create(hs, %d, %.15lef, %.15lef);\n", s->m_count, s->m_originX, s->m_spacing);
+			b2Log("    shape.m_prevHeight = %.15lef;\n", s->m_prevHeight);
+			b2Log("    shape.m_nextHeight = %.15lef;\n", s->m_nextHeight);
+			b2Log("    shape.m_hasPrevHeight = bool(%d);\n", s->m_hasPrevHeight);
+			b2Log("    shape.m_hasNextHeight = bool(%d);\n", s->m_hasNextHeight);
+		}
+		break;
+
 	default:
 		return;
 	}
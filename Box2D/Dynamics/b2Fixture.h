@@ -28,29 +28,6 @@ class b2Body;
 class b2BroadPhase;
 class b2Fixture;
 
-/// This holds contact filtering data.
-struct b2Filter
-{
-	b2Filter()
-	{
-		categoryBits = 0x0001;
-		maskBits = 0xFFFF;
-		groupIndex = 0;
-	}
-
-	/// The collision category bits. Normally you would just set one bit.
-	uint16 categoryBits;
-
-	/// The collision mask bits. This states the categories that this
-	/// shape would accept for collision.
-	uint16 maskBits;
-
-	/// Collision groups allow a certain group of objects to never collide (negative)
-	/// or always collide (positive). Zero means no collision group. Non-zero group
-	/// filtering always wins against the mask bits.
-	int16 groupIndex;
-};
-
 /// A fixture definition is used to create a fixture. This class defines an
 /// abstract fixture definition. You can reuse fixture definitions safely.
 struct b2FixtureDef
@@ -140,6 +117,10 @@ public:
 	b2Body* GetBody();
 	const b2Body* GetBody() const;
 
+	/// Get the handle of this fixture. Use b2World::GetFixture to look it up,
+	/// which returns NULL once the fixture is destroyed.
+	b2Handle GetHandle() const;
+
 	/// Get the next fixture in the parent body's fixture list.
 	/// @return the next shape.
 	b2Fixture* GetNext();
@@ -219,6 +200,7 @@ protected:
 
 	b2Fixture* m_next;
 	b2Body* m_body;
+	b2Handle m_handle;
 
 	b2Shape* m_shape;
 
@@ -280,6 +262,11 @@ inline const b2Body* b2Fixture::GetBody() const
 	return m_body;
 }
 
+inline b2Handle b2Fixture::GetHandle() const
+{
+	return m_handle;
+}
+
 inline b2Fixture* b2Fixture::GetNext()
 {
 	return m_next;
@@ -28,9 +28,10 @@ class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
 struct b2ContactVelocityConstraint;
-struct b2Profile;
 
 /// This is an internal class.
+/// The island of a time of impact event. The discrete step solves its
+/// islands from the world's b2BodyStore.
 class b2Island
 {
 public:
@@ -45,8 +46,6 @@ public:
 		m_jointCount = 0;
 	}
 
-	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
-
 	void SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB);
 
 	void Add(b2Body* body)
@@ -0,0 +1,481 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2IslandManager.h>
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Dynamics/Contacts/b2Contact.h>
+#include <Box2D/Dynamics/Joints/b2Joint.h>
+#include <Box2D/Common/b2Allocator.h>
+#include <Box2D/Common/b2StackAllocator.h>
+#include <memory.h>
+
+b2IslandManager::b2IslandManager(b2Allocator* allocator)
+{
+	m_allocator = allocator;
+
+	m_islands = NULL;
+	m_islandCapacity = 0;
+	m_islandCount = 0;
+	m_freeList = b2_nullIsland;
+
+	m_awakeIslands = NULL;
+	m_awakeCount = 0;
+
+	m_linkCount = 0;
+}
+
+b2IslandManager::~b2IslandManager()
+{
+	m_allocator->Free(m_awakeIslands, m_islandCapacity * sizeof(int32), "b2IslandManager awake islands");
+	m_allocator->Free(m_islands, m_islandCapacity * sizeof(b2IslandNode), "b2IslandManager islands");
+}
+
+void b2IslandManager::Reserve(int32 islandCount)
+{
+	if (islandCount <= m_islandCapacity)
+	{
+		return;
+	}
+
+	b2IslandNode* oldIslands = m_islands;
+	int32* oldAwakeIslands = m_awakeIslands;
+	int32 oldCapacity = m_islandCapacity;
+
+	m_islandCapacity = islandCount;
+	m_islands = (b2IslandNode*)m_allocator->Allocate(m_islandCapacity * sizeof(b2IslandNode), "b2IslandManager islands");
+	m_awakeIslands = (int32*)m_allocator->Allocate(m_islandCapacity * sizeof(int32), "b2IslandManager awake islands");
+	if (oldCapacity > 0)
+	{
+		memcpy(m_islands, oldIslands, oldCapacity * sizeof(b2IslandNode));
+		memcpy(m_awakeIslands, oldAwakeIslands, m_awakeCount * sizeof(int32));
+	}
+	m_allocator->Free(oldAwakeIslands, oldCapacity * sizeof(int32), "b2IslandManager awake islands");
+	m_allocator->Free(oldIslands, oldCapacity * sizeof(b2IslandNode), "b2IslandManager islands");
+
+	// Put the new islands in front of the free list.
+	for (int32 i = oldCapacity; i < m_islandCapacity - 1; ++i)
+	{
+		m_islands[i].parent = i + 1;
+		m_islands[i].bodyList = NULL;
+	}
+	m_islands[m_islandCapacity - 1].parent = m_freeList;
+	m_islands[m_islandCapacity - 1].bodyList = NULL;
+	m_freeList = oldCapacity;
+}
+
+int32 b2IslandManager::AllocateIsland()
+{
+	if (m_freeList == b2_nullIsland)
+	{
+		Reserve(b2Max(16, 2 * m_islandCapacity));
+	}
+
+	int32 islandId = m_freeList;
+	b2IslandNode* island = m_islands + islandId;
+	m_freeList = island->parent;
+
+	island->bodyList = NULL;
+	island->bodyCount = 0;
+	island->parent = islandId;
+	island->awakeIndex = b2_nullIsland;
+	island->constraintRemoveCount = 0;
+	++m_islandCount;
+	return islandId;
+}
+
+void b2IslandManager::FreeIsland(int32 islandId)
+{
+	b2Assert(0 <= islandId && islandId < m_islandCapacity);
+	b2Assert(m_islands[islandId].awakeIndex == b2_nullIsland);
+	b2IslandNode* island = m_islands + islandId;
+	island->bodyList = NULL;
+	island->parent = m_freeList;
+	m_freeList = islandId;
+	--m_islandCount;
+}
+
+int32 b2IslandManager::Find(int32 islandId)
+{
+	// Path halving.
+	while (m_islands[islandId].parent != islandId)
+	{
+		int32 parent = m_islands[islandId].parent;
+		m_islands[islandId].parent = m_islands[parent].parent;
+		islandId = parent;
+	}
+
+	return islandId;
+}
+
+void b2IslandManager::AddAwake(int32 islandId)
+{
+	b2Assert(m_islands[islandId].awakeIndex == b2_nullIsland);
+	m_islands[islandId].awakeIndex = m_awakeCount;
+	m_awakeIslands[m_awakeCount] = islandId;
+	++m_awakeCount;
+}
+
+void b2IslandManager::RemoveAwake(int32 islandId)
+{
+	int32 index = m_islands[islandId].awakeIndex;
+	b2Assert(0 <= index && index < m_awakeCount);
+
+	// Swap the last awake island into the gap.
+	int32 lastId = m_awakeIslands[m_awakeCount - 1];
+	m_awakeIslands[index] = lastId;
+	m_islands[lastId].awakeIndex = index;
+	--m_awakeCount;
+
+	m_islands[islandId].awakeIndex = b2_nullIsland;
+}
+
+void b2IslandManager::AddBody(b2Body* body)
+{
+	b2Assert(body->m_islandId == b2_nullIsland);
+	b2Assert(body->m_type != b2_staticBody);
+
+	int32 islandId = AllocateIsland();
+	b2IslandNode* island = m_islands + islandId;
+	island->bodyList = body;
+	island->bodyCount = 1;
+
+	body->m_islandId = islandId;
+	body->m_islandPrev = NULL;
+	body->m_islandNext = NULL;
+
+	if (body->m_flags & b2Body::e_awakeFlag)
+	{
+		AddAwake(islandId);
+	}
+}
+
+void b2IslandManager::RemoveBody(b2Body* body)
+{
+	if (body->m_islandId == b2_nullIsland)
+	{
+		return;
+	}
+
+	// An island may not be freed while other islands point at it.
+	Merge();
+
+	int32 islandId = body->m_islandId;
+	b2IslandNode* island = m_islands + islandId;
+
+	if (body->m_islandPrev)
+	{
+		body->m_islandPrev->m_islandNext = body->m_islandNext;
+	}
+
+	if (body->m_islandNext)
+	{
+		body->m_islandNext->m_islandPrev = body->m_islandPrev;
+	}
+
+	if (body == island->bodyList)
+	{
+		island->bodyList = body->m_islandNext;
+	}
+
+	body->m_islandId = b2_nullIsland;
+	body->m_islandPrev = NULL;
+	body->m_islandNext = NULL;
+
+	--island->bodyCount;
+	if (island->bodyCount == 0)
+	{
+		if (island->awakeIndex != b2_nullIsland)
+		{
+			RemoveAwake(islandId);
+		}
+
+		FreeIsland(islandId);
+	}
+	else
+	{
+		// The body may have held the island together.
+		++island->constraintRemoveCount;
+	}
+}
+
+void b2IslandManager::Link(b2Body* bodyA, b2Body* bodyB)
+{
+	int32 islandA = bodyA->m_islandId;
+	int32 islandB = bodyB->m_islandId;
+	if (islandA == b2_nullIsland || islandB == b2_nullIsland)
+	{
+		return;
+	}
+
+	// Linked islands are awake until they are merged.
+	Wake(islandA);
+	Wake(islandB);
+
+	int32 rootA = Find(islandA);
+	int32 rootB = Find(islandB);
+	if (rootA == rootB)
+	{
+		return;
+	}
+
+	// The smaller island is moved into the larger one.
+	if (m_islands[rootA].bodyCount < m_islands[rootB].bodyCount)
+	{
+		b2Swap(rootA, rootB);
+	}
+
+	m_islands[rootB].parent = rootA;
+	++m_linkCount;
+}
+
+void b2IslandManager::Unlink(b2Body* bodyA, b2Body* bodyB)
+{
+	int32 islandId = bodyA->m_islandId != b2_nullIsland ? bodyA->m_islandId : bodyB->m_islandId;
+	if (islandId == b2_nullIsland)
+	{
+		return;
+	}
+
+	++m_islands[Find(islandId)].constraintRemoveCount;
+}
+
+void b2IslandManager::Merge()
+{
+	if (m_linkCount == 0)
+	{
+		return;
+	}
+
+	// Linked islands are awake. Point each of them straight at its root
+	// before any island is freed.
+	for (int32 i = 0; i < m_awakeCount; ++i)
+	{
+		int32 islandId = m_awakeIslands[i];
+		m_islands[islandId].parent = Find(islandId);
+	}
+
+	// Walk backwards so the islands swapped in by RemoveAwake are already done.
+	for (int32 i = m_awakeCount - 1; i >= 0; --i)
+	{
+		int32 islandId = m_awakeIslands[i];
+		b2IslandNode* island = m_islands + islandId;
+		int32 rootId = island->parent;
+		if (rootId == islandId)
+		{
+			continue;
+		}
+
+		b2IslandNode* root = m_islands + rootId;
+		b2Assert(root->awakeIndex != b2_nullIsland);
+
+		b2Body* last = NULL;
+		for (b2Body* b = island->bodyList; b; b = b->m_islandNext)
+		{
+			b->m_islandId = rootId;
+			last = b;
+		}
+
+		if (last)
+		{
+			last->m_islandNext = root->bodyList;
+			if (root->bodyList)
+			{
+				root->bodyList->m_islandPrev = last;
+			}
+			root->bodyList = island->bodyList;
+		}
+
+		root->bodyCount += island->bodyCount;
+		root->constraintRemoveCount += island->constraintRemoveCount;
+
+		RemoveAwake(islandId);
+		FreeIsland(islandId);
+	}
+
+	m_linkCount = 0;
+}
+
+void b2IslandManager::Wake(int32 islandId)
+{
+	islandId = Find(islandId);
+	b2IslandNode* island = m_islands + islandId;
+	if (island->awakeIndex != b2_nullIsland)
+	{
+		return;
+	}
+
+	AddAwake(islandId);
+
+	for (b2Body* b = island->bodyList; b; b = b->m_islandNext)
+	{
+		b->m_flags |= b2Body::e_awakeFlag;
+		b->m_sleepTime = 0.0f;
+	}
+}
+
+void b2IslandManager::Sleep(int32 islandId)
+{
+	// Roots survive the merge.
+	islandId = Find(islandId);
+	Merge();
+
+	b2IslandNode* island = m_islands + islandId;
+	if (island->awakeIndex != b2_nullIsland)
+	{
+		RemoveAwake(islandId);
+	}
+
+	for (b2Body* b = island->bodyList; b; b = b->m_islandNext)
+	{
+		b->m_flags &= ~b2Body::e_awakeFlag;
+		b->m_sleepTime = 0.0f;
+		b->m_linearVelocity.SetZero();
+		b->m_angularVelocity = 0.0f;
+		b->m_force.SetZero();
+		b->m_torque = 0.0f;
+	}
+}
+
+void b2IslandManager::UpdateSleep(int32 islandId, float32 minSleepTime, float32 maxSleepTime,
+								  bool positionSolved, b2StackAllocator* stackAllocator)
+{
+	b2IslandNode* island = m_islands + islandId;
+	if (minSleepTime >= b2_timeToSleep && positionSolved)
+	{
+		if (island->constraintRemoveCount > 0)
+		{
+			// The pieces can go to sleep on a later step.
+			Split(islandId, stackAllocator);
+		}
+		else
+		{
+			Sleep(islandId);
+		}
+		return;
+	}
+
+	// Some bodies rest while others keep the island awake. They may no
+	// longer be connected.
+	if (island->constraintRemoveCount > 0 && maxSleepTime >= b2_timeToSleep)
+	{
+		Split(islandId, stackAllocator);
+	}
+}
+
+void b2IslandManager::Split(int32 islandId, b2StackAllocator* stackAllocator)
+{
+	int32 bodyCount = m_islands[islandId].bodyCount;
+
+	b2Body** bodies = (b2Body**)stackAllocator->Allocate(bodyCount * sizeof(b2Body*));
+	b2Body** stack = (b2Body**)stackAllocator->Allocate(bodyCount * sizeof(b2Body*));
+
+	int32 count = 0;
+	for (b2Body* b = m_islands[islandId].bodyList; b; b = b->m_islandNext)
+	{
+		bodies[count++] = b;
+		b->m_flags &= ~b2Body::e_islandFlag;
+	}
+	b2Assert(count == bodyCount);
+
+	// The first piece keeps the island.
+	m_islands[islandId].bodyList = NULL;
+	m_islands[islandId].bodyCount = 0;
+	m_islands[islandId].constraintRemoveCount = 0;
+
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* seed = bodies[i];
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
+
+		int32 pieceId = islandId;
+		if (i > 0)
+		{
+			pieceId = AllocateIsland();
+			AddAwake(pieceId);
+		}
+
+		b2IslandNode* piece = m_islands + pieceId;
+
+		// Depth first search over the same edges that link islands.
+		int32 stackCount = 0;
+		stack[stackCount++] = seed;
+		seed->m_flags |= b2Body::e_islandFlag;
+
+		while (stackCount > 0)
+		{
+			b2Body* b = stack[--stackCount];
+
+			b->m_islandId = pieceId;
+			b->m_islandPrev = NULL;
+			b->m_islandNext = piece->bodyList;
+			if (piece->bodyList)
+			{
+				piece->bodyList->m_islandPrev = b;
+			}
+			piece->bodyList = b;
+			++piece->bodyCount;
+
+			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+			{
+				b2Contact* contact = ce->contact;
+				if (contact->IsTouching() == false ||
+					contact->GetFixtureA()->IsSensor() ||
+					contact->GetFixtureB()->IsSensor())
+				{
+					continue;
+				}
+
+				b2Body* other = ce->other;
+				if (other->m_type == b2_staticBody || (other->m_flags & b2Body::e_islandFlag))
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < bodyCount);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
+
+			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			{
+				b2Body* other = je->other;
+				if (other->m_type == b2_staticBody || other->IsActive() == false ||
+					(other->m_flags & b2Body::e_islandFlag))
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < bodyCount);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
+		}
+	}
+
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		bodies[i]->m_flags &= ~b2Body::e_islandFlag;
+	}
+
+	stackAllocator->Free(stack);
+	stackAllocator->Free(bodies);
+}
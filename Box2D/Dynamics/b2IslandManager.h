@@ -0,0 +1,120 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_ISLAND_MANAGER_H
+#define B2_ISLAND_MANAGER_H
+
+#include <Box2D/Common/b2Settings.h>
+
+#define b2_nullIsland (-1)
+
+class b2Allocator;
+class b2Body;
+class b2StackAllocator;
+
+/// A persistent island. Non-static bodies belong to exactly one island.
+struct b2IslandNode
+{
+	/// The bodies, linked through b2Body::m_islandNext.
+	b2Body* bodyList;
+	int32 bodyCount;
+
+	/// Union-find parent. Also the free list.
+	int32 parent;
+
+	/// Index in the awake array, or b2_nullIsland while asleep.
+	int32 awakeIndex;
+
+	/// Contacts and joints removed since the island was built. The island
+	/// may have fallen apart and is split before it goes to sleep.
+	int32 constraintRemoveCount;
+};
+
+/// This is an internal class.
+/// Islands that persist across time steps. Bodies joined by a touching
+/// contact or a joint are linked with union-find and the islands are merged
+/// at the start of the next step. Removed constraints are only counted; an
+/// island is split when it is about to fall asleep. Sleeping islands are not
+/// visited by the solver and wake up as a whole.
+class b2IslandManager
+{
+public:
+	b2IslandManager(b2Allocator* allocator);
+	~b2IslandManager();
+
+	/// Make room for the given number of islands.
+	void Reserve(int32 islandCount);
+
+	/// Put a non-static, active body in its own island. The island is awake
+	/// if the body is.
+	void AddBody(b2Body* body);
+
+	/// Take a body out of its island.
+	void RemoveBody(b2Body* body);
+
+	/// Record a touching contact or a joint between two bodies. Static
+	/// bodies do not join islands. Both islands are woken.
+	void Link(b2Body* bodyA, b2Body* bodyB);
+
+	/// Record the removal of a touching contact or a joint.
+	void Unlink(b2Body* bodyA, b2Body* bodyB);
+
+	/// Merge the islands linked since the last call.
+	void Merge();
+
+	/// Wake the island and all its bodies.
+	void Wake(int32 islandId);
+
+	/// Put the island to sleep. This clears the velocities and forces of its bodies.
+	void Sleep(int32 islandId);
+
+	/// Decide the sleep state of an awake island from the smallest and the
+	/// largest sleep time of its bodies. A resting island goes to sleep, or is
+	/// split first if constraints were removed from it. An island that rests
+	/// only in part is split too, the resting part may be free to sleep.
+	void UpdateSleep(int32 islandId, float32 minSleepTime, float32 maxSleepTime, bool positionSolved,
+					 b2StackAllocator* stackAllocator);
+
+	int32 GetAwakeCount() const { return m_awakeCount; }
+	int32 GetAwakeIsland(int32 index) const { return m_awakeIslands[index]; }
+	const b2IslandNode* GetIsland(int32 islandId) const { return m_islands + islandId; }
+	int32 GetIslandCount() const { return m_islandCount; }
+
+private:
+
+	int32 AllocateIsland();
+	void FreeIsland(int32 islandId);
+	int32 Find(int32 islandId);
+	void AddAwake(int32 islandId);
+	void RemoveAwake(int32 islandId);
+	void Split(int32 islandId, b2StackAllocator* stackAllocator);
+
+	b2Allocator* m_allocator;
+
+	b2IslandNode* m_islands;
+	int32 m_islandCapacity;
+	int32 m_islandCount;
+	int32 m_freeList;
+
+	int32* m_awakeIslands;
+	int32 m_awakeCount;
+
+	int32 m_linkCount;
+};
+
+#endif
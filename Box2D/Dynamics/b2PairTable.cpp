@@ -0,0 +1,178 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Dynamics/b2PairTable.h>
+#include <Box2D/Collision/b2BroadPhase.h>
+#include <Box2D/Common/b2Allocator.h>
+
+b2PairTable::b2PairTable(b2Allocator* allocator)
+{
+	m_allocator = allocator;
+	m_entries = NULL;
+	m_capacity = 0;
+	m_count = 0;
+}
+
+b2PairTable::~b2PairTable()
+{
+	m_allocator->Free(m_entries, m_capacity * sizeof(b2PairEntry), "b2PairTable entries");
+}
+
+void b2PairTable::Reserve(int32 pairCount)
+{
+	// Keep the load factor at or below one half.
+	int32 capacity = 16;
+	while (capacity < 2 * pairCount)
+	{
+		capacity *= 2;
+	}
+
+	if (capacity <= m_capacity)
+	{
+		return;
+	}
+
+	b2PairEntry* oldEntries = m_entries;
+	int32 oldCapacity = m_capacity;
+
+	m_entries = (b2PairEntry*)m_allocator->Allocate(capacity * sizeof(b2PairEntry), "b2PairTable entries");
+	m_capacity = capacity;
+	m_count = 0;
+
+	for (int32 i = 0; i < capacity; ++i)
+	{
+		m_entries[i].proxyIdA = b2BroadPhase::e_nullProxy;
+	}
+
+	for (int32 i = 0; i < oldCapacity; ++i)
+	{
+		const b2PairEntry* entry = oldEntries + i;
+		if (entry->proxyIdA != b2BroadPhase::e_nullProxy)
+		{
+			Insert(entry->proxyIdA, entry->proxyIdB, entry->contact);
+		}
+	}
+
+	m_allocator->Free(oldEntries, oldCapacity * sizeof(b2PairEntry), "b2PairTable entries");
+}
+
+int32 b2PairTable::GetHomeSlot(int32 proxyIdA, int32 proxyIdB) const
+{
+	// The entries store the smaller proxy id first.
+	uint32 h = uint32(proxyIdA) * 0x9E3779B1u + uint32(proxyIdB);
+	h ^= h >> 16;
+	h *= 0x85EBCA6Bu;
+	h ^= h >> 13;
+	return int32(h & uint32(m_capacity - 1));
+}
+
+b2Contact* b2PairTable::Find(int32 proxyIdA, int32 proxyIdB) const
+{
+	if (m_count == 0)
+	{
+		return NULL;
+	}
+
+	if (proxyIdA > proxyIdB)
+	{
+		b2Swap(proxyIdA, proxyIdB);
+	}
+
+	int32 mask = m_capacity - 1;
+	int32 i = GetHomeSlot(proxyIdA, proxyIdB);
+	while (m_entries[i].proxyIdA != b2BroadPhase::e_nullProxy)
+	{
+		if (m_entries[i].proxyIdA == proxyIdA && m_entries[i].proxyIdB == proxyIdB)
+		{
+			return m_entries[i].contact;
+		}
+
+		i = (i + 1) & mask;
+	}
+
+	return NULL;
+}
+
+void b2PairTable::Insert(int32 proxyIdA, int32 proxyIdB, b2Contact* contact)
+{
+	b2Assert(proxyIdA != b2BroadPhase::e_nullProxy && proxyIdB != b2BroadPhase::e_nullProxy);
+	b2Assert(Find(proxyIdA, proxyIdB) == NULL);
+
+	if (2 * (m_count + 1) > m_capacity)
+	{
+		Reserve(2 * m_count + 1);
+	}
+
+	if (proxyIdA > proxyIdB)
+	{
+		b2Swap(proxyIdA, proxyIdB);
+	}
+
+	int32 mask = m_capacity - 1;
+	int32 i = GetHomeSlot(proxyIdA, proxyIdB);
+	while (m_entries[i].proxyIdA != b2BroadPhase::e_nullProxy)
+	{
+		i = (i + 1) & mask;
+	}
+
+	m_entries[i].proxyIdA = proxyIdA;
+	m_entries[i].proxyIdB = proxyIdB;
+	m_entries[i].contact = contact;
+	++m_count;
+}
+
+void b2PairTable::Remove(int32 proxyIdA, int32 proxyIdB)
+{
+	if (proxyIdA > proxyIdB)
+	{
+		b2Swap(proxyIdA, proxyIdB);
+	}
+
+	int32 mask = m_capacity - 1;
+	int32 i = GetHomeSlot(proxyIdA, proxyIdB);
+	while (m_entries[i].proxyIdA != proxyIdA || m_entries[i].proxyIdB != proxyIdB)
+	{
+		b2Assert(m_entries[i].proxyIdA != b2BroadPhase::e_nullProxy);
+		i = (i + 1) & mask;
+	}
+
+	// Shift back entries of the probe run that would no longer be reachable
+	// from their home slot through the hole.
+	int32 j = i;
+	for (;;)
+	{
+		j = (j + 1) & mask;
+		const b2PairEntry* entry = m_entries + j;
+		if (entry->proxyIdA == b2BroadPhase::e_nullProxy)
+		{
+			break;
+		}
+
+		// The entry can stay if its home slot lies cyclically in (i, j].
+		int32 home = GetHomeSlot(entry->proxyIdA, entry->proxyIdB);
+		bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+		if (stays == false)
+		{
+			m_entries[i] = *entry;
+			i = j;
+		}
+	}
+
+	m_entries[i].proxyIdA = b2BroadPhase::e_nullProxy;
+	--m_count;
+}
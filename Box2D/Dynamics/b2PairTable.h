@@ -0,0 +1,79 @@
+/*
+* Copyright (c) 2006-2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_PAIR_TABLE_H
+#define B2_PAIR_TABLE_H
+
+#include <Box2D/Common/b2Settings.h>
+
+class b2Allocator;
+class b2Contact;
+
+/// An entry in the pair table. Empty slots have proxyIdA == b2BroadPhase::e_nullProxy.
+struct b2PairEntry
+{
+	int32 proxyIdA;
+	int32 proxyIdB;
+	b2Contact* contact;
+};
+
+/// This is an internal class.
+/// Maps a pair of broad-phase proxies to their contact. Each fixture child
+/// has its own proxy, so the proxy pair identifies the fixtures and the
+/// child indices. The table uses open addressing with linear probing and
+/// removes entries by shifting back the rest of the probe run, so there
+/// are no tombstones.
+class b2PairTable
+{
+public:
+	b2PairTable(b2Allocator* allocator);
+	~b2PairTable();
+
+	/// Make room for the given number of pairs.
+	void Reserve(int32 pairCount);
+
+	/// Find the contact for a proxy pair. The order of the proxies does
+	/// not matter. Returns NULL if there is none.
+	b2Contact* Find(int32 proxyIdA, int32 proxyIdB) const;
+
+	/// Add a contact for a proxy pair that is not in the table.
+	void Insert(int32 proxyIdA, int32 proxyIdB, b2Contact* contact);
+
+	/// Remove the contact for a proxy pair that is in the table.
+	void Remove(int32 proxyIdA, int32 proxyIdB);
+
+	/// Get the number of pairs in the table.
+	int32 GetCount() const;
+
+private:
+
+	int32 GetHomeSlot(int32 proxyIdA, int32 proxyIdB) const;
+
+	b2Allocator* m_allocator;
+
+	b2PairEntry* m_entries;
+	int32 m_capacity;
+	int32 m_count;
+};
+
+inline int32 b2PairTable::GetCount() const
+{
+	return m_count;
+}
+
+#endif
@@ -21,6 +21,7 @@
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2Island.h>
 #include <Box2D/Dynamics/Joints/b2PulleyJoint.h>
+#include <Box2D/Dynamics/Controllers/b2Controller.h>
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/Contacts/b2ContactSolver.h>
 #include <Box2D/Collision/b2Collision.h>
@@ -28,22 +29,36 @@
 #include <Box2D/Collision/Shapes/b2CircleShape.h>
 #include <Box2D/Collision/Shapes/b2EdgeShape.h>
 #include <Box2D/Collision/Shapes/b2ChainShape.h>
+#include <Box2D/Collision/Shapes/b2HeightfieldShape.h>
 #include <Box2D/Collision/Shapes/b2PolygonShape.h>
 #include <Box2D/Collision/b2TimeOfImpact.h>
 #include <Box2D/Common/b2Draw.h>
+#include <Box2D/Common/b2GrowableStack.h>
 #include <Box2D/Common/b2Timer.h>
+#include <Box2D/Common/b2Profiler.h>
 #include <new>
 
-b2World::b2World(const b2Vec2& gravity)
+b2World::b2World(const b2Vec2& gravity, b2Allocator* allocator)
+	: m_allocator(allocator ? allocator : b2GetDefaultAllocator()),
+	m_countingAllocator(m_allocator),
+	m_blockAllocator(&m_countingAllocator),
+	m_stackAllocator(&m_countingAllocator),
+	m_bodyPool(&m_countingAllocator),
+	m_fixturePool(&m_countingAllocator),
+	m_bodyStore(&m_countingAllocator),
+	m_islandManager(&m_countingAllocator),
+	m_contactManager(&m_countingAllocator)
 {
 	m_destructionListener = NULL;
 	m_debugDraw = NULL;
 
 	m_bodyList = NULL;
 	m_jointList = NULL;
+	m_controllerList = NULL;
 
 	m_bodyCount = 0;
 	m_jointCount = 0;
+	m_controllerCount = 0;
 
 	m_warmStarting = true;
 	m_continuousPhysics = true;
@@ -61,11 +76,23 @@ b2World::b2World(const b2Vec2& gravity)
 	m_contactManager.m_allocator = &m_blockAllocator;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
+
+	m_perfCounters = NULL;
+	memset(&m_perfProfile, 0, sizeof(b2PerfProfile));
 }
 
 b2World::~b2World()
 {
-	// Some shapes allocate using b2Alloc.
+	// Controllers allocate their body arrays using the world allocator.
+	b2Controller* controller = m_controllerList;
+	while (controller)
+	{
+		b2Controller* controllerNext = controller->m_next;
+		b2Controller::Destroy(controller, &m_blockAllocator);
+		controller = controllerNext;
+	}
+
+	// Some shapes allocate using the world allocator.
 	b2Body* b = m_bodyList;
 	while (b)
 	{
@@ -84,6 +111,34 @@ b2World::~b2World()
 	}
 }
 
+void b2World::Reserve(int32 bodyCount, int32 jointCount, int32 contactCount, int32 proxyCount)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_bodyPool.Reserve(bodyCount);
+	m_fixturePool.Reserve(proxyCount);
+
+	// Contacts come from the block allocator. The contact types add no
+	// members to b2Contact.
+	m_blockAllocator.Reserve(sizeof(b2Contact), contactCount - m_contactManager.m_contactCount);
+
+	// A contact can be reported by both of its proxies.
+	m_contactManager.m_broadPhase.Reserve(proxyCount, 2 * contactCount);
+	m_contactManager.Reserve(contactCount);
+
+	m_bodyStore.Reserve(bodyCount, contactCount, jointCount);
+	m_islandManager.Reserve(bodyCount);
+
+	// The contact solver and island splitting use the stack.
+	// The TOI island is small enough for the inline stack.
+	int32 stackSize = b2Max(2 * bodyCount * (int32)sizeof(b2Body*), b2ContactSolver::GetStackSize(contactCount));
+	m_stackAllocator.Reserve(stackSize);
+}
+
 void b2World::SetDestructionListener(b2DestructionListener* listener)
 {
 	m_destructionListener = listener;
@@ -99,6 +154,17 @@ void b2World::SetContactListener(b2ContactListener* listener)
 	m_contactManager.m_contactListener = listener;
 }
 
+void b2World::SetSensorEventsEnabled(bool flag)
+{
+	m_contactManager.m_sensorEventsEnabled = flag;
+	m_contactManager.m_sensorEventCount = 0;
+	if (flag)
+	{
+		// Size the buffer like Reserve would have.
+		m_contactManager.Reserve(m_contactManager.m_contactCapacity);
+	}
+}
+
 void b2World::SetDebugDraw(b2Draw* debugDraw)
 {
 	m_debugDraw = debugDraw;
@@ -112,8 +178,10 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 		return NULL;
 	}
 
-	void* mem = m_blockAllocator.Allocate(sizeof(b2Body));
+	b2Handle handle;
+	void* mem = m_bodyPool.Allocate(&handle);
 	b2Body* b = new (mem) b2Body(def, this);
+	b->m_handle = handle;
 
 	// Add to world doubly linked list.
 	b->m_prev = NULL;
@@ -125,6 +193,11 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 	m_bodyList = b;
 	++m_bodyCount;
 
+	if (b->m_type != b2_staticBody && (b->m_flags & b2Body::e_activeFlag))
+	{
+		m_islandManager.AddBody(b);
+	}
+
 	return b;
 }
 
@@ -165,6 +238,12 @@ void b2World::DestroyBody(b2Body* b)
 	}
 	b->m_contactList = NULL;
 
+	// Detach from the controllers.
+	while (b->m_controllerList)
+	{
+		b->m_controllerList->controller->RemoveBody(b);
+	}
+
 	// Delete the attached fixtures. This destroys broad-phase proxies.
 	b2Fixture* f = b->m_fixtureList;
 	while (f)
@@ -179,8 +258,9 @@ void b2World::DestroyBody(b2Body* b)
 
 		f0->DestroyProxies(&m_contactManager.m_broadPhase);
 		f0->Destroy(&m_blockAllocator);
+		b2Handle fixtureHandle = f0->m_handle;
 		f0->~b2Fixture();
-		m_blockAllocator.Free(f0, sizeof(b2Fixture));
+		m_fixturePool.Free(fixtureHandle);
 
 		b->m_fixtureList = f;
 		b->m_fixtureCount -= 1;
@@ -188,6 +268,8 @@ void b2World::DestroyBody(b2Body* b)
 	b->m_fixtureList = NULL;
 	b->m_fixtureCount = 0;
 
+	m_islandManager.RemoveBody(b);
+
 	// Remove world body list.
 	if (b->m_prev)
 	{
@@ -205,8 +287,9 @@ void b2World::DestroyBody(b2Body* b)
 	}
 
 	--m_bodyCount;
+	b2Handle handle = b->m_handle;
 	b->~b2Body();
-	m_blockAllocator.Free(b, sizeof(b2Body));
+	m_bodyPool.Free(handle);
 }
 
 b2Joint* b2World::CreateJoint(const b2JointDef* def)
@@ -264,7 +347,11 @@ b2Joint* b2World::CreateJoint(const b2JointDef* def)
 		}
 	}
 
-	// Note: creating a joint doesn't wake the bodies.
+	// Joined bodies share an island. This wakes them.
+	if (bodyA->IsActive() && bodyB->IsActive())
+	{
+		m_islandManager.Link(bodyA, bodyB);
+	}
 
 	return j;
 }
@@ -302,6 +389,7 @@ void b2World::DestroyJoint(b2Joint* j)
 	// Wake up connected bodies.
 	bodyA->SetAwake(true);
 	bodyB->SetAwake(true);
+	m_islandManager.Unlink(bodyA, bodyB);
 
 	// Remove from body 1.
 	if (j->m_edgeA.prev)
@@ -364,6 +452,59 @@ void b2World::DestroyJoint(b2Joint* j)
 	}
 }
 
+b2Controller* b2World::CreateController(const b2ControllerDef* def)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return NULL;
+	}
+
+	b2Controller* controller = b2Controller::Create(def, &m_blockAllocator);
+	controller->m_world = this;
+
+	// Add to world doubly linked list.
+	controller->m_prev = NULL;
+	controller->m_next = m_controllerList;
+	if (m_controllerList)
+	{
+		m_controllerList->m_prev = controller;
+	}
+	m_controllerList = controller;
+	++m_controllerCount;
+
+	return controller;
+}
+
+void b2World::DestroyController(b2Controller* controller)
+{
+	b2Assert(m_controllerCount > 0);
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	// Remove from the world list.
+	if (controller->m_prev)
+	{
+		controller->m_prev->m_next = controller->m_next;
+	}
+
+	if (controller->m_next)
+	{
+		controller->m_next->m_prev = controller->m_prev;
+	}
+
+	if (controller == m_controllerList)
+	{
+		m_controllerList = controller->m_next;
+	}
+
+	--m_controllerCount;
+	b2Controller::Destroy(controller, &m_blockAllocator);
+}
+
 //
 void b2World::SetAllowSleeping(bool flag)
 {
@@ -385,87 +526,42 @@ void b2World::SetAllowSleeping(bool flag)
 // Find islands, integrate and solve constraints, solve position constraints
 void b2World::Solve(const b2TimeStep& step)
 {
+	B2_PROFILE_SCOPE("b2World::Solve");
+
 	m_profile.solveInit = 0.0f;
 	m_profile.solveVelocity = 0.0f;
 	m_profile.solvePosition = 0.0f;
 
-	// Size the island for the worst case.
-	b2Island island(m_bodyCount,
-					m_contactManager.m_contactCount,
-					m_jointCount,
-					&m_stackAllocator,
-					m_contactManager.m_contactListener);
-
-	// Clear all the island flags.
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
-	{
-		b->m_flags &= ~b2Body::e_islandFlag;
-	}
-	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	// Apply controller forces. These are integrated by the island solver below.
+	for (b2Controller* controller = m_controllerList; controller; controller = controller->m_next)
 	{
-		c->m_flags &= ~b2Contact::e_islandFlag;
-	}
-	for (b2Joint* j = m_jointList; j; j = j->m_next)
-	{
-		j->m_islandFlag = false;
+		controller->Step(step);
 	}
 
-	// Build and simulate all awake islands.
-	int32 stackSize = m_bodyCount;
-	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
-	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
-	{
-		if (seed->m_flags & b2Body::e_islandFlag)
-		{
-			continue;
-		}
-
-		if (seed->IsAwake() == false || seed->IsActive() == false)
-		{
-			continue;
-		}
+	// Apply the links made by new contacts and joints since the last step.
+	m_islandManager.Merge();
 
-		// The seed can be dynamic or kinematic.
-		if (seed->GetType() == b2_staticBody)
-		{
-			continue;
-		}
+	// Size the store for the worst case.
+	m_bodyStore.Clear(m_bodyCount, m_contactManager.m_contactCount, m_jointCount);
 
-		// Reset island and stack.
-		island.Clear();
-		int32 stackCount = 0;
-		stack[stackCount++] = seed;
-		seed->m_flags |= b2Body::e_islandFlag;
+	// Gather the awake islands. Sleeping islands are not visited. Constraints
+	// between two bodies of the island are added from body A. Static bodies
+	// may touch several islands, the island flag makes sure they are stored once.
+	int32 awakeCount = m_islandManager.GetAwakeCount();
+	for (int32 i = 0; i < awakeCount; ++i)
+	{
+		int32 islandId = m_islandManager.GetAwakeIsland(i);
+		m_bodyStore.BeginIsland(islandId);
 
-		// Perform a depth first search (DFS) on the constraint graph.
-		while (stackCount > 0)
+		for (b2Body* b = m_islandManager.GetIsland(islandId)->bodyList; b; b = b->m_islandNext)
 		{
-			// Grab the next body off the stack and add it to the island.
-			b2Body* b = stack[--stackCount];
-			b2Assert(b->IsActive() == true);
-			island.Add(b);
+			b2Assert(b->IsAwake() && b->IsActive());
+			m_bodyStore.Add(b);
 
-			// Make sure the body is awake.
-			b->SetAwake(true);
-
-			// To keep islands as small as possible, we don't
-			// propagate islands across static bodies.
-			if (b->GetType() == b2_staticBody)
-			{
-				continue;
-			}
-
-			// Search all contacts connected to this body.
 			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
 			{
 				b2Contact* contact = ce->contact;
 
-				// Has this contact already been added to an island?
-				if (contact->m_flags & b2Contact::e_islandFlag)
-				{
-					continue;
-				}
-
 				// Is this contact solid and touching?
 				if (contact->IsEnabled() == false ||
 					contact->IsTouching() == false)
@@ -481,30 +577,26 @@ void b2World::Solve(const b2TimeStep& step)
 					continue;
 				}
 
-				island.Add(contact);
-				contact->m_flags |= b2Contact::e_islandFlag;
-
 				b2Body* other = ce->other;
-
-				// Was the other body already added to this island?
-				if (other->m_flags & b2Body::e_islandFlag)
+				if (other->GetType() == b2_staticBody)
+				{
+					if ((other->m_flags & b2Body::e_islandFlag) == 0)
+					{
+						other->m_flags |= b2Body::e_islandFlag;
+						m_bodyStore.Add(other);
+					}
+				}
+				else if (contact->m_fixtureA->m_body != b)
 				{
+					b2Assert(other->m_islandId == islandId);
 					continue;
 				}
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
+				m_bodyStore.Add(contact);
 			}
 
-			// Search all joints connect to this body.
 			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
 			{
-				if (je->joint->m_islandFlag == true)
-				{
-					continue;
-				}
-
 				b2Body* other = je->other;
 
 				// Don't simulate joints connected to inactive bodies.
@@ -513,53 +605,59 @@ void b2World::Solve(const b2TimeStep& step)
 					continue;
 				}
 
-				island.Add(je->joint);
-				je->joint->m_islandFlag = true;
-
-				if (other->m_flags & b2Body::e_islandFlag)
+				if (other->GetType() == b2_staticBody)
 				{
+					if ((other->m_flags & b2Body::e_islandFlag) == 0)
+					{
+						other->m_flags |= b2Body::e_islandFlag;
+						m_bodyStore.Add(other);
+					}
+				}
+				else if (je->joint->m_bodyA != b)
+				{
+					b2Assert(other->m_islandId == islandId);
 					continue;
 				}
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
+				m_bodyStore.Add(je->joint);
 			}
 		}
 
-		b2Profile profile;
-		island.Solve(&profile, step, m_gravity, m_allowSleep);
-		m_profile.solveInit += profile.solveInit;
-		m_profile.solveVelocity += profile.solveVelocity;
-		m_profile.solvePosition += profile.solvePosition;
+		m_bodyStore.EndIsland();
+	}
 
-		// Post solve cleanup.
-		for (int32 i = 0; i < island.m_bodyCount; ++i)
+	m_bodyStore.Solve(&m_profile, step, m_gravity, m_allowSleep,
+					  &m_stackAllocator, m_contactManager.m_contactListener);
+
+	// Put resting islands to sleep and split the ones that may have fallen apart.
+	if (m_allowSleep)
+	{
+		int32 islandCount = m_bodyStore.GetIslandCount();
+		for (int32 i = 0; i < islandCount; ++i)
 		{
-			// Allow static bodies to participate in other islands.
-			b2Body* b = island.m_bodies[i];
-			if (b->GetType() == b2_staticBody)
-			{
-				b->m_flags &= ~b2Body::e_islandFlag;
-			}
+			m_islandManager.UpdateSleep(m_bodyStore.GetIslandId(i),
+										m_bodyStore.GetMinSleepTime(i), m_bodyStore.GetMaxSleepTime(i),
+										m_bodyStore.IsPositionSolved(i), &m_stackAllocator);
 		}
 	}
 
-	m_stackAllocator.Free(stack);
-
 	{
+		B2_PROFILE_SCOPE("b2World::Solve broadphase");
 		b2Timer timer;
-		// Synchronize fixtures, check for out of range bodies.
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		b2PerfSample perfStart;
+		if (m_perfCounters)
 		{
-			// If a body was not in an island then it did not move.
-			if ((b->m_flags & b2Body::e_islandFlag) == 0)
-			{
-				continue;
-			}
+			m_perfCounters->Read(&perfStart);
+		}
 
+		// Synchronize fixtures of the bodies that moved.
+		int32 storeCount = m_bodyStore.GetBodyCount();
+		for (int32 i = 0; i < storeCount; ++i)
+		{
+			b2Body* b = m_bodyStore.GetBody(i);
 			if (b->GetType() == b2_staticBody)
 			{
+				b->m_flags &= ~b2Body::e_islandFlag;
 				continue;
 			}
 
@@ -570,18 +668,73 @@ void b2World::Solve(const b2TimeStep& step)
 		// Look for new contacts.
 		m_contactManager.FindNewContacts();
 		m_profile.broadphase = timer.GetMilliseconds();
+		if (m_perfCounters)
+		{
+			b2ReadPerfPhase(m_perfCounters, perfStart, &m_perfProfile.broadphase);
+		}
+	}
+}
+
+// A heightfield is a single child, so the time of impact is the earliest of the
+// segments that shape B can reach during the sweep. Heightfields are always shape A.
+static void b2HeightfieldTimeOfImpact(b2TOIOutput* output, b2TOIInput* input,
+									  const b2HeightfieldShape* heightfield, const b2Shape* shapeB, int32 indexB)
+{
+	output->state = b2TOIOutput::e_separated;
+	output->t = input->tMax;
+
+	b2Transform xfA0, xfA1, xfB0, xfB1;
+	input->sweepA.GetTransform(&xfA0, 0.0f);
+	input->sweepA.GetTransform(&xfA1, 1.0f);
+	input->sweepB.GetTransform(&xfB0, 0.0f);
+	input->sweepB.GetTransform(&xfB1, 1.0f);
+
+	// The bounds of shape B during the sweep in the frame of the heightfield
+	b2AABB box0, box1, box;
+	shapeB->ComputeAABB(&box0, b2MulT(xfA0, xfB0), indexB);
+	shapeB->ComputeAABB(&box1, b2MulT(xfA1, xfB1), indexB);
+	box.Combine(box0, box1);
+
+	float32 radius = heightfield->m_radius;
+	if (box.lowerBound.y > heightfield->m_maxHeight + radius)
+	{
+		return;
+	}
+
+	int32 first, last;
+	if (heightfield->GetSegmentRange(box.lowerBound.x - radius, box.upperBound.x + radius, &first, &last) == false)
+	{
+		return;
+	}
+
+	for (int32 i = first; i <= last; ++i)
+	{
+		input->proxyA.Set(heightfield, i);
+
+		b2TOIOutput segmentOutput;
+		b2TimeOfImpact(&segmentOutput, input);
+
+		if (segmentOutput.state == b2TOIOutput::e_touching &&
+			(output->state != b2TOIOutput::e_touching || segmentOutput.t < output->t))
+		{
+			*output = segmentOutput;
+		}
 	}
 }
 
 // Find TOI contacts and solve them.
 void b2World::SolveTOI(const b2TimeStep& step)
 {
+	B2_PROFILE_SCOPE("b2World::SolveTOI");
+
 	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
 
 	if (m_stepComplete)
 	{
-		for (b2Body* b = m_bodyList; b; b = b->m_next)
+		b2Body* const* bodies = m_bodyPool.GetObjects();
+		for (int32 i = 0; i < m_bodyCount; ++i)
 		{
+			b2Body* b = bodies[i];
 			b->m_flags &= ~b2Body::e_islandFlag;
 			b->m_sweep.alpha0 = 0.0f;
 		}
@@ -687,7 +840,14 @@ void b2World::SolveTOI(const b2TimeStep& step)
 				input.tMax = 1.0f;
 
 				b2TOIOutput output;
-				b2TimeOfImpact(&output, &input);
+				if (fA->GetType() == b2Shape::e_heightfield)
+				{
+					b2HeightfieldTimeOfImpact(&output, &input, (b2HeightfieldShape*)fA->GetShape(), fB->GetShape(), indexB);
+				}
+				else
+				{
+					b2TimeOfImpact(&output, &input);
+				}
 
 				// Beta is the fraction of the remaining portion of the .
 				float32 beta = output.t;
@@ -896,8 +1056,22 @@ void b2World::SolveTOI(const b2TimeStep& step)
 
 void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIterations)
 {
+	B2_PROFILE_SCOPE("b2World::Step");
 	b2Timer stepTimer;
 
+	// Hardware counters are read around the same phases as the timers.
+	b2PerfSample perfStart, stepStart;
+	if (m_perfCounters)
+	{
+		m_perfCounters->Read(&stepStart);
+	}
+
+	// Count the allocator calls made by the step.
+	m_countingAllocator.Arm();
+
+	// Iterate the bodies in memory order.
+	m_bodyPool.Sort();
+
 	// If new fixtures were added, we need to find the new contacts.
 	if (m_flags & e_newFixture)
 	{
@@ -927,24 +1101,51 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	// Update contacts. This is where some contacts are destroyed.
 	{
 		b2Timer timer;
+		if (m_perfCounters)
+		{
+			m_perfCounters->Read(&perfStart);
+		}
+
 		m_contactManager.Collide();
 		m_profile.collide = timer.GetMilliseconds();
+		if (m_perfCounters)
+		{
+			b2ReadPerfPhase(m_perfCounters, perfStart, &m_perfProfile.collide);
+		}
 	}
 
 	// Integrate velocities, solve velocity constraints, and integrate positions.
 	if (m_stepComplete && step.dt > 0.0f)
 	{
 		b2Timer timer;
+		if (m_perfCounters)
+		{
+			m_perfCounters->Read(&perfStart);
+		}
+
 		Solve(step);
 		m_profile.solve = timer.GetMilliseconds();
+		if (m_perfCounters)
+		{
+			b2ReadPerfPhase(m_perfCounters, perfStart, &m_perfProfile.solve);
+		}
 	}
 
 	// Handle TOI events.
 	if (m_continuousPhysics && step.dt > 0.0f)
 	{
 		b2Timer timer;
+		if (m_perfCounters)
+		{
+			m_perfCounters->Read(&perfStart);
+		}
+
 		SolveTOI(step);
 		m_profile.solveTOI = timer.GetMilliseconds();
+		if (m_perfCounters)
+		{
+			b2ReadPerfPhase(m_perfCounters, perfStart, &m_perfProfile.solveTOI);
+		}
 	}
 
 	if (step.dt > 0.0f)
@@ -959,13 +1160,21 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 
 	m_flags &= ~e_locked;
 
+	m_countingAllocator.Disarm();
+
 	m_profile.step = stepTimer.GetMilliseconds();
+	if (m_perfCounters)
+	{
+		b2ReadPerfPhase(m_perfCounters, stepStart, &m_perfProfile.step);
+	}
 }
 
 void b2World::ClearForces()
 {
-	for (b2Body* body = m_bodyList; body; body = body->GetNext())
+	b2Body* const* bodies = m_bodyPool.GetObjects();
+	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
+		b2Body* body = bodies[i];
 		body->m_force.SetZero();
 		body->m_torque = 0.0f;
 	}
@@ -1070,6 +1279,21 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 		}
 		break;
 
+	case b2Shape::e_heightfield:
+		{
+			b2HeightfieldShape* heightfield = (b2HeightfieldShape*)fixture->GetShape();
+			int32 count = heightfield->m_count;
+
+			b2Vec2 v1 = b2Mul(xf, heightfield->GetVertex(0));
+			for (int32 i = 1; i < count; ++i)
+			{
+				b2Vec2 v2 = b2Mul(xf, heightfield->GetVertex(i));
+				m_debugDraw->DrawSegment(v1, v2, color);
+				v1 = v2;
+			}
+		}
+		break;
+
 	case b2Shape::e_polygon:
 		{
 			b2PolygonShape* poly = (b2PolygonShape*)fixture->GetShape();
@@ -1132,6 +1356,31 @@ void b2World::DrawJoint(b2Joint* joint)
 	}
 }
 
+// Shapes are colored by the state of their body
+static b2Color b2GetDebugColor(const b2Body* b)
+{
+	if (b->IsActive() == false)
+	{
+		return b2Color(0.5f, 0.5f, 0.3f);
+	}
+	else if (b->GetType() == b2_staticBody)
+	{
+		return b2Color(0.5f, 0.9f, 0.5f);
+	}
+	else if (b->GetType() == b2_kinematicBody)
+	{
+		return b2Color(0.5f, 0.5f, 0.9f);
+	}
+	else if (b->IsAwake() == false)
+	{
+		return b2Color(0.6f, 0.6f, 0.6f);
+	}
+	else
+	{
+		return b2Color(0.9f, 0.7f, 0.7f);
+	}
+}
+
 void b2World::DrawDebugData()
 {
 	if (m_debugDraw == NULL)
@@ -1143,31 +1392,15 @@ void b2World::DrawDebugData()
 
 	if (flags & b2Draw::e_shapeBit)
 	{
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		b2Body* const* bodies = m_bodyPool.GetObjects();
+		for (int32 i = 0; i < m_bodyCount; ++i)
 		{
+			b2Body* b = bodies[i];
 			const b2Transform& xf = b->GetTransform();
+			b2Color color = b2GetDebugColor(b);
 			for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
 			{
-				if (b->IsActive() == false)
-				{
-					DrawShape(f, xf, b2Color(0.5f, 0.5f, 0.3f));
-				}
-				else if (b->GetType() == b2_staticBody)
-				{
-					DrawShape(f, xf, b2Color(0.5f, 0.9f, 0.5f));
-				}
-				else if (b->GetType() == b2_kinematicBody)
-				{
-					DrawShape(f, xf, b2Color(0.5f, 0.5f, 0.9f));
-				}
-				else if (b->IsAwake() == false)
-				{
-					DrawShape(f, xf, b2Color(0.6f, 0.6f, 0.6f));
-				}
-				else
-				{
-					DrawShape(f, xf, b2Color(0.9f, 0.7f, 0.7f));
-				}
+				DrawShape(f, xf, color);
 			}
 		}
 	}
@@ -1200,8 +1433,10 @@ void b2World::DrawDebugData()
 		b2Color color(0.9f, 0.3f, 0.9f);
 		b2BroadPhase* bp = &m_contactManager.m_broadPhase;
 
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		b2Body* const* bodies = m_bodyPool.GetObjects();
+		for (int32 i = 0; i < m_bodyCount; ++i)
 		{
+			b2Body* b = bodies[i];
 			if (b->IsActive() == false)
 			{
 				continue;
@@ -1225,10 +1460,20 @@ void b2World::DrawDebugData()
 		}
 	}
 
+	if (flags & b2Draw::e_controllerBit)
+	{
+		for (b2Controller* controller = m_controllerList; controller; controller = controller->m_next)
+		{
+			controller->Draw(m_debugDraw);
+		}
+	}
+
 	if (flags & b2Draw::e_centerOfMassBit)
 	{
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		b2Body* const* bodies = m_bodyPool.GetObjects();
+		for (int32 i = 0; i < m_bodyCount; ++i)
 		{
+			b2Body* b = bodies[i];
 			b2Transform xf = b->GetTransform();
 			xf.p = b->GetWorldCenter();
 			m_debugDraw->DrawTransform(xf);
@@ -1236,6 +1481,174 @@ void b2World::DrawDebugData()
 	}
 }
 
+struct b2WorldDrawWrapper
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)world->m_contactManager.m_broadPhase.GetUserData(proxyId);
+		if (drawShapes)
+		{
+			world->DrawFixtureChild(proxy->fixture, proxy->childIndex, aabb);
+		}
+
+		if (collectProxies)
+		{
+			proxies.Push(proxyId);
+		}
+		return true;
+	}
+
+	b2World* world;
+	b2AABB aabb;
+	bool drawShapes;
+	bool collectProxies;
+	b2GrowableStack<int32, 256> proxies;
+};
+
+void b2World::DrawDebugData(const b2AABB& aabb)
+{
+	if (m_debugDraw == NULL)
+	{
+		return;
+	}
+
+	uint32 flags = m_debugDraw->GetFlags();
+	const uint32 bodyBits = b2Draw::e_jointBit | b2Draw::e_centerOfMassBit;
+
+	b2WorldDrawWrapper wrapper;
+	wrapper.world = this;
+	wrapper.aabb = aabb;
+	wrapper.drawShapes = (flags & b2Draw::e_shapeBit) != 0;
+	wrapper.collectProxies = (flags & (b2Draw::e_aabbBit | bodyBits)) != 0;
+	if (wrapper.drawShapes || wrapper.collectProxies)
+	{
+		m_contactManager.m_broadPhase.Query(&wrapper, aabb);
+	}
+
+	// The overlays only visit the proxies found above and their bodies. Each
+	// body is marked so that it is listed once, however many proxies it has.
+	b2BroadPhase* bp = &m_contactManager.m_broadPhase;
+	b2GrowableStack<b2Body*, 256> bodies;
+	b2Color aabbColor(0.9f, 0.3f, 0.9f);
+	while (wrapper.proxies.GetCount() > 0)
+	{
+		int32 proxyId = wrapper.proxies.Pop();
+
+		if (flags & b2Draw::e_aabbBit)
+		{
+			b2AABB fatAABB = bp->GetFatAABB(proxyId);
+			b2Vec2 vs[4];
+			vs[0].Set(fatAABB.lowerBound.x, fatAABB.lowerBound.y);
+			vs[1].Set(fatAABB.upperBound.x, fatAABB.lowerBound.y);
+			vs[2].Set(fatAABB.upperBound.x, fatAABB.upperBound.y);
+			vs[3].Set(fatAABB.lowerBound.x, fatAABB.upperBound.y);
+			m_debugDraw->DrawPolygon(vs, 4, aabbColor);
+		}
+
+		b2FixtureProxy* proxy = (b2FixtureProxy*)bp->GetUserData(proxyId);
+		b2Body* b = proxy->fixture->GetBody();
+		if ((flags & bodyBits) && (b->m_flags & b2Body::e_debugDrawFlag) == 0)
+		{
+			b->m_flags |= b2Body::e_debugDrawFlag;
+			bodies.Push(b);
+		}
+	}
+
+	// A joint between two bodies in view is drawn by its body A only. Joints
+	// whose bodies are both out of view are not drawn.
+	b2GrowableStack<b2Body*, 256> drawn;
+	while (bodies.GetCount() > 0)
+	{
+		b2Body* b = bodies.Pop();
+		if (flags & b2Draw::e_jointBit)
+		{
+			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			{
+				if (je->joint->GetBodyA() == b || (je->other->m_flags & b2Body::e_debugDrawFlag) == 0)
+				{
+					DrawJoint(je->joint);
+				}
+			}
+		}
+		drawn.Push(b);
+	}
+
+	if (flags & b2Draw::e_controllerBit)
+	{
+		for (b2Controller* controller = m_controllerList; controller; controller = controller->m_next)
+		{
+			controller->Draw(m_debugDraw);
+		}
+	}
+
+	while (drawn.GetCount() > 0)
+	{
+		b2Body* b = drawn.Pop();
+		b->m_flags &= ~b2Body::e_debugDrawFlag;
+
+		if (flags & b2Draw::e_centerOfMassBit)
+		{
+			b2Transform xf = b->GetTransform();
+			xf.p = b->GetWorldCenter();
+			m_debugDraw->DrawTransform(xf);
+		}
+	}
+}
+
+void b2World::DrawFixtureChild(b2Fixture* fixture, int32 childIndex, const b2AABB& aabb)
+{
+	b2Body* b = fixture->GetBody();
+	const b2Transform& xf = b->GetTransform();
+	b2Color color = b2GetDebugColor(b);
+
+	// Each edge of a chain has its own proxy
+	if (fixture->GetType() == b2Shape::e_chain)
+	{
+		b2ChainShape* chain = (b2ChainShape*)fixture->GetShape();
+		b2EdgeShape edge;
+		chain->GetChildEdge(&edge, childIndex);
+		m_debugDraw->DrawSegment(b2Mul(xf, edge.m_vertex1), b2Mul(xf, edge.m_vertex2), color);
+		return;
+	}
+
+	// A heightfield has one proxy, only the segments under the view are drawn
+	if (fixture->GetType() == b2Shape::e_heightfield)
+	{
+		b2HeightfieldShape* heightfield = (b2HeightfieldShape*)fixture->GetShape();
+
+		b2Vec2 corners[4];
+		corners[0].Set(aabb.lowerBound.x, aabb.lowerBound.y);
+		corners[1].Set(aabb.upperBound.x, aabb.lowerBound.y);
+		corners[2].Set(aabb.upperBound.x, aabb.upperBound.y);
+		corners[3].Set(aabb.lowerBound.x, aabb.upperBound.y);
+		float32 lowerX = b2_maxFloat;
+		float32 upperX = -b2_maxFloat;
+		for (int32 i = 0; i < 4; ++i)
+		{
+			float32 x = b2MulT(xf, corners[i]).x;
+			lowerX = b2Min(lowerX, x);
+			upperX = b2Max(upperX, x);
+		}
+
+		int32 first, last;
+		if (heightfield->GetSegmentRange(lowerX, upperX, &first, &last) == false)
+		{
+			return;
+		}
+
+		b2Vec2 v1 = b2Mul(xf, heightfield->GetVertex(first));
+		for (int32 i = first + 1; i <= last + 1; ++i)
+		{
+			b2Vec2 v2 = b2Mul(xf, heightfield->GetVertex(i));
+			m_debugDraw->DrawSegment(v1, v2, color);
+			v1 = v2;
+		}
+		return;
+	}
+
+	DrawShape(fixture, xf, color);
+}
+
 int32 b2World::GetProxyCount() const
 {
 	return m_contactManager.m_broadPhase.GetProxyCount();
@@ -1264,8 +1677,10 @@ void b2World::ShiftOrigin(const b2Vec2& newOrigin)
 		return;
 	}
 
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	b2Body* const* bodies = m_bodyPool.GetObjects();
+	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
+		b2Body* b = bodies[i];
 		b->m_xf.p -= newOrigin;
 		b->m_sweep.c0 -= newOrigin;
 		b->m_sweep.c -= newOrigin;
@@ -20,17 +20,25 @@
 #define B2_WORLD_H
 
 #include <Box2D/Common/b2Math.h>
+#include <Box2D/Common/b2Allocator.h>
 #include <Box2D/Common/b2BlockAllocator.h>
 #include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Common/b2HandlePool.h>
+#include <Box2D/Common/b2PerfCounters.h>
+#include <Box2D/Dynamics/b2BodyStore.h>
+#include <Box2D/Dynamics/b2IslandManager.h>
 #include <Box2D/Dynamics/b2ContactManager.h>
+#include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 
 struct b2AABB;
 struct b2BodyDef;
 struct b2Color;
+struct b2ControllerDef;
 struct b2JointDef;
 class b2Body;
+class b2Controller;
 class b2Draw;
 class b2Fixture;
 class b2Joint;
@@ -43,7 +51,9 @@ class b2World
 public:
 	/// Construct a world object.
 	/// @param gravity the world gravity vector.
-	b2World(const b2Vec2& gravity);
+	/// @param allocator provides all heap memory of the world, or NULL to use
+	/// b2Alloc. The allocator is owned by you and must outlive the world.
+	b2World(const b2Vec2& gravity, b2Allocator* allocator = NULL);
 
 	/// Destruct the world. All physics entities are destroyed and all heap memory is released.
 	~b2World();
@@ -61,6 +71,21 @@ public:
 	/// remain in scope.
 	void SetContactListener(b2ContactListener* listener);
 
+	/// Record the begin and end of sensor overlaps in a buffer. This is off by
+	/// default. Unlike the contact listener this makes no call per contact, the
+	/// events are read after the time step and stay until ClearSensorEvents.
+	void SetSensorEventsEnabled(bool flag);
+	bool GetSensorEventsEnabled() const;
+
+	/// Get the sensor events recorded since the last ClearSensorEvents, in the
+	/// order they happened. Destroying a touching body or fixture records its
+	/// end events right away.
+	const b2SensorEvent* GetSensorEvents() const;
+	int32 GetSensorEventCount() const;
+
+	/// Forget the recorded sensor events. Call this after handling them.
+	void ClearSensorEvents();
+
 	/// Register a routine for debug drawing. The debug draw functions are called
 	/// inside with b2World::DrawDebugData method. The debug draw object is owned
 	/// by you and must remain in scope.
@@ -86,6 +111,15 @@ public:
 	/// @warning This function is locked during callbacks.
 	void DestroyJoint(b2Joint* joint);
 
+	/// Create a controller that applies forces to a set of bodies every time step.
+	/// No reference to the definition is retained.
+	/// @warning This function is locked during callbacks.
+	b2Controller* CreateController(const b2ControllerDef* def);
+
+	/// Destroy a controller. The bodies it affected are not destroyed.
+	/// @warning This function is locked during callbacks.
+	void DestroyController(b2Controller* controller);
+
 	/// Take a time step. This performs collision detection, integration,
 	/// and constraint solution.
 	/// @param timeStep the amount of time to simulate, this should not vary.
@@ -107,6 +141,16 @@ public:
 	/// Call this to draw shapes and other debug draw data. This is intentionally non-const.
 	void DrawDebugData();
 
+	/// Draw the debug data like DrawDebugData, but only the shapes that overlap
+	/// the given AABB. The shapes are found with the broad-phase, so the cost
+	/// depends on what is in view and not on the size of the world. Shapes of
+	/// inactive bodies are not in the broad-phase and are not drawn. Chains are
+	/// drawn edge by edge and heightfields only over the x range of the AABB.
+	/// The AABB, joint and center of mass overlays use the same query: they are
+	/// drawn for the proxies found and their bodies, so a joint is drawn if one
+	/// of its bodies is in view. Controllers are always drawn.
+	void DrawDebugData(const b2AABB& aabb);
+
 	/// Query the world for all fixtures that potentially overlap the
 	/// provided AABB.
 	/// @param callback a user implemented callback class.
@@ -121,6 +165,16 @@ public:
 	/// @param point2 the ray ending point
 	void RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const;
 
+	/// Get a body from its handle.
+	/// @return the body or NULL if it was destroyed.
+	b2Body* GetBody(const b2Handle& handle);
+	const b2Body* GetBody(const b2Handle& handle) const;
+
+	/// Get a fixture from its handle.
+	/// @return the fixture or NULL if it was destroyed.
+	b2Fixture* GetFixture(const b2Handle& handle);
+	const b2Fixture* GetFixture(const b2Handle& handle) const;
+
 	/// Get the world body list. With the returned body, use b2Body::GetNext to get
 	/// the next body in the world list. A NULL body indicates the end of the list.
 	/// @return the head of the world body list.
@@ -133,6 +187,12 @@ public:
 	b2Joint* GetJointList();
 	const b2Joint* GetJointList() const;
 
+	/// Get the world controller list. With the returned controller, use b2Controller::GetNext
+	/// to get the next controller in the world list. A NULL controller indicates the end of the list.
+	/// @return the head of the world controller list.
+	b2Controller* GetControllerList();
+	const b2Controller* GetControllerList() const;
+
 	/// Get the world contact list. With the returned contact, use b2Contact::GetNext to get
 	/// the next contact in the world list. A NULL contact indicates the end of the list.
 	/// @return the head of the world contact list.
@@ -166,6 +226,9 @@ public:
 	/// Get the number of joints.
 	int32 GetJointCount() const;
 
+	/// Get the number of controllers.
+	int32 GetControllerCount() const;
+
 	/// Get the number of contacts (each may have 0 or more contact points).
 	int32 GetContactCount() const;
 
@@ -205,6 +268,29 @@ public:
 	/// Get the current profile.
 	const b2Profile& GetProfile() const;
 
+	/// Count hardware events per profile phase during each time step. The
+	/// counters must outlive the world or be removed with NULL.
+	void SetPerfCounters(const b2PerfCounters* counters);
+
+	/// Get the hardware event counts of the last time step. These stay zero
+	/// without perf counters.
+	const b2PerfProfile& GetPerfProfile() const;
+
+	/// Get the allocator that provides the heap memory of the world.
+	b2Allocator* GetAllocator() const;
+
+	/// Size the world's memory for the given number of bodies, joints, contacts
+	/// and broad-phase proxies. Stepping a world that stays within these counts
+	/// makes no allocator calls.
+	void Reserve(int32 bodyCount, int32 jointCount, int32 contactCount, int32 proxyCount);
+
+	/// Log and assert whenever a time step calls the allocator. This is off by default.
+	void SetAllocationCheck(bool flag);
+	bool GetAllocationCheck() const;
+
+	/// Get the number of allocator calls made during the last time step.
+	int32 GetStepAllocationCount() const;
+
 	/// Dump the world into the log file.
 	/// @warning this should be called outside of a time step.
 	void Dump();
@@ -222,26 +308,43 @@ private:
 	friend class b2Body;
 	friend class b2Fixture;
 	friend class b2ContactManager;
+	friend class b2Contact;
 	friend class b2Controller;
+	friend struct b2WorldDrawWrapper;
 
 	void Solve(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
 
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
+	void DrawFixtureChild(b2Fixture* fixture, int32 childIndex, const b2AABB& aabb);
 
+	b2Allocator* m_allocator;
+	b2CountingAllocator m_countingAllocator;
 	b2BlockAllocator m_blockAllocator;
 	b2StackAllocator m_stackAllocator;
 
+	// Bodies and fixtures are stored in blocks so the step can iterate
+	// them densely. The lists are kept for the pointer API.
+	b2HandlePool<b2Body> m_bodyPool;
+	b2HandlePool<b2Fixture> m_fixturePool;
+
+	// The solver state of the awake islands, refilled every step.
+	b2BodyStore m_bodyStore;
+
+	b2IslandManager m_islandManager;
+
 	int32 m_flags;
 
 	b2ContactManager m_contactManager;
 
 	b2Body* m_bodyList;
 	b2Joint* m_jointList;
+	b2Controller* m_controllerList;
 
 	int32 m_bodyCount;
 	int32 m_jointCount;
+	int32 m_controllerCount;
 
 	b2Vec2 m_gravity;
 	bool m_allowSleep;
@@ -261,8 +364,31 @@ private:
 	bool m_stepComplete;
 
 	b2Profile m_profile;
+
+	const b2PerfCounters* m_perfCounters;
+	b2PerfProfile m_perfProfile;
 };
 
+inline b2Body* b2World::GetBody(const b2Handle& handle)
+{
+	return m_bodyPool.Get(handle);
+}
+
+inline const b2Body* b2World::GetBody(const b2Handle& handle) const
+{
+	return m_bodyPool.Get(handle);
+}
+
+inline b2Fixture* b2World::GetFixture(const b2Handle& handle)
+{
+	return m_fixturePool.Get(handle);
+}
+
+inline const b2Fixture* b2World::GetFixture(const b2Handle& handle) const
+{
+	return m_fixturePool.Get(handle);
+}
+
 inline b2Body* b2World::GetBodyList()
 {
 	return m_bodyList;
@@ -283,6 +409,16 @@ inline const b2Joint* b2World::GetJointList() const
 	return m_jointList;
 }
 
+inline b2Controller* b2World::GetControllerList()
+{
+	return m_controllerList;
+}
+
+inline const b2Controller* b2World::GetControllerList() const
+{
+	return m_controllerList;
+}
+
 inline b2Contact* b2World::GetContactList()
 {
 	return m_contactManager.m_contactList;
@@ -303,6 +439,31 @@ inline int32 b2World::GetJointCount() const
 	return m_jointCount;
 }
 
+inline int32 b2World::GetControllerCount() const
+{
+	return m_controllerCount;
+}
+
+inline bool b2World::GetSensorEventsEnabled() const
+{
+	return m_contactManager.m_sensorEventsEnabled;
+}
+
+inline const b2SensorEvent* b2World::GetSensorEvents() const
+{
+	return m_contactManager.m_sensorEvents;
+}
+
+inline int32 b2World::GetSensorEventCount() const
+{
+	return m_contactManager.m_sensorEventCount;
+}
+
+inline void b2World::ClearSensorEvents()
+{
+	m_contactManager.m_sensorEventCount = 0;
+}
+
 inline int32 b2World::GetContactCount() const
 {
 	return m_contactManager.m_contactCount;
@@ -351,4 +512,34 @@ inline const b2Profile& b2World::GetProfile() const
 	return m_profile;
 }
 
+inline void b2World::SetPerfCounters(const b2PerfCounters* counters)
+{
+	m_perfCounters = counters;
+}
+
+inline const b2PerfProfile& b2World::GetPerfProfile() const
+{
+	return m_perfProfile;
+}
+
+inline b2Allocator* b2World::GetAllocator() const
+{
+	return m_allocator;
+}
+
+inline void b2World::SetAllocationCheck(bool flag)
+{
+	m_countingAllocator.SetAssert(flag);
+}
+
+inline bool b2World::GetAllocationCheck() const
+{
+	return m_countingAllocator.GetAssert();
+}
+
+inline int32 b2World::GetStepAllocationCount() const
+{
+	return m_countingAllocator.GetCount();
+}
+
 #endif
@@ -18,10 +18,101 @@
 
 #include <Box2D/Rope/b2Rope.h>
 #include <Box2D/Common/b2Draw.h>
+#include <Box2D/Common/b2Allocator.h>
+#include <Box2D/Common/b2GrowableStack.h>
+#include <Box2D/Collision/b2Distance.h>
+#include <Box2D/Collision/Shapes/b2HeightfieldShape.h>
+#include <Box2D/Dynamics/b2World.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+
+// A rope segment touching a fixture. The segment point at t must stay on the
+// positive side of the plane through point with this normal.
+struct b2RopeContact
+{
+	b2Vec2 normal;
+	b2Vec2 point;
+	float32 t;
+	int32 index;
+};
+
+// Finds the fixtures that overlap the rope in the world broad-phase.
+class b2RopeQueryCallback
+{
+public:
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)m_broadPhase->GetUserData(proxyId);
+		b2Fixture* fixture = proxy->fixture;
+		if (fixture->IsSensor())
+		{
+			return true;
+		}
+
+		// Same rule as b2ContactFilter
+		const b2Filter& filterA = m_rope->m_filter;
+		const b2Filter& filterB = fixture->GetFilterData();
+		if (filterA.groupIndex == filterB.groupIndex && filterA.groupIndex != 0)
+		{
+			if (filterA.groupIndex < 0)
+			{
+				return true;
+			}
+		}
+		else if ((filterA.maskBits & filterB.categoryBits) == 0 || (filterA.categoryBits & filterB.maskBits) == 0)
+		{
+			return true;
+		}
+
+		m_rope->CollideFixture(fixture, proxy->childIndex, proxy->aabb);
+		return true;
+	}
+
+	b2Rope* m_rope;
+	const b2BroadPhase* m_broadPhase;
+};
+
+// Solves one color of constraints for a b2RopeScheduler.
+class b2RopeColorTask : public b2RopeTask
+{
+public:
+	void Execute(int32 begin, int32 end)
+	{
+		if (m_stretch)
+		{
+			m_rope->SolveC2Color(m_color, begin, end);
+		}
+		else
+		{
+			m_rope->SolveC3Color(m_color, begin, end);
+		}
+	}
+
+	b2Rope* m_rope;
+	int32 m_color;
+	bool m_stretch;
+};
+
+b2SerialRopeScheduler::b2SerialRopeScheduler(int32 rangeSize)
+{
+	m_rangeSize = b2Max(rangeSize, 1);
+	m_rangeCount = 0;
+}
+
+void b2SerialRopeScheduler::Run(b2RopeTask* task, int32 count)
+{
+	int32 rangeCount = (count + m_rangeSize - 1) / m_rangeSize;
+	for (int32 i = rangeCount - 1; i >= 0; --i)
+	{
+		int32 begin = i * m_rangeSize;
+		task->Execute(begin, b2Min(begin + m_rangeSize, count));
+	}
+	m_rangeCount += rangeCount;
+}
 
 b2Rope::b2Rope()
 {
 	m_count = 0;
+	m_capacity = 0;
 	m_ps = NULL;
 	m_p0s = NULL;
 	m_vs = NULL;
@@ -31,6 +122,18 @@ b2Rope::b2Rope()
 	m_gravity.SetZero();
 	m_k2 = 1.0f;
 	m_k3 = 0.1f;
+	m_ordering = b2_sequentialOrdering;
+	m_scheduler = NULL;
+	m_minScheduledCount = 0;
+	m_world = NULL;
+	m_radius = 0.0f;
+	m_friction = 0.0f;
+	m_nodes = NULL;
+	m_levelCount = 0;
+	m_allocator = NULL;
+	m_contacts = NULL;
+	m_contactCount = 0;
+	m_contactCapacity = 0;
 }
 
 b2Rope::~b2Rope()
@@ -41,16 +144,23 @@ b2Rope::~b2Rope()
 	b2Free(m_ims);
 	b2Free(m_Ls);
 	b2Free(m_as);
+	b2Free(m_nodes);
+	if (m_contacts != NULL)
+	{
+		m_allocator->Free(m_contacts, m_contactCapacity * sizeof(b2RopeContact), "b2Rope contacts");
+	}
 }
 
 void b2Rope::Initialize(const b2RopeDef* def)
 {
 	b2Assert(def->count >= 3);
+	b2Assert(def->capacity == 0 || def->capacity >= def->count);
 	m_count = def->count;
-	m_ps = (b2Vec2*)b2Alloc(m_count * sizeof(b2Vec2));
-	m_p0s = (b2Vec2*)b2Alloc(m_count * sizeof(b2Vec2));
-	m_vs = (b2Vec2*)b2Alloc(m_count * sizeof(b2Vec2));
-	m_ims = (float32*)b2Alloc(m_count * sizeof(float32));
+	m_capacity = b2Max(def->count, def->capacity);
+	m_ps = (b2Vec2*)b2Alloc(m_capacity * sizeof(b2Vec2));
+	m_p0s = (b2Vec2*)b2Alloc(m_capacity * sizeof(b2Vec2));
+	m_vs = (b2Vec2*)b2Alloc(m_capacity * sizeof(b2Vec2));
+	m_ims = (float32*)b2Alloc(m_capacity * sizeof(float32));
 
 	for (int32 i = 0; i < m_count; ++i)
 	{
@@ -71,8 +181,8 @@ void b2Rope::Initialize(const b2RopeDef* def)
 
 	int32 count2 = m_count - 1;
 	int32 count3 = m_count - 2;
-	m_Ls = (float32*)b2Alloc(count2 * sizeof(float32));
-	m_as = (float32*)b2Alloc(count3 * sizeof(float32));
+	m_Ls = (float32*)b2Alloc((m_capacity - 1) * sizeof(float32));
+	m_as = (float32*)b2Alloc((m_capacity - 2) * sizeof(float32));
 
 	for (int32 i = 0; i < count2; ++i)
 	{
@@ -100,6 +210,23 @@ void b2Rope::Initialize(const b2RopeDef* def)
 	m_damping = def->damping;
 	m_k2 = def->k2;
 	m_k3 = def->k3;
+	m_ordering = def->ordering;
+
+	m_world = def->world;
+	m_radius = def->radius;
+	m_friction = def->friction;
+	m_filter = def->filter;
+	if (m_world != NULL)
+	{
+		// A full binary tree over the segments, plus one rounding node per level
+		int32 nodeCapacity = 2 * (m_capacity - 1) + 32;
+		m_nodes = (b2AABB*)b2Alloc(nodeCapacity * sizeof(b2AABB));
+
+		// Contacts come from the world's memory, like everything else the world steps
+		m_allocator = m_world->GetAllocator();
+		m_contactCapacity = b2Max(def->contactCapacity, 1);
+		m_contacts = (b2RopeContact*)m_allocator->Allocate(m_contactCapacity * sizeof(b2RopeContact), "b2Rope contacts");
+	}
 }
 
 void b2Rope::Step(float32 h, int32 iterations)
@@ -123,11 +250,37 @@ void b2Rope::Step(float32 h, int32 iterations)
 
 	}
 
-	for (int32 i = 0; i < iterations; ++i)
+	m_contactCount = 0;
+	if (m_world != NULL)
+	{
+		FindContacts();
+	}
+
+	if (m_ordering == b2_redBlackOrdering)
+	{
+		for (int32 i = 0; i < iterations; ++i)
+		{
+			SolveColoredC2();
+			SolveColoredC3();
+			SolveColoredC2();
+			SolveContacts();
+		}
+	}
+	else
+	{
+		for (int32 i = 0; i < iterations; ++i)
+		{
+			SolveC2();
+			SolveC3();
+			SolveC2();
+			SolveContacts();
+		}
+	}
+
+	if (m_contactCount > 0)
 	{
-		SolveC2();
-		SolveC3();
-		SolveC2();
+		ApplyFriction();
+		SolveContacts();
 	}
 
 	float32 inv_h = 1.0f / h;
@@ -168,6 +321,68 @@ void b2Rope::SolveC2()
 	}
 }
 
+void b2Rope::SetVertex(int32 index, const b2Vec2& position)
+{
+	b2Assert(0 <= index && index < m_count);
+	m_ps[index] = position;
+	m_p0s[index] = position;
+	m_vs[index].SetZero();
+}
+
+void b2Rope::SetMass(int32 index, float32 mass)
+{
+	b2Assert(0 <= index && index < m_count);
+	m_ims[index] = mass > 0.0f ? 1.0f / mass : 0.0f;
+}
+
+void b2Rope::SetRestLength(int32 index, float32 length)
+{
+	b2Assert(0 <= index && index < m_count - 1);
+	m_Ls[index] = length;
+}
+
+float32 b2Rope::GetRestLength(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count - 1);
+	return m_Ls[index];
+}
+
+bool b2Rope::AddVertex(const b2Vec2& position, float32 mass, float32 restLength)
+{
+	if (m_count == m_capacity)
+	{
+		return false;
+	}
+
+	int32 i = m_count;
+	m_ps[i] = position;
+	m_p0s[i] = position;
+	m_vs[i].SetZero();
+	m_ims[i] = mass > 0.0f ? 1.0f / mass : 0.0f;
+	m_Ls[i - 1] = restLength;
+	if (i >= 2)
+	{
+		m_as[i - 2] = 0.0f;
+	}
+
+	++m_count;
+	return true;
+}
+
+void b2Rope::RemoveVertex()
+{
+	if (m_count > 2)
+	{
+		--m_count;
+	}
+}
+
+void b2Rope::SetScheduler(b2RopeScheduler* scheduler, int32 minCount)
+{
+	m_scheduler = scheduler;
+	m_minScheduledCount = b2Max(minCount, 1);
+}
+
 void b2Rope::SetAngle(float32 angle)
 {
 	int32 count3 = m_count - 2;
@@ -183,68 +398,461 @@ void b2Rope::SolveC3()
 
 	for (int32 i = 0; i < count3; ++i)
 	{
-		b2Vec2 p1 = m_ps[i];
-		b2Vec2 p2 = m_ps[i + 1];
-		b2Vec2 p3 = m_ps[i + 2];
+		SolveBend(i);
+	}
+}
 
-		float32 m1 = m_ims[i];
-		float32 m2 = m_ims[i + 1];
-		float32 m3 = m_ims[i + 2];
+inline void b2Rope::SolveBend(int32 i)
+{
+	b2Vec2 p1 = m_ps[i];
+	b2Vec2 p2 = m_ps[i + 1];
+	b2Vec2 p3 = m_ps[i + 2];
 
-		b2Vec2 d1 = p2 - p1;
-		b2Vec2 d2 = p3 - p2;
+	float32 m1 = m_ims[i];
+	float32 m2 = m_ims[i + 1];
+	float32 m3 = m_ims[i + 2];
+
+	b2Vec2 d1 = p2 - p1;
+	b2Vec2 d2 = p3 - p2;
+
+	float32 L1sqr = d1.LengthSquared();
+	float32 L2sqr = d2.LengthSquared();
+
+	if (L1sqr * L2sqr == 0.0f)
+	{
+		return;
+	}
+
+	float32 a = b2Cross(d1, d2);
+	float32 b = b2Dot(d1, d2);
 
-		float32 L1sqr = d1.LengthSquared();
-		float32 L2sqr = d2.LengthSquared();
+	float32 angle = b2Atan2(a, b);
 
-		if (L1sqr * L2sqr == 0.0f)
+	b2Vec2 Jd1 = (-1.0f / L1sqr) * d1.Skew();
+	b2Vec2 Jd2 = (1.0f / L2sqr) * d2.Skew();
+
+	b2Vec2 J1 = -Jd1;
+	b2Vec2 J2 = Jd1 - Jd2;
+	b2Vec2 J3 = Jd2;
+
+	float32 mass = m1 * b2Dot(J1, J1) + m2 * b2Dot(J2, J2) + m3 * b2Dot(J3, J3);
+	if (mass == 0.0f)
+	{
+		return;
+	}
+
+	mass = 1.0f / mass;
+
+	float32 C = angle - m_as[i];
+
+	while (C > b2_pi)
+	{
+		angle -= 2 * b2_pi;
+		C = angle - m_as[i];
+	}
+
+	while (C < -b2_pi)
+	{
+		angle += 2.0f * b2_pi;
+		C = angle - m_as[i];
+	}
+
+	float32 impulse = - m_k3 * mass * C;
+
+	p1 += (m1 * impulse) * J1;
+	p2 += (m2 * impulse) * J2;
+	p3 += (m3 * impulse) * J3;
+
+	m_ps[i] = p1;
+	m_ps[i + 1] = p2;
+	m_ps[i + 2] = p3;
+}
+
+void b2Rope::SolveColoredC2()
+{
+	int32 count2 = m_count - 1;
+
+	for (int32 color = 0; color < 2; ++color)
+	{
+		int32 count = (count2 - color + 1) / 2;
+		if (m_scheduler != NULL && count >= m_minScheduledCount)
 		{
-			continue;
+			b2RopeColorTask task;
+			task.m_rope = this;
+			task.m_color = color;
+			task.m_stretch = true;
+			m_scheduler->Run(&task, count);
+		}
+		else
+		{
+			SolveC2Color(color, 0, count);
 		}
+	}
+}
 
-		float32 a = b2Cross(d1, d2);
-		float32 b = b2Dot(d1, d2);
+void b2Rope::SolveColoredC3()
+{
+	int32 count3 = m_count - 2;
 
-		float32 angle = b2Atan2(a, b);
+	for (int32 color = 0; color < 3; ++color)
+	{
+		int32 count = (count3 - color + 2) / 3;
+		if (m_scheduler != NULL && count >= m_minScheduledCount)
+		{
+			b2RopeColorTask task;
+			task.m_rope = this;
+			task.m_color = color;
+			task.m_stretch = false;
+			m_scheduler->Run(&task, count);
+		}
+		else
+		{
+			SolveC3Color(color, 0, count);
+		}
+	}
+}
 
-		b2Vec2 Jd1 = (-1.0f / L1sqr) * d1.Skew();
-		b2Vec2 Jd2 = (1.0f / L2sqr) * d2.Skew();
+// The segments of one color share no vertices and each one reads and writes
+// four consecutive floats, so this loop has no dependencies between iterations.
+// It is kept free of branches and square roots so the compiler can vectorize it.
+// Instead of (L0 - L) / L it uses the first order approximation
+// (L0^2 - L^2) / (L0^2 + L^2), which has the same value and slope at the rest
+// length and converges to the same solution over the iterations.
+void b2Rope::SolveC2Color(int32 color, int32 begin, int32 end)
+{
+	b2Vec2* ps = m_ps + color;
+	const float32* ims = m_ims + color;
+	const float32* Ls = m_Ls + color;
+	float32 k2 = m_k2;
 
-		b2Vec2 J1 = -Jd1;
-		b2Vec2 J2 = Jd1 - Jd2;
-		b2Vec2 J3 = Jd2;
+	for (int32 k = begin; k < end; ++k)
+	{
+		int32 i = 2 * k;
 
-		float32 mass = m1 * b2Dot(J1, J1) + m2 * b2Dot(J2, J2) + m3 * b2Dot(J3, J3);
-		if (mass == 0.0f)
+		b2Vec2 p1 = ps[i];
+		b2Vec2 p2 = ps[i + 1];
+
+		b2Vec2 d = p2 - p1;
+		float32 Lsqr = b2Dot(d, d);
+		float32 L0sqr = Ls[i] * Ls[i];
+
+		float32 im1 = ims[i];
+		float32 im2 = ims[i + 1];
+		float32 imSum = im1 + im2;
+
+		// The clamps only matter when the points coincide or both are pinned,
+		// and then the correction is zero anyway.
+		float32 C = (L0sqr - Lsqr) / b2Max(L0sqr + Lsqr, b2_epsilon);
+		float32 s = k2 * C / b2Max(imSum, b2_epsilon);
+
+		ps[i] = p1 - (s * im1) * d;
+		ps[i + 1] = p2 + (s * im2) * d;
+	}
+}
+
+void b2Rope::SolveC3Color(int32 color, int32 begin, int32 end)
+{
+	for (int32 k = begin; k < end; ++k)
+	{
+		SolveBend(color + 3 * k);
+	}
+}
+
+// Fit the segment tree to the motion of this step. The segment boxes cover
+// the segments before and after the position prediction, and are fattened
+// because the constraints move the rope further.
+void b2Rope::UpdateTree()
+{
+	int32 count2 = m_count - 1;
+	b2Vec2 r(m_radius + b2_aabbExtension, m_radius + b2_aabbExtension);
+
+	for (int32 i = 0; i < count2; ++i)
+	{
+		b2Vec2 lower = b2Min(b2Min(m_p0s[i], m_p0s[i + 1]), b2Min(m_ps[i], m_ps[i + 1]));
+		b2Vec2 upper = b2Max(b2Max(m_p0s[i], m_p0s[i + 1]), b2Max(m_ps[i], m_ps[i + 1]));
+		m_nodes[i].lowerBound = lower - r;
+		m_nodes[i].upperBound = upper + r;
+	}
+
+	m_levelOffsets[0] = 0;
+	m_levelCount = 1;
+
+	int32 count = count2;
+	int32 offset = count2;
+	while (count > 1)
+	{
+		const b2AABB* children = m_nodes + m_levelOffsets[m_levelCount - 1];
+		b2AABB* parents = m_nodes + offset;
+		int32 parentCount = (count + 1) / 2;
+
+		for (int32 i = 0; i < parentCount; ++i)
+		{
+			int32 child = 2 * i;
+			if (child + 1 < count)
+			{
+				parents[i].Combine(children[child], children[child + 1]);
+			}
+			else
+			{
+				parents[i] = children[child];
+			}
+		}
+
+		m_levelOffsets[m_levelCount] = offset;
+		++m_levelCount;
+		offset += parentCount;
+		count = parentCount;
+	}
+}
+
+// One broad-phase query with the bounds of the whole rope finds the fixtures
+// near it. The segment tree then finds the segments near each fixture.
+void b2Rope::FindContacts()
+{
+	UpdateTree();
+
+	const b2BroadPhase* broadPhase = &m_world->GetContactManager().m_broadPhase;
+
+	b2RopeQueryCallback callback;
+	callback.m_rope = this;
+	callback.m_broadPhase = broadPhase;
+
+	const b2AABB& ropeAABB = m_nodes[m_levelOffsets[m_levelCount - 1]];
+	broadPhase->Query(&callback, ropeAABB);
+}
+
+void b2Rope::CollideFixture(b2Fixture* fixture, int32 childIndex, const b2AABB& aabb)
+{
+	const b2Shape* shape = fixture->GetShape();
+	const b2Transform& xf = fixture->GetBody()->GetTransform();
+
+	// The stack holds pairs of level and index
+	b2GrowableStack<int32, 128> stack;
+	stack.Push(m_levelCount - 1);
+	stack.Push(0);
+
+	while (stack.GetCount() > 0)
+	{
+		int32 index = stack.Pop();
+		int32 level = stack.Pop();
+
+		if (b2TestOverlap(m_nodes[m_levelOffsets[level] + index], aabb) == false)
 		{
 			continue;
 		}
 
-		mass = 1.0f / mass;
+		if (level == 0)
+		{
+			if (shape->GetType() == b2Shape::e_heightfield)
+			{
+				CollideHeightfield(index, (const b2HeightfieldShape*)shape, xf);
+			}
+			else
+			{
+				CollideSegment(index, shape, childIndex, xf);
+			}
+			continue;
+		}
+
+		int32 childCount = m_levelOffsets[level] - m_levelOffsets[level - 1];
+		int32 child = 2 * index;
+
+		stack.Push(level - 1);
+		stack.Push(child);
+
+		if (child + 1 < childCount)
+		{
+			stack.Push(level - 1);
+			stack.Push(child + 1);
+		}
+	}
+}
+
+// Segment i owns the contacts of vertex i + 1, and of vertex 0 for the first
+// segment. Contacts of the segment itself are only needed when the closest
+// point is inside the segment, for example when it lies across a corner.
+void b2Rope::CollideSegment(int32 i, const b2Shape* shape, int32 childIndex, const b2Transform& xf)
+{
+	if (i == 0)
+	{
+		AddContact(m_p0s, 1, 0, 0.0f, shape, childIndex, xf);
+	}
+
+	AddContact(m_p0s + i + 1, 1, i, 1.0f, shape, childIndex, xf);
+	AddContact(m_p0s + i, 2, i, 0.0f, shape, childIndex, xf);
+}
+
+// A heightfield is one child. Collide with each of its segments under the
+// rope segment.
+void b2Rope::CollideHeightfield(int32 i, const b2HeightfieldShape* heightfield, const b2Transform& xf)
+{
+	// The segment box in the heightfield frame
+	const b2AABB& box = m_nodes[i];
+	b2Vec2 v1 = b2MulT(xf, box.lowerBound);
+	b2Vec2 v2 = b2MulT(xf, b2Vec2(box.upperBound.x, box.lowerBound.y));
+	b2Vec2 v3 = b2MulT(xf, box.upperBound);
+	b2Vec2 v4 = b2MulT(xf, b2Vec2(box.lowerBound.x, box.upperBound.y));
+	float32 lowerX = b2Min(b2Min(v1.x, v2.x), b2Min(v3.x, v4.x));
+	float32 upperX = b2Max(b2Max(v1.x, v2.x), b2Max(v3.x, v4.x));
+
+	int32 first, last;
+	if (heightfield->GetSegmentRange(lowerX, upperX, &first, &last) == false)
+	{
+		return;
+	}
+
+	for (int32 j = first; j <= last; ++j)
+	{
+		CollideSegment(i, heightfield, j, xf);
+	}
+}
+
+// Contacts are found with the rope at its position before this step, so they
+// have a valid normal even if the rope moves through the shape. Contacts that
+// are not touching yet are kept if the rope might move far enough to touch
+// the shape during this step. Besides the predicted motion this allows for
+// the motion caused by the constraints.
+void b2Rope::AddContact(const b2Vec2* vertices, int32 count, int32 i, float32 t,
+						const b2Shape* shape, int32 childIndex, const b2Transform& xf)
+{
+	b2DistanceInput input;
+	input.proxyA.Set(shape, childIndex);
+	input.proxyB.m_vertices = vertices;
+	input.proxyB.m_count = count;
+	input.proxyB.m_radius = 0.0f;
+	input.transformA = xf;
+	input.transformB.SetIdentity();
+	input.useRadii = false;
+
+	b2SimplexCache cache;
+	cache.count = 0;
+
+	b2DistanceOutput output;
+	b2Distance(&output, &cache, &input);
+
+	if (output.distance < b2_epsilon)
+	{
+		// The rope is already inside the shape and there is no normal.
+		return;
+	}
+
+	b2Vec2 p1 = m_p0s[i];
+	b2Vec2 p2 = m_p0s[i + 1];
+
+	if (count == 2)
+	{
+		b2Vec2 e = p2 - p1;
+		float32 ee = b2Dot(e, e);
+		if (ee == 0.0f)
+		{
+			return;
+		}
+
+		t = b2Dot(output.pointB - p1, e) / ee;
+		if (t <= 0.0f || t >= 1.0f)
+		{
+			// The vertex contacts cover this
+			return;
+		}
+	}
+
+	float32 motion = b2Max(b2Distance(m_ps[i], p1), b2Distance(m_ps[i + 1], p2));
+	float32 shapeRadius = input.proxyA.m_radius;
+	if (output.distance > shapeRadius + m_radius + motion + b2_aabbExtension)
+	{
+		return;
+	}
+
+	if (m_contactCount == m_contactCapacity)
+	{
+		// More contacts than def->contactCapacity, grow from the world's allocator
+		b2RopeContact* oldContacts = m_contacts;
+		int32 oldCapacity = m_contactCapacity;
+		m_contactCapacity *= 2;
+		m_contacts = (b2RopeContact*)m_allocator->Allocate(m_contactCapacity * sizeof(b2RopeContact), "b2Rope contacts");
+		memcpy(m_contacts, oldContacts, m_contactCount * sizeof(b2RopeContact));
+		m_allocator->Free(oldContacts, oldCapacity * sizeof(b2RopeContact), "b2Rope contacts");
+	}
 
-		float32 C = angle - m_as[i];
+	b2RopeContact* contact = m_contacts + m_contactCount;
+	++m_contactCount;
 
-		while (C > b2_pi)
+	b2Vec2 normal = (1.0f / output.distance) * (output.pointB - output.pointA);
+	contact->normal = normal;
+	contact->point = output.pointA + shapeRadius * normal;
+	contact->t = t;
+	contact->index = i;
+}
+
+// Push the contact points out of the fixtures. The fixtures don't move.
+void b2Rope::SolveContacts()
+{
+	for (int32 j = 0; j < m_contactCount; ++j)
+	{
+		const b2RopeContact* contact = m_contacts + j;
+		int32 i = contact->index;
+
+		float32 w1 = 1.0f - contact->t;
+		float32 w2 = contact->t;
+
+		float32 im1 = m_ims[i];
+		float32 im2 = m_ims[i + 1];
+
+		b2Vec2 p = w1 * m_ps[i] + w2 * m_ps[i + 1];
+		float32 C = b2Dot(p - contact->point, contact->normal) - m_radius;
+		if (C >= 0.0f)
 		{
-			angle -= 2 * b2_pi;
-			C = angle - m_as[i];
+			continue;
 		}
 
-		while (C < -b2_pi)
+		float32 mass = im1 * w1 * w1 + im2 * w2 * w2;
+		if (mass == 0.0f)
 		{
-			angle += 2.0f * b2_pi;
-			C = angle - m_as[i];
+			continue;
 		}
 
-		float32 impulse = - m_k3 * mass * C;
+		float32 impulse = -C / mass;
 
-		p1 += (m1 * impulse) * J1;
-		p2 += (m2 * impulse) * J2;
-		p3 += (m3 * impulse) * J3;
+		m_ps[i] += (im1 * w1 * impulse) * contact->normal;
+		m_ps[i + 1] += (im2 * w2 * impulse) * contact->normal;
+	}
+}
 
-		m_ps[i] = p1;
-		m_ps[i + 1] = p2;
-		m_ps[i + 2] = p3;
+// Remove part of the sliding motion of touching vertices so the line can
+// rest on slopes and catch on things.
+void b2Rope::ApplyFriction()
+{
+	for (int32 j = 0; j < m_contactCount; ++j)
+	{
+		const b2RopeContact* contact = m_contacts + j;
+		int32 i = contact->index;
+
+		float32 w1 = 1.0f - contact->t;
+		float32 w2 = contact->t;
+
+		b2Vec2 p = w1 * m_ps[i] + w2 * m_ps[i + 1];
+		float32 C = b2Dot(p - contact->point, contact->normal) - m_radius;
+		if (C > b2_linearSlop)
+		{
+			continue;
+		}
+
+		b2Vec2 n = contact->normal;
+
+		b2Vec2 d1 = m_ps[i] - m_p0s[i];
+		b2Vec2 d2 = m_ps[i + 1] - m_p0s[i + 1];
+		b2Vec2 t1 = d1 - b2Dot(d1, n) * n;
+		b2Vec2 t2 = d2 - b2Dot(d2, n) * n;
+
+		if (m_ims[i] > 0.0f)
+		{
+			m_ps[i] -= (m_friction * w1) * t1;
+		}
+
+		if (m_ims[i + 1] > 0.0f)
+		{
+			m_ps[i + 1] -= (m_friction * w2) * t2;
+		}
 	}
 }
 
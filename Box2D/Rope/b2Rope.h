@@ -20,8 +20,73 @@
 #define B2_ROPE_H
 
 #include <Box2D/Common/b2Math.h>
+#include <Box2D/Collision/b2Collision.h>
 
+class b2Allocator;
 class b2Draw;
+class b2World;
+class b2Fixture;
+class b2Shape;
+class b2HeightfieldShape;
+struct b2RopeContact;
+
+/// The order in which the rope constraints are solved.
+enum b2RopeOrdering
+{
+	/// Solve the constraints one after another along the rope (Gauss-Seidel).
+	b2_sequentialOrdering,
+
+	/// Solve the even stretch constraints, then the odd ones. Bending constraints
+	/// use three colors. Constraints of one color share no vertices, so a color
+	/// can be solved with SIMD lanes or split across threads.
+	b2_redBlackOrdering
+};
+
+/// A range of independent rope constraints. See b2RopeScheduler.
+class b2RopeTask
+{
+public:
+	virtual ~b2RopeTask() {}
+
+	/// Solve the constraints [begin, end) of the current color.
+	virtual void Execute(int32 begin, int32 end) = 0;
+};
+
+/// Implement this to solve long ropes across threads. Only used with
+/// b2_redBlackOrdering.
+class b2RopeScheduler
+{
+public:
+	virtual ~b2RopeScheduler() {}
+
+	/// Call task->Execute on disjoint ranges that cover [0, count). The ranges
+	/// may run in parallel. Return after all of them have finished.
+	virtual void Run(b2RopeTask* task, int32 count) = 0;
+};
+
+/// The reference scheduler. It splits each color into ranges like a threaded
+/// scheduler would, but runs them one after another on the calling thread,
+/// last range first. Since the constraints of a color are independent, a rope
+/// solved through it matches a rope solved without a scheduler exactly. Use
+/// it to check a scheduler setup before moving the ranges to other threads.
+class b2SerialRopeScheduler : public b2RopeScheduler
+{
+public:
+	/// Split colors into ranges of at most rangeSize constraints.
+	b2SerialRopeScheduler(int32 rangeSize = 64);
+
+	void Run(b2RopeTask* task, int32 count);
+
+	/// Get the number of ranges run so far.
+	int32 GetRangeCount() const
+	{
+		return m_rangeCount;
+	}
+
+private:
+	int32 m_rangeSize;
+	int32 m_rangeCount;
+};
 
 /// 
 struct b2RopeDef
@@ -30,11 +95,17 @@ struct b2RopeDef
 	{
 		vertices = NULL;
 		count = 0;
+		capacity = 0;
 		masses = NULL;
 		gravity.SetZero();
 		damping = 0.1f;
 		k2 = 0.9f;
 		k3 = 0.1f;
+		ordering = b2_sequentialOrdering;
+		world = NULL;
+		radius = 0.01f;
+		friction = 0.5f;
+		contactCapacity = 16;
 	}
 
 	///
@@ -43,6 +114,11 @@ struct b2RopeDef
 	///
 	int32 count;
 
+	/// The maximum number of vertices. Storage for this many vertices is
+	/// allocated up front so vertices can be added without reallocating.
+	/// Zero means the capacity equals count.
+	int32 capacity;
+
 	///
 	float32* masses;
 
@@ -57,6 +133,29 @@ struct b2RopeDef
 
 	/// Bending stiffness. Values above 0.5 can make the simulation blow up.
 	float32 k3;
+
+	/// Constraint solver ordering.
+	b2RopeOrdering ordering;
+
+	/// The rope collides with the fixtures of this world. Each segment is a
+	/// capsule. The fixtures are not pushed back by the rope. NULL disables
+	/// collision.
+	const b2World* world;
+
+	/// The radius of the segment capsules.
+	float32 radius;
+
+	/// The fraction of sliding motion removed from vertices that touch a
+	/// fixture, usually in the range [0,1].
+	float32 friction;
+
+	/// Contact filtering data, the same as for fixtures. Sensors are ignored.
+	b2Filter filter;
+
+	/// Storage for this many contacts is allocated up front from the world's
+	/// allocator. A step that finds more grows it, so size it for the most
+	/// contacts expected, e.g. one per vertex for a rope lying on the ground.
+	int32 contactCapacity;
 };
 
 /// 
@@ -66,6 +165,13 @@ public:
 	b2Rope();
 	~b2Rope();
 
+	/// Get the number of contacts between the rope and the world found in
+	/// the last step.
+	int32 GetContactCount() const
+	{
+		return m_contactCount;
+	}
+
 	///
 	void Initialize(const b2RopeDef* def);
 
@@ -84,6 +190,48 @@ public:
 		return m_ps;
 	}
 
+	///
+	const b2Vec2* GetVelocities() const
+	{
+		return m_vs;
+	}
+
+	/// Get the maximum number of vertices.
+	int32 GetCapacity() const
+	{
+		return m_capacity;
+	}
+
+	/// Move a vertex and clear its velocity. Use this to drive vertices
+	/// that are attached to something else.
+	void SetVertex(int32 index, const b2Vec2& position);
+
+	/// Set the mass of a vertex. A zero mass pins the vertex in place.
+	void SetMass(int32 index, float32 mass);
+
+	/// Set/Get the rest length of the segment between vertex index and index + 1.
+	void SetRestLength(int32 index, float32 length);
+	float32 GetRestLength(int32 index) const;
+
+	/// Append a vertex to the end of the rope. The new segment is straight
+	/// with respect to bending. This does not allocate memory.
+	/// @return false if the rope is at capacity.
+	bool AddVertex(const b2Vec2& position, float32 mass, float32 restLength);
+
+	/// Remove the last vertex of the rope. A rope keeps at least two vertices.
+	void RemoveVertex();
+
+	/// Set the constraint solver ordering.
+	void SetOrdering(b2RopeOrdering ordering)
+	{
+		m_ordering = ordering;
+	}
+
+	/// Solve colors with at least minCount constraints through the scheduler.
+	/// Smaller colors are solved on the calling thread. Pass NULL to stop
+	/// using the scheduler.
+	void SetScheduler(b2RopeScheduler* scheduler, int32 minCount);
+
 	///
 	void Draw(b2Draw* draw) const;
 
@@ -92,10 +240,32 @@ public:
 
 private:
 
+	friend class b2RopeColorTask;
+	friend class b2RopeQueryCallback;
+
 	void SolveC2();
 	void SolveC3();
 
+	// Red-black ordering. Constraint k of a color is constraint color + stride * k.
+	void SolveColoredC2();
+	void SolveColoredC3();
+	void SolveC2Color(int32 color, int32 begin, int32 end);
+	void SolveC3Color(int32 color, int32 begin, int32 end);
+	void SolveBend(int32 i);
+
+	// Collision with the world
+	void UpdateTree();
+	void FindContacts();
+	void CollideFixture(b2Fixture* fixture, int32 childIndex, const b2AABB& aabb);
+	void CollideSegment(int32 i, const b2Shape* shape, int32 childIndex, const b2Transform& xf);
+	void CollideHeightfield(int32 i, const b2HeightfieldShape* heightfield, const b2Transform& xf);
+	void AddContact(const b2Vec2* vertices, int32 count, int32 i, float32 t,
+					const b2Shape* shape, int32 childIndex, const b2Transform& xf);
+	void SolveContacts();
+	void ApplyFriction();
+
 	int32 m_count;
+	int32 m_capacity;
 	b2Vec2* m_ps;
 	b2Vec2* m_p0s;
 	b2Vec2* m_vs;
@@ -110,6 +280,26 @@ private:
 
 	float32 m_k2;
 	float32 m_k3;
+
+	b2RopeOrdering m_ordering;
+	b2RopeScheduler* m_scheduler;
+	int32 m_minScheduledCount;
+
+	const b2World* m_world;
+	float32 m_radius;
+	float32 m_friction;
+	b2Filter m_filter;
+
+	// Implicit AABB tree over the segments. Level 0 holds one box per segment,
+	// each level above holds one box per pair of boxes below it.
+	b2AABB* m_nodes;
+	int32 m_levelOffsets[32];
+	int32 m_levelCount;
+
+	b2Allocator* m_allocator;
+	b2RopeContact* m_contacts;
+	int32 m_contactCount;
+	int32 m_contactCapacity;
 };
 
 #endif
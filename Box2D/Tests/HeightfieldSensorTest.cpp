@@ -0,0 +1,148 @@
+/*
+* Copyright (c) 2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Box2D.h>
+
+#include <stdio.h>
+
+// Sensors over a heightfield must test the segments under them, not only the
+// first one. The lake bed is flat at height 0 except for a bump around
+// segment 20, and sensors are placed over segments far from segment 0.
+
+static int32 s_failCount = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if ((condition) == false && s_failCount++ < 10) \
+		{ \
+			printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+		} \
+	} while (0)
+
+static b2Body* CreateSensor(b2World* world, const b2Vec2& position)
+{
+	b2BodyDef bd;
+	bd.type = b2_dynamicBody;
+	bd.gravityScale = 0.0f;
+	bd.position = position;
+	b2Body* body = world->CreateBody(&bd);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.4f, 0.4f);
+	b2FixtureDef fd;
+	fd.shape = &box;
+	fd.density = 1.0f;
+	fd.isSensor = true;
+	body->CreateFixture(&fd);
+	return body;
+}
+
+static bool IsTouching(const b2Body* body)
+{
+	for (const b2ContactEdge* ce = body->GetContactList(); ce; ce = ce->next)
+	{
+		if (ce->contact->IsTouching())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+int main(int argc, char** argv)
+{
+	B2_NOT_USED(argc);
+	B2_NOT_USED(argv);
+
+	// Samples at x = 0, 1, ..., 39. Segment k spans [k, k + 1].
+	const int32 count = 40;
+	float32 heights[count];
+	for (int32 i = 0; i < count; ++i)
+	{
+		heights[i] = 0.0f;
+	}
+	heights[20] = 2.0f;
+
+	b2HeightfieldShape bed;
+	bed.Create(heights, count, 0.0f, 1.0f);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.4f, 0.4f);
+
+	b2Transform identity;
+	identity.SetIdentity();
+
+	// Direct tests, the heightfield child index is always 0.
+	for (int32 k = 1; k < count - 1; ++k)
+	{
+		if (k == 19 || k == 20)
+		{
+			continue;
+		}
+
+		b2Transform inside(b2Vec2(k + 0.5f, 0.2f), b2Rot(0.0f));
+		b2Transform above(b2Vec2(k + 0.5f, 0.6f), b2Rot(0.0f));
+		CHECK(b2TestOverlap(&bed, 0, &box, 0, identity, inside));
+		CHECK(b2TestOverlap(&box, 0, &bed, 0, inside, identity));
+		CHECK(b2TestOverlap(&bed, 0, &box, 0, identity, above) == false);
+	}
+
+	// Over the bump the box overlaps the slope of segments 19 and 20 only.
+	CHECK(b2TestOverlap(&bed, 0, &box, 0, identity, b2Transform(b2Vec2(20.0f, 1.7f), b2Rot(0.0f))));
+	CHECK(b2TestOverlap(&bed, 0, &box, 0, identity, b2Transform(b2Vec2(20.0f, 2.6f), b2Rot(0.0f))) == false);
+
+	// Sensor contacts in a world.
+	b2World world(b2Vec2(0.0f, -10.0f));
+	world.SetSensorEventsEnabled(true);
+
+	b2BodyDef bd;
+	b2Body* ground = world.CreateBody(&bd);
+	b2Fixture* bedFixture = ground->CreateFixture(&bed, 0.0f);
+
+	b2Body* buried = CreateSensor(&world, b2Vec2(12.5f, 0.2f));
+	b2Body* hovering = CreateSensor(&world, b2Vec2(30.5f, 0.6f));
+	b2Body* onBump = CreateSensor(&world, b2Vec2(20.0f, 1.7f));
+
+	world.Step(1.0f / 60.0f, 8, 3);
+
+	CHECK(IsTouching(buried));
+	CHECK(IsTouching(hovering) == false);
+	CHECK(IsTouching(onBump));
+
+	int32 beginCount = 0;
+	for (int32 i = 0; i < world.GetSensorEventCount(); ++i)
+	{
+		const b2SensorEvent& event = world.GetSensorEvents()[i];
+		CHECK(event.begin);
+		CHECK(event.visitorFixture == bedFixture);
+		++beginCount;
+	}
+	CHECK(beginCount == 2);
+	world.ClearSensorEvents();
+
+	// Lift the buried sensor clear of the bed.
+	buried->SetTransform(b2Vec2(12.5f, 0.6f), 0.0f);
+	world.Step(1.0f / 60.0f, 8, 3);
+	CHECK(IsTouching(buried) == false);
+	CHECK(world.GetSensorEventCount() == 1 && world.GetSensorEvents()[0].begin == false);
+
+	printf("failed checks %d\n", s_failCount);
+
+	return s_failCount == 0 ? 0 : 1;
+}
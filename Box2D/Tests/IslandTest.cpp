@@ -0,0 +1,331 @@
+/*
+* Copyright (c) 2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+// The invariants live in private members of the world.
+#define private public
+#define protected public
+#include <Box2D/Box2D.h>
+#undef private
+#undef protected
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+
+// Randomly creates and destroys bodies and joints, toggles activity, body
+// types, sleep and sensors, and checks after every step that the persistent
+// islands of b2IslandManager agree with the contact and joint graph:
+// - bodies joined by a touching contact or a joint share an island
+// - each island is awake exactly when its bodies are awake
+// - the island body lists and the awake island list are consistent
+// The contact manager's slot array and pair table are checked as well.
+// A fixed case checks that SetAwake on one body sleeps and wakes its island.
+// Build with -fsanitize=address,undefined to catch stale island nodes.
+//
+// usage: Box2DIslandTest [seed]
+
+static int32 s_failCount = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if ((condition) == false && s_failCount++ < 10) \
+		{ \
+			printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+		} \
+	} while (0)
+
+static float32 RandomFloat(float32 lo, float32 hi)
+{
+	return lo + (hi - lo) * float32(rand()) / float32(RAND_MAX);
+}
+
+static void CheckContacts(b2World* world)
+{
+	b2ContactManager& cm = world->m_contactManager;
+
+	CHECK(cm.m_pairTable.GetCount() == cm.m_contactCount);
+	for (int32 i = 0; i < b2_contactBatchCount; ++i)
+	{
+		CHECK(cm.m_batchStart[i] <= cm.m_batchStart[i + 1]);
+	}
+	CHECK(cm.m_batchStart[b2_contactBatchCount] <= cm.m_slotCount);
+	CHECK(cm.m_slotCount <= cm.m_contactCapacity);
+
+	int32 slotted = 0;
+	for (int32 i = 0; i < cm.m_slotCount; ++i)
+	{
+		if (cm.m_contacts[i])
+		{
+			++slotted;
+			CHECK(cm.m_contacts[i]->m_managerIndex == i);
+		}
+	}
+	CHECK(slotted == cm.m_contactCount);
+
+	int32 listed = 0;
+	for (b2Contact* c = cm.m_contactList; c; c = c->m_next)
+	{
+		++listed;
+		int32 index = c->m_managerIndex;
+		CHECK(0 <= index && index < cm.m_slotCount && cm.m_contacts[index] == c);
+
+		int32 batch = b2ContactManager::GetBatch(c);
+		if (index < cm.m_batchStart[b2_contactBatchCount])
+		{
+			CHECK(cm.m_batchStart[batch] <= index && index < cm.m_batchStart[batch + 1]);
+		}
+
+		CHECK(cm.m_pairTable.Find(c->m_proxyIdB, c->m_proxyIdA) == c);
+	}
+	CHECK(listed == cm.m_contactCount);
+}
+
+static void CheckIslands(b2World* world)
+{
+	b2IslandManager& im = world->m_islandManager;
+
+	for (b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		if (b->GetType() == b2_staticBody || b->IsActive() == false)
+		{
+			CHECK(b->m_islandId == b2_nullIsland);
+			continue;
+		}
+
+		CHECK(b->m_islandId != b2_nullIsland);
+		if (b->m_islandId == b2_nullIsland)
+		{
+			continue;
+		}
+
+		int32 root = im.Find(b->m_islandId);
+		bool islandAwake = im.m_islands[root].awakeIndex != b2_nullIsland;
+		CHECK(islandAwake == b->IsAwake());
+
+		for (b2ContactEdge* ce = b->GetContactList(); ce; ce = ce->next)
+		{
+			b2Contact* c = ce->contact;
+			if (c->IsTouching() == false || c->GetFixtureA()->IsSensor() || c->GetFixtureB()->IsSensor())
+			{
+				continue;
+			}
+
+			if (ce->other->GetType() != b2_staticBody)
+			{
+				CHECK(im.Find(ce->other->m_islandId) == root);
+			}
+		}
+
+		for (b2JointEdge* je = b->GetJointList(); je; je = je->next)
+		{
+			b2Body* other = je->other;
+			if (other->GetType() != b2_staticBody && other->IsActive())
+			{
+				CHECK(im.Find(other->m_islandId) == root);
+			}
+		}
+
+		bool found = false;
+		for (b2Body* x = im.m_islands[b->m_islandId].bodyList; x; x = x->m_islandNext)
+		{
+			if (x == b)
+			{
+				found = true;
+				break;
+			}
+		}
+		CHECK(found);
+	}
+
+	for (int32 i = 0; i < im.m_awakeCount; ++i)
+	{
+		int32 islandId = im.m_awakeIslands[i];
+		CHECK(im.m_islands[islandId].awakeIndex == i);
+
+		int32 count = 0;
+		for (b2Body* x = im.m_islands[islandId].bodyList; x; x = x->m_islandNext)
+		{
+			++count;
+			CHECK(x->m_islandId == islandId);
+		}
+		CHECK(count == im.m_islands[islandId].bodyCount);
+	}
+}
+
+static b2Body* CreateBox(b2World* world, const b2Vec2& position)
+{
+	b2BodyDef bd;
+	bd.type = b2_dynamicBody;
+	bd.position = position;
+	b2Body* body = world->CreateBody(&bd);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+	body->CreateFixture(&box, 1.0f);
+	return body;
+}
+
+// SetAwake(false) on one body of a two body island puts both to sleep,
+// SetAwake(true) on the other wakes both. A body outside the island is
+// not affected.
+static void TestSetAwake()
+{
+	b2World world(b2Vec2(0.0f, 0.0f));
+
+	b2Body* bodyA = CreateBox(&world, b2Vec2(0.0f, 0.0f));
+	b2Body* bodyB = CreateBox(&world, b2Vec2(3.0f, 0.0f));
+	b2Body* loner = CreateBox(&world, b2Vec2(20.0f, 0.0f));
+
+	b2DistanceJointDef jd;
+	jd.Initialize(bodyA, bodyB, bodyA->GetPosition(), bodyB->GetPosition());
+	world.CreateJoint(&jd);
+
+	bodyA->SetLinearVelocity(b2Vec2(1.0f, 0.0f));
+	bodyB->SetLinearVelocity(b2Vec2(1.0f, 0.0f));
+	loner->SetLinearVelocity(b2Vec2(0.0f, 1.0f));
+	world.Step(1.0f / 60.0f, 8, 3);
+
+	CHECK(bodyA->IsAwake() && bodyB->IsAwake());
+	CHECK(world.m_islandManager.Find(bodyA->m_islandId) == world.m_islandManager.Find(bodyB->m_islandId));
+
+	bodyA->SetAwake(false);
+	CHECK(bodyA->IsAwake() == false);
+	CHECK(bodyB->IsAwake() == false);
+	CHECK(bodyB->GetLinearVelocity() == b2Vec2(0.0f, 0.0f));
+	CHECK(loner->IsAwake());
+
+	b2Vec2 positionB = bodyB->GetPosition();
+	for (int32 i = 0; i < 10; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+	CHECK(bodyA->IsAwake() == false && bodyB->IsAwake() == false);
+	CHECK(bodyB->GetPosition() == positionB);
+	CheckIslands(&world);
+
+	bodyB->SetAwake(true);
+	CHECK(bodyA->IsAwake() && bodyB->IsAwake());
+	world.Step(1.0f / 60.0f, 8, 3);
+	CheckIslands(&world);
+}
+
+int main(int argc, char** argv)
+{
+	TestSetAwake();
+
+	srand(argc > 1 ? atoi(argv[1]) : 7);
+
+	b2World world(b2Vec2(0.0f, -10.0f));
+
+	b2BodyDef groundDef;
+	b2Body* ground = world.CreateBody(&groundDef);
+	b2EdgeShape edge;
+	edge.Set(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	std::vector<b2Body*> bodies;
+	std::vector<b2Joint*> joints;
+
+	const int32 stepCount = 4000;
+	for (int32 step = 0; step < stepCount; ++step)
+	{
+		int32 op = rand() % 100;
+		if (op < 6 && bodies.size() < 200)
+		{
+			b2BodyDef bd;
+			bd.type = rand() % 10 == 0 ? b2_kinematicBody : b2_dynamicBody;
+			bd.awake = rand() % 4 != 0;
+			bd.position.Set(RandomFloat(-30.0f, 30.0f), RandomFloat(1.0f, 11.0f));
+			if (bd.type == b2_kinematicBody)
+			{
+				bd.linearVelocity.Set(float32(rand() % 3 - 1), 0.0f);
+			}
+
+			b2Body* body = world.CreateBody(&bd);
+			b2PolygonShape box;
+			box.SetAsBox(0.5f, 0.5f);
+			b2FixtureDef fd;
+			fd.shape = &box;
+			fd.density = 1.0f;
+			fd.isSensor = rand() % 15 == 0;
+			body->CreateFixture(&fd);
+			bodies.push_back(body);
+		}
+		else if (op < 8 && bodies.empty() == false)
+		{
+			int32 index = rand() % bodies.size();
+			b2Body* body = bodies[index];
+			for (b2JointEdge* je = body->GetJointList(); je; je = je->next)
+			{
+				joints.erase(std::remove(joints.begin(), joints.end(), je->joint), joints.end());
+			}
+			world.DestroyBody(body);
+			bodies.erase(bodies.begin() + index);
+		}
+		else if (op < 11 && bodies.size() > 1)
+		{
+			b2Body* bodyA = bodies[rand() % bodies.size()];
+			b2Body* bodyB = bodies[rand() % bodies.size()];
+			if (bodyA != bodyB)
+			{
+				b2DistanceJointDef jd;
+				jd.Initialize(bodyA, bodyB, bodyA->GetPosition(), bodyB->GetPosition());
+				joints.push_back(world.CreateJoint(&jd));
+			}
+		}
+		else if (op < 13 && joints.empty() == false)
+		{
+			int32 index = rand() % joints.size();
+			world.DestroyJoint(joints[index]);
+			joints.erase(joints.begin() + index);
+		}
+		else if (op < 14 && bodies.empty() == false)
+		{
+			b2Body* body = bodies[rand() % bodies.size()];
+			body->SetActive(!body->IsActive());
+		}
+		else if (op < 15 && bodies.empty() == false)
+		{
+			b2Body* body = bodies[rand() % bodies.size()];
+			body->SetType(b2BodyType(rand() % 3));
+		}
+		else if (op < 16 && bodies.empty() == false)
+		{
+			// Puts the whole island to sleep or wakes it.
+			b2Body* body = bodies[rand() % bodies.size()];
+			body->SetAwake(rand() % 2 == 0);
+		}
+		else if (op < 17 && bodies.empty() == false)
+		{
+			b2Fixture* fixture = bodies[rand() % bodies.size()]->GetFixtureList();
+			fixture->SetSensor(!fixture->IsSensor());
+		}
+
+		world.Step(1.0f / 60.0f, 8, 3);
+		CheckContacts(&world);
+		CheckIslands(&world);
+	}
+
+	printf("bodies %d joints %d islands %d awake islands %d failed checks %d\n",
+		int32(bodies.size()), int32(joints.size()), world.m_islandManager.m_islandCount,
+		world.m_islandManager.m_awakeCount, s_failCount);
+
+	return s_failCount == 0 ? 0 : 1;
+}
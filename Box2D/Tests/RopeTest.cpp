@@ -0,0 +1,150 @@
+/*
+* Copyright (c) 2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Box2D.h>
+#include <Box2D/Rope/b2Rope.h>
+
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+// Steps the same red-black rope three times: without a scheduler, through
+// b2SerialRopeScheduler and through a scheduler that runs the ranges on
+// threads. The constraints of a color share no vertices, so all three must
+// end with exactly the same vertices. A sequential rope is stepped as well,
+// both orderings must keep the rope at its rest length.
+
+static int32 s_failCount = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if ((condition) == false && s_failCount++ < 10) \
+		{ \
+			printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+		} \
+	} while (0)
+
+// Runs a color in ranges of rangeSize on a thread each.
+class ThreadRopeScheduler : public b2RopeScheduler
+{
+public:
+	ThreadRopeScheduler(int32 rangeSize) : m_rangeSize(rangeSize) {}
+
+	void Run(b2RopeTask* task, int32 count)
+	{
+		std::vector<std::thread> threads;
+		for (int32 begin = 0; begin < count; begin += m_rangeSize)
+		{
+			int32 end = b2Min(begin + m_rangeSize, count);
+			threads.push_back(std::thread([task, begin, end]() { task->Execute(begin, end); }));
+		}
+
+		for (size_t i = 0; i < threads.size(); ++i)
+		{
+			threads[i].join();
+		}
+	}
+
+private:
+	int32 m_rangeSize;
+};
+
+static void InitializeRope(b2Rope* rope, b2RopeOrdering ordering)
+{
+	const int32 count = 101;
+	b2Vec2 vertices[count];
+	float32 masses[count];
+	for (int32 i = 0; i < count; ++i)
+	{
+		vertices[i].Set(0.25f * i, 0.0f);
+		masses[i] = 1.0f;
+	}
+	masses[0] = 0.0f;
+
+	b2RopeDef def;
+	def.vertices = vertices;
+	def.masses = masses;
+	def.count = count;
+	def.gravity.Set(0.0f, -10.0f);
+	def.k2 = 1.0f;
+	def.k3 = 0.5f;
+	def.ordering = ordering;
+	rope->Initialize(&def);
+}
+
+static float32 RopeLength(const b2Rope& rope)
+{
+	const b2Vec2* ps = rope.GetVertices();
+	float32 length = 0.0f;
+	for (int32 i = 0; i < rope.GetVertexCount() - 1; ++i)
+	{
+		length += b2Distance(ps[i], ps[i + 1]);
+	}
+	return length;
+}
+
+int main(int argc, char** argv)
+{
+	B2_NOT_USED(argc);
+	B2_NOT_USED(argv);
+
+	b2Rope plain;
+	b2Rope serial;
+	b2Rope threaded;
+	b2Rope sequential;
+	InitializeRope(&plain, b2_redBlackOrdering);
+	InitializeRope(&serial, b2_redBlackOrdering);
+	InitializeRope(&threaded, b2_redBlackOrdering);
+	InitializeRope(&sequential, b2_sequentialOrdering);
+
+	b2SerialRopeScheduler serialScheduler(7);
+	ThreadRopeScheduler threadScheduler(13);
+	serial.SetScheduler(&serialScheduler, 1);
+	threaded.SetScheduler(&threadScheduler, 1);
+
+	const int32 stepCount = 300;
+	const float32 timeStep = 1.0f / 60.0f;
+	for (int32 i = 0; i < stepCount; ++i)
+	{
+		plain.Step(timeStep, 8);
+		serial.Step(timeStep, 8);
+		threaded.Step(timeStep, 8);
+		sequential.Step(timeStep, 8);
+	}
+
+	CHECK(serialScheduler.GetRangeCount() > 0);
+
+	const b2Vec2* ps = plain.GetVertices();
+	for (int32 i = 0; i < plain.GetVertexCount(); ++i)
+	{
+		CHECK(serial.GetVertices()[i] == ps[i]);
+		CHECK(threaded.GetVertices()[i] == ps[i]);
+	}
+
+	// Both orderings hold the rope at its rest length of 25.
+	float32 redBlackLength = RopeLength(plain);
+	float32 sequentialLength = RopeLength(sequential);
+	CHECK(b2Abs(redBlackLength - 25.0f) < 0.25f);
+	CHECK(b2Abs(sequentialLength - 25.0f) < 0.25f);
+
+	printf("serial ranges %d, length red-black %g sequential %g, failed checks %d\n",
+		serialScheduler.GetRangeCount(), redBlackLength, sequentialLength, s_failCount);
+
+	return s_failCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/*
+* Copyright (c) 2011 Erin Catto http://www.box2d.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Box2D.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+// Moves random polygon pairs past each other and collides them twice per
+// frame: once with a b2SATCache that is kept for the whole pair, once
+// without a cache. The cached separating axis may only let the collision
+// return early, so both manifolds must be the same.
+//
+// usage: Box2DSATCacheTest [seed]
+
+static int32 s_failCount = 0;
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if ((condition) == false && s_failCount++ < 10) \
+		{ \
+			printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+		} \
+	} while (0)
+
+static float32 RandomFloat(float32 lo, float32 hi)
+{
+	return lo + (hi - lo) * float32(rand()) / float32(RAND_MAX);
+}
+
+static b2PolygonShape RandomPolygon()
+{
+	b2PolygonShape polygon;
+	if (rand() % 3 == 0)
+	{
+		polygon.SetAsBox(RandomFloat(0.1f, 1.0f), RandomFloat(0.1f, 1.0f));
+		return polygon;
+	}
+
+	int32 count = 3 + rand() % (b2_maxPolygonVertices - 2);
+	b2Vec2 vertices[b2_maxPolygonVertices];
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 angle = 2.0f * b2_pi * i / count + RandomFloat(0.0f, 0.3f);
+		float32 radius = RandomFloat(0.3f, 1.2f);
+		vertices[i].Set(radius * cosf(angle), radius * sinf(angle));
+	}
+	polygon.Set(vertices, count);
+	return polygon;
+}
+
+int main(int argc, char** argv)
+{
+	srand(argc > 1 ? atoi(argv[1]) : 5);
+
+	const int32 pairCount = 2000;
+	const int32 frameCount = 100;
+	int32 separatedCount = 0;
+	int32 cacheHitCount = 0;
+
+	for (int32 pair = 0; pair < pairCount; ++pair)
+	{
+		b2PolygonShape polygonA = RandomPolygon();
+		b2PolygonShape polygonB = RandomPolygon();
+
+		b2SATCache cache;
+		cache.type = b2SATCache::e_empty;
+		cache.index = 0;
+
+		b2Vec2 positionA(RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f));
+		b2Vec2 positionB(RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f));
+		float32 angleA = RandomFloat(-3.0f, 3.0f);
+		float32 angleB = RandomFloat(-3.0f, 3.0f);
+		b2Vec2 velocity(0.0f, 0.0f);
+		float32 angularVelocity = RandomFloat(-0.05f, 0.05f);
+
+		for (int32 frame = 0; frame < frameCount; ++frame)
+		{
+			// Shape A drifts through B and changes course every 25 frames.
+			if (frame % 25 == 0)
+			{
+				velocity.Set(RandomFloat(-0.05f, 0.05f), RandomFloat(-0.05f, 0.05f));
+			}
+			positionA += velocity;
+			angleA += angularVelocity;
+
+			b2Transform xfA(positionA, b2Rot(angleA));
+			b2Transform xfB(positionB, b2Rot(angleB));
+
+			bool hadAxis = cache.type != b2SATCache::e_empty;
+
+			b2Manifold cached;
+			b2CollidePolygons(&cached, &polygonA, xfA, &polygonB, xfB, &cache);
+
+			b2Manifold uncached;
+			b2CollidePolygons(&uncached, &polygonA, xfA, &polygonB, xfB);
+
+			if (uncached.pointCount == 0)
+			{
+				++separatedCount;
+				if (hadAxis && cache.type != b2SATCache::e_empty)
+				{
+					++cacheHitCount;
+				}
+			}
+
+			CHECK(cached.pointCount == uncached.pointCount);
+			if (cached.pointCount != uncached.pointCount || cached.pointCount == 0)
+			{
+				continue;
+			}
+
+			CHECK(cached.type == uncached.type);
+			CHECK(cached.localNormal == uncached.localNormal);
+			CHECK(cached.localPoint == uncached.localPoint);
+			for (int32 i = 0; i < cached.pointCount; ++i)
+			{
+				CHECK(cached.points[i].localPoint == uncached.points[i].localPoint);
+				CHECK(cached.points[i].id.key == uncached.points[i].id.key);
+			}
+		}
+	}
+
+	printf("frames %d separated %d with a cached axis %d failed checks %d\n",
+		pairCount * frameCount, separatedCount, cacheHitCount, s_failCount);
+
+	return s_failCount == 0 ? 0 : 1;
+}
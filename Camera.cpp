@@ -0,0 +1,81 @@
+#include "Camera.h"
+#include <algorithm>
+
+namespace {
+
+const float minZoom = 5.0f;  // Pixels per meter
+const float maxZoom = 120.0f;
+
+// The target may move this fraction of the half view away from the center
+// before the camera follows
+const float followMargin = 0.6f;
+
+}
+
+Camera::Camera()
+    : center(0.0f, 0.0f),
+    zoom(30.0f),  // 1 meter = 30 pixels
+    width(0),
+    height(0),
+    following(true) {
+}
+
+void Camera::setViewport(int width, int height) {
+    b2Vec2 bottomLeft = toWorld(QPointF(0.0, this->height));
+    this->width = width;
+    this->height = height;
+    center = bottomLeft + b2Vec2(0.5f * width / zoom, 0.5f * height / zoom);
+}
+
+void Camera::setZoom(float zoom) {
+    this->zoom = std::min(std::max(zoom, minZoom), maxZoom);
+}
+
+void Camera::pan(const QPointF& delta) {
+    // Dragging to the right moves the world to the right, so the view to the left
+    center.x -= delta.x() / zoom;
+    center.y += delta.y() / zoom;
+}
+
+void Camera::zoomAt(const QPointF& screenPoint, float factor) {
+    b2Vec2 anchor = toWorld(screenPoint);
+    setZoom(zoom * factor);
+    center += anchor - toWorld(screenPoint);
+}
+
+bool Camera::follow(const b2Vec2& target) {
+    b2Vec2 limit(followMargin * 0.5f * width / zoom, followMargin * 0.5f * height / zoom);
+    b2Vec2 offset = target - center;
+    b2Vec2 clamped = b2Clamp(offset, -limit, limit);
+    if (clamped.x == offset.x && clamped.y == offset.y) {
+        return false;
+    }
+    center += offset - clamped;
+    return true;
+}
+
+QPointF Camera::toScreen(const b2Vec2& point) const {
+    return QPointF(0.5f * width + (point.x - center.x) * zoom,
+                   0.5f * height - (point.y - center.y) * zoom);
+}
+
+b2Vec2 Camera::toWorld(const QPointF& point) const {
+    return b2Vec2(center.x + (point.x() - 0.5f * width) / zoom,
+                  center.y - (point.y() - 0.5f * height) / zoom);
+}
+
+b2AABB Camera::getViewBounds() const {
+    b2Vec2 halfExtents(0.5f * width / zoom, 0.5f * height / zoom);
+    b2AABB bounds;
+    bounds.lowerBound = center - halfExtents;
+    bounds.upperBound = center + halfExtents;
+    return bounds;
+}
+
+QTransform Camera::getTransform() const {
+    QTransform transform;
+    transform.translate(0.5 * width, 0.5 * height);
+    transform.scale(zoom, -zoom);
+    transform.translate(-center.x, -center.y);
+    return transform;
+}
@@ -0,0 +1,61 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <Box2D/Box2D.h>
+#include <QPointF>
+#include <QTransform>
+
+// The view of the lake: which part of the world is on screen and how large.
+//
+// All conversions between meters and widget pixels go through here. Y points
+// up in the world and down on screen. The camera looks at center from zoom
+// pixels per meter. It can be panned and zoomed, and can follow a target: the
+// target may move freely in the middle of the view, the camera only moves
+// when the target would leave it, so a lure resting in view never forces the
+// whole widget to be repainted.
+class Camera {
+public:
+    Camera();
+
+    // Size of the widget in pixels. The world point at the bottom left corner
+    // stays in place, so resizing the window shows more or less of the lake.
+    void setViewport(int width, int height);
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    void setCenter(const b2Vec2& center) { this->center = center; }
+    const b2Vec2& getCenter() const { return center; }
+
+    // Pixels per meter, clamped to a sensible range
+    void setZoom(float zoom);
+    float getZoom() const { return zoom; }
+
+    // Move the view along with a mouse drag of delta pixels
+    void pan(const QPointF& delta);
+
+    // Zoom by factor, keeping the world point under screenPoint in place
+    void zoomAt(const QPointF& screenPoint, float factor);
+
+    // Keep target in the middle part of the view. Returns true if the camera moved.
+    bool follow(const b2Vec2& target);
+    void setFollowing(bool flag) { following = flag; }
+    bool isFollowing() const { return following; }
+
+    QPointF toScreen(const b2Vec2& point) const;
+    b2Vec2 toWorld(const QPointF& point) const;
+
+    // The part of the world on screen
+    b2AABB getViewBounds() const;
+
+    // Meters to pixels, for QPainter
+    QTransform getTransform() const;
+
+private:
+    b2Vec2 center;  // World point in the middle of the view
+    float zoom;  // Pixels per meter
+    int width;  // Viewport in pixels
+    int height;
+    bool following;
+};
+
+#endif // CAMERA_H
@@ -0,0 +1,135 @@
+#include "DebugDraw.h"
+#include <QPainter>
+#include <QPen>
+#include <QBrush>
+#include <QColor>
+#include <QTransform>
+
+DebugDraw::DebugDraw()
+    : lastBatch(-1),
+    drawCallCount(0) {
+}
+
+DebugDraw::Batch& DebugDraw::batchFor(const b2Color& color) {
+    unsigned int rgb = (static_cast<unsigned int>(b2Clamp(color.r, 0.0f, 1.0f) * 255.0f) << 16) |
+                       (static_cast<unsigned int>(b2Clamp(color.g, 0.0f, 1.0f) * 255.0f) << 8) |
+                       static_cast<unsigned int>(b2Clamp(color.b, 0.0f, 1.0f) * 255.0f);
+
+    if (lastBatch >= 0 && batches[lastBatch].rgb == rgb) {
+        return batches[lastBatch];
+    }
+
+    for (size_t i = 0; i < batches.size(); ++i) {
+        if (batches[i].rgb == rgb) {
+            lastBatch = static_cast<int>(i);
+            return batches[i];
+        }
+    }
+
+    // Batches of colors that stop being used stay around empty and cost nothing to flush
+    batches.emplace_back();
+    batches.back().rgb = rgb;
+
+    // Box2D polygons are counter-clockwise like Qt's ellipses, so with the
+    // winding rule overlapping fills of one color don't cancel out
+    batches.back().fills.setFillRule(Qt::WindingFill);
+    lastBatch = static_cast<int>(batches.size()) - 1;
+    return batches.back();
+}
+
+void DebugDraw::addOutline(Batch& batch, const b2Vec2* vertices, int32 vertexCount) {
+    b2Vec2 previous = vertices[vertexCount - 1];
+    for (int32 i = 0; i < vertexCount; ++i) {
+        batch.lines.push_back(QPointF(previous.x, previous.y));
+        batch.lines.push_back(QPointF(vertices[i].x, vertices[i].y));
+        previous = vertices[i];
+    }
+}
+
+void DebugDraw::DrawPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color) {
+    addOutline(batchFor(color), vertices, vertexCount);
+}
+
+void DebugDraw::DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color) {
+    Batch& batch = batchFor(color);
+    batch.fills.moveTo(vertices[0].x, vertices[0].y);
+    for (int32 i = 1; i < vertexCount; ++i) {
+        batch.fills.lineTo(vertices[i].x, vertices[i].y);
+    }
+    batch.fills.closeSubpath();
+    addOutline(batch, vertices, vertexCount);
+}
+
+void DebugDraw::DrawCircle(const b2Vec2& center, float32 radius, const b2Color& color) {
+    batchFor(color).circles.addEllipse(QPointF(center.x, center.y), radius, radius);
+}
+
+void DebugDraw::DrawSolidCircle(const b2Vec2& center, float32 radius, const b2Vec2& axis, const b2Color& color) {
+    Batch& batch = batchFor(color);
+    batch.fills.addEllipse(QPointF(center.x, center.y), radius, radius);
+    batch.circles.addEllipse(QPointF(center.x, center.y), radius, radius);
+
+    // The axis shows the rotation of the body
+    b2Vec2 p = center + radius * axis;
+    batch.lines.push_back(QPointF(center.x, center.y));
+    batch.lines.push_back(QPointF(p.x, p.y));
+}
+
+void DebugDraw::DrawSegment(const b2Vec2& p1, const b2Vec2& p2, const b2Color& color) {
+    Batch& batch = batchFor(color);
+    batch.lines.push_back(QPointF(p1.x, p1.y));
+    batch.lines.push_back(QPointF(p2.x, p2.y));
+}
+
+void DebugDraw::DrawTransform(const b2Transform& xf) {
+    const float axisScale = 0.4f;
+    b2Vec2 p1 = xf.p;
+    DrawSegment(p1, p1 + axisScale * xf.q.GetXAxis(), b2Color(1.0f, 0.0f, 0.0f));
+    DrawSegment(p1, p1 + axisScale * xf.q.GetYAxis(), b2Color(0.0f, 1.0f, 0.0f));
+}
+
+void DebugDraw::flush(QPainter& painter, const QTransform& worldToScreen) {
+    drawCallCount = 0;
+
+    painter.save();
+
+    // Meters to pixels with Y up, so the primitives never have to be transformed one by one
+    painter.setTransform(worldToScreen, true);
+
+    for (Batch& batch : batches) {
+        QColor color((batch.rgb >> 16) & 0xff, (batch.rgb >> 8) & 0xff, batch.rgb & 0xff);
+
+        if (!batch.fills.isEmpty()) {
+            QColor fillColor = color;
+            fillColor.setAlphaF(0.5f);
+            painter.setPen(Qt::NoPen);
+            painter.setBrush(fillColor);
+            painter.drawPath(batch.fills);
+            ++drawCallCount;
+        }
+
+        // A zero width pen is cosmetic: one pixel wide whatever the scale
+        QPen pen(color, 0.0);
+        painter.setPen(pen);
+        painter.setBrush(Qt::NoBrush);
+        if (!batch.circles.isEmpty()) {
+            painter.drawPath(batch.circles);
+            ++drawCallCount;
+        }
+        if (!batch.lines.empty()) {
+            painter.drawLines(batch.lines.data(), static_cast<int>(batch.lines.size() / 2));
+            ++drawCallCount;
+        }
+    }
+
+    painter.restore();
+}
+
+void DebugDraw::clear() {
+    // Keep the memory for the next frame
+    for (Batch& batch : batches) {
+        batch.fills.clear();
+        batch.circles.clear();
+        batch.lines.clear();
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef DEBUGDRAW_H
+#define DEBUGDRAW_H
+
+#include <Box2D/Box2D.h>
+#include <QPainterPath>
+#include <QPointF>
+#include <vector>
+
+class QPainter;
+class QTransform;
+
+// b2Draw backend that batches a whole frame of debug primitives by color.
+//
+// b2World::DrawDebugData calls one virtual function per shape. Instead of
+// one QPainter call each, the primitives are collected in world coordinates:
+// fills go into one QPainterPath per color, edges and segments into one line
+// list per color and circle outlines into one path per color. flush() then
+// draws each color with at most three painter calls, and the painter
+// transform maps the whole frame from meters to pixels. The buffers keep
+// their memory between frames, and a frame can be collected on the physics
+// thread and flushed on the GUI thread as often as it is repainted.
+class DebugDraw : public b2Draw {
+public:
+    DebugDraw();
+
+    // Draw everything collected since the last clear. worldToScreen maps
+    // meters to pixels, see Camera::getTransform.
+    void flush(QPainter& painter, const QTransform& worldToScreen);
+
+    // Forget the collected primitives before collecting the next frame
+    void clear();
+
+    // Number of painter calls made by the last flush
+    int getDrawCallCount() const { return drawCallCount; }
+
+    void DrawPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color) override;
+    void DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color) override;
+    void DrawCircle(const b2Vec2& center, float32 radius, const b2Color& color) override;
+    void DrawSolidCircle(const b2Vec2& center, float32 radius, const b2Vec2& axis, const b2Color& color) override;
+    void DrawSegment(const b2Vec2& p1, const b2Vec2& p2, const b2Color& color) override;
+    void DrawTransform(const b2Transform& xf) override;
+
+private:
+    struct Batch {
+        unsigned int rgb;  // Color as 0xRRGGBB
+        QPainterPath fills;  // Solid polygons and circles, drawn half transparent
+        QPainterPath circles;  // Circle outlines
+        std::vector<QPointF> lines;  // Pairs of line end points
+    };
+
+    Batch& batchFor(const b2Color& color);
+    void addOutline(Batch& batch, const b2Vec2* vertices, int32 vertexCount);
+
+    std::vector<Batch> batches;  // Few colors per frame, so a linear search is enough
+    int lastBatch;  // Consecutive primitives usually share a color
+    int drawCallCount;
+};
+
+#endif // DEBUGDRAW_H
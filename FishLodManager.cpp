@@ -0,0 +1,114 @@
+#include "FishLodManager.h"
+#include "FishSchool.h"
+
+namespace {
+
+// Fish closer to the lure than promoteRadius become bodies, and particles
+// again beyond demoteRadius, so a fish at the edge doesn't flip every step.
+// Simulation::streamTerrain keeps the lake bed loaded further out than this.
+const float promoteRadius = 3.5f;
+const float demoteRadius = 4.5f;
+const float fishRadius = 0.15f;
+const float fishDensity = 1.0f;  // Same as the water, fish neither sink nor float
+const float responseTime = 0.1f;  // How fast a body takes on the velocity the school wants
+
+// Fish bodies collide with everything but each other, the school keeps them apart
+const uint16 fishCategory = 0x0002;
+
+}
+
+void FishLodManager::create(b2World* world, int capacity, void* userData) {
+    b2BodyDef bodyDef;
+    bodyDef.type = b2_dynamicBody;
+    bodyDef.fixedRotation = true;  // Fish are drawn facing the way they swim
+    bodyDef.gravityScale = 0.0f;
+    bodyDef.active = false;  // In the pool
+    bodyDef.userData = userData;
+
+    // A circle is the cheapest shape to collide
+    b2CircleShape shape;
+    shape.m_radius = fishRadius;
+
+    b2FixtureDef fixtureDef;
+    fixtureDef.shape = &shape;
+    fixtureDef.density = fishDensity;
+    fixtureDef.friction = 0.2f;
+    fixtureDef.filter.categoryBits = fishCategory;
+    fixtureDef.filter.maskBits = 0xFFFF & ~fishCategory;
+
+    pool.reserve(capacity);
+    active.reserve(capacity);
+    for (int i = 0; i < capacity; ++i) {
+        b2Body* body = world->CreateBody(&bodyDef);
+        body->CreateFixture(&fixtureDef);
+        pool.push_back(body);
+    }
+}
+
+void FishLodManager::reset() {
+    while (!active.empty()) {
+        demote(static_cast<int>(active.size()) - 1);
+    }
+    promoted.clear();
+}
+
+void FishLodManager::update(const FishSchool& school, const b2Vec2& center) {
+    B2_PROFILE_SCOPE("FishLodManager::update");
+
+    promoted.resize(school.getCount(), false);
+
+    // Demote first, so the bodies are free for the fish that come in
+    for (int i = static_cast<int>(active.size()) - 1; i >= 0; --i) {
+        b2Vec2 position = active[i].body->GetPosition();
+        if (b2DistanceSquared(position, center) > demoteRadius * demoteRadius) {
+            demote(i);
+        }
+    }
+
+    // A pass over the particles is only a distance test each, even for tens of thousands of fish
+    for (int i = 0; i < school.getCount() && !pool.empty(); ++i) {
+        if (!promoted[school.getId(i)] &&
+            b2DistanceSquared(school.getPosition(i), center) < promoteRadius * promoteRadius) {
+            promote(school, i);
+        }
+    }
+
+    // The school steers, the body only has to follow. A force rather than a
+    // set velocity, so the lure and the lake bed can still push the fish.
+    for (const ActiveFish& fish : active) {
+        b2Vec2 velocity = school.getVelocity(school.findIndex(fish.id));
+        b2Vec2 force = (fish.body->GetMass() / responseTime) * (velocity - fish.body->GetLinearVelocity());
+        fish.body->ApplyForceToCenter(force, true);
+    }
+}
+
+void FishLodManager::sync(FishSchool& school) const {
+    for (const ActiveFish& fish : active) {
+        school.setFish(school.findIndex(fish.id), fish.body->GetPosition(), fish.body->GetLinearVelocity());
+    }
+}
+
+void FishLodManager::promote(const FishSchool& school, int index) {
+    b2Body* body = pool.back();
+    pool.pop_back();
+
+    body->SetTransform(school.getPosition(index), 0.0f);
+    body->SetLinearVelocity(school.getVelocity(index));
+    body->SetActive(true);
+
+    ActiveFish fish;
+    fish.id = school.getId(index);
+    fish.body = body;
+    active.push_back(fish);
+    promoted[fish.id] = true;
+}
+
+void FishLodManager::demote(int activeIndex) {
+    ActiveFish fish = active[activeIndex];
+    fish.body->SetActive(false);  // Leaves the broad-phase, its contacts are destroyed
+    pool.push_back(fish.body);
+    promoted[fish.id] = false;
+
+    active[activeIndex] = active.back();
+    active.pop_back();
+}
@@ -0,0 +1,56 @@
+#ifndef FISHLODMANAGER_H
+#define FISHLODMANAGER_H
+
+#include <Box2D/Box2D.h>
+#include <vector>
+
+class FishSchool;
+
+// Physics level of detail for the fish of a school.
+//
+// Far from the lure a fish is only a particle of the school and costs the
+// world nothing. Fish that come within the activity radius of the lure are
+// promoted to real bodies, so they bump into the lure and the lake bed, and
+// are demoted again when they swim away. The school keeps steering promoted
+// fish: each body is pushed towards the velocity the school wants, and after
+// the world step the body's position and velocity go back into the school.
+//
+// The bodies come from a pool created up front. Promoting and demoting only
+// activates and deactivates them, no body is created or destroyed while the
+// world steps. When the pool runs out the remaining fish simply stay
+// particles until a body is freed.
+class FishLodManager {
+public:
+    // Create capacity inactive fish bodies in world, each with userData
+    void create(b2World* world, int capacity, void* userData);
+
+    // Demote every fish, call before the school respawns
+    void reset();
+
+    // Before the world step: demote the fish that left the activity radius
+    // around center, promote the ones that entered it and push the promoted
+    // bodies towards the school's velocities
+    void update(const FishSchool& school, const b2Vec2& center);
+
+    // After the world step: copy the promoted bodies back into the school
+    void sync(FishSchool& school) const;
+
+    int getActiveCount() const { return static_cast<int>(active.size()); }
+    int getCapacity() const { return static_cast<int>(active.size() + pool.size()); }
+
+private:
+    // A promoted fish and the body it borrowed from the pool
+    struct ActiveFish {
+        int id;
+        b2Body* body;
+    };
+
+    void promote(const FishSchool& school, int index);
+    void demote(int activeIndex);
+
+    std::vector<b2Body*> pool;  // Inactive bodies ready for promotion
+    std::vector<ActiveFish> active;
+    std::vector<bool> promoted;  // By fish id
+};
+
+#endif // FISHLODMANAGER_H
@@ -0,0 +1,356 @@
+#include "FishSchool.h"
+#include "LakeTerrain.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+
+const float neighborRadius = 1.5f;  // Fish see each other up to this distance, also the grid cell size
+const float separationRadius = 0.6f;  // Closer fish push each other away
+const float minSpeed = 0.5f;  // Fish never stop completely
+const float maxSpeed = 3.0f;
+const float maxAcceleration = 8.0f;
+
+const float separationWeight = 1.5f;
+const float alignmentWeight = 1.0f;
+const float cohesionWeight = 0.5f;
+
+const float lureRadius = 8.0f;  // Fish notice the lure from this far
+const float lureWeight = 3.0f;
+const float biteDistance = 0.6f;  // Fish stop approaching this close to the lure
+const float scareSpeed = 3.0f;  // A lure moving faster than this scares the fish away
+const float scareWeight = 12.0f;
+
+const float boundaryMargin = 0.5f;  // Fish turn back this close to the surface, the bed and the ends
+const float boundaryWeight = 10.0f;
+
+// Fish are compared with this many others at a time
+const int lanes = 8;
+
+struct NeighborSums {
+    float count;
+    float offsetX, offsetY;
+    float velocityX, velocityY;
+    float separationX, separationY;
+};
+
+// The same sums kept separately for each lane
+struct NeighborLanes {
+    float count[lanes];
+    float offsetX[lanes], offsetY[lanes];
+    float velocityX[lanes], velocityY[lanes];
+    float separationX[lanes], separationY[lanes];
+};
+
+// Adds the fish at offset (offX, offY) with velocity (fishVX, fishVY) to lane
+// k if it is near. Masks replace branches, the fish itself is at distance 0.
+inline void addNeighbor(NeighborLanes& sums, int k, float offX, float offY, float fishVX, float fishVY) {
+    const float neighborRadius2 = neighborRadius * neighborRadius;
+    const float separationRadius2 = separationRadius * separationRadius;
+
+    float distance2 = offX * offX + offY * offY;
+    float valid = float(distance2 > 0.0f);
+    float isNeighbor = valid * float(distance2 < neighborRadius2);
+    float push = valid * float(distance2 < separationRadius2) / (distance2 + FLT_EPSILON);
+    sums.count[k] += isNeighbor;
+    sums.offsetX[k] += isNeighbor * offX;
+    sums.offsetY[k] += isNeighbor * offY;
+    sums.velocityX[k] += isNeighbor * fishVX;
+    sums.velocityY[k] += isNeighbor * fishVY;
+    sums.separationX[k] -= push * offX;
+    sums.separationY[k] -= push * offY;
+}
+
+// Adds the fish in [begin, end) that are near (xi, yi) to sums. Whole blocks
+// of lanes are compared at a time, each lane only ever adds to its own sums,
+// so the compiler can turn the lanes into SIMD registers without reordering
+// float additions. The rest of the fish go through the lanes one by one.
+void addNeighbors(NeighborSums& sums, const float* x, const float* y, const float* vx, const float* vy,
+                  int begin, int end, float xi, float yi) {
+    NeighborLanes laneSums = {};
+
+    int j = begin;
+    for (; j + lanes <= end; j += lanes) {
+        for (int k = 0; k < lanes; ++k) {
+            addNeighbor(laneSums, k, x[j + k] - xi, y[j + k] - yi, vx[j + k], vy[j + k]);
+        }
+    }
+    for (int k = 0; j + k < end; ++k) {
+        addNeighbor(laneSums, k, x[j + k] - xi, y[j + k] - yi, vx[j + k], vy[j + k]);
+    }
+
+    for (int k = 0; k < lanes; ++k) {
+        sums.count += laneSums.count[k];
+        sums.offsetX += laneSums.offsetX[k];
+        sums.offsetY += laneSums.offsetY[k];
+        sums.velocityX += laneSums.velocityX[k];
+        sums.velocityY += laneSums.velocityY[k];
+        sums.separationX += laneSums.separationX[k];
+        sums.separationY += laneSums.separationY[k];
+    }
+}
+}
+
+FishSchool::FishSchool()
+    : terrain(nullptr),
+    surface(0.0f),
+    lurePosition(0.0f, 0.0f),
+    lureVelocity(0.0f, 0.0f),
+    lureInWater(false),
+    fishCount(0),
+    keyMask(0) {
+}
+
+void FishSchool::setWater(const LakeTerrain* terrain, float surface) {
+    this->terrain = terrain;
+    this->surface = surface;
+}
+
+void FishSchool::setLure(const b2Vec2& position, const b2Vec2& velocity, bool inWater) {
+    lurePosition = position;
+    lureVelocity = velocity;
+    lureInWater = inWater;
+}
+
+void FishSchool::spawn(int count, unsigned int seed) {
+    count = std::max(count, 0);
+    fishCount = count;
+
+    x.resize(count);
+    y.resize(count);
+    vx.resize(count);
+    vy.resize(count);
+    sortedX.resize(count);
+    sortedY.resize(count);
+    sortedVX.resize(count);
+    sortedVY.resize(count);
+    cellX.resize(count);
+    cellY.resize(count);
+    neighborCount.resize(count);
+    offsetX.resize(count);
+    offsetY.resize(count);
+    velocityX.resize(count);
+    velocityY.resize(count);
+    separationX.resize(count);
+    separationY.resize(count);
+    bedHeight.resize(count);
+    fishKey.resize(count);
+    sortedCellX.resize(count);
+    sortedCellY.resize(count);
+    fishId.resize(count);
+    fishIndex.resize(count);
+    sortedId.resize(count);
+
+    // About two keys per fish keeps the chance of two cells sharing a key low
+    int keyCount = 64;
+    while (keyCount < 2 * count) {
+        keyCount *= 2;
+    }
+    keyMask = keyCount - 1;
+    cellStart.resize(keyCount + 1);
+
+    // xorshift, so the same seed always gives the same lake
+    unsigned int state = seed != 0 ? seed : 1;
+    auto random = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state & 0xffffff) / float(0x1000000);
+    };
+
+    float minX = terrain != nullptr ? terrain->getMinX() : 0.0f;
+    float maxX = terrain != nullptr ? terrain->getMaxX() : 0.0f;
+    for (int i = 0; i < count; ++i) {
+        float fishX = minX + (maxX - minX) * random();
+        float bed = terrain != nullptr ? terrain->getHeight(fishX) : surface - 1.0f;
+        float low = std::min(bed + boundaryMargin, surface);
+        float high = std::max(surface - boundaryMargin, low);
+        x[i] = fishX;
+        y[i] = low + (high - low) * random();
+
+        float angle = 2.0f * b2_pi * random();
+        float speed = minSpeed + (maxSpeed - minSpeed) * 0.5f * random();
+        vx[i] = speed * std::cos(angle);
+        vy[i] = speed * std::sin(angle);
+
+        fishId[i] = i;
+        fishIndex[i] = i;
+    }
+}
+
+void FishSchool::setFish(int index, const b2Vec2& position, const b2Vec2& velocity) {
+    x[index] = position.x;
+    y[index] = position.y;
+    vx[index] = velocity.x;
+    vy[index] = velocity.y;
+}
+
+void FishSchool::step(float timeStep) {
+    B2_PROFILE_SCOPE("FishSchool::step");
+
+    if (fishCount == 0) {
+        return;
+    }
+
+    buildGrid();
+    findNeighbors();
+    steer(timeStep);
+}
+
+int FishSchool::cellKey(int cellX, int cellY) const {
+    // Large primes spread neighboring cells over the table
+    unsigned int hash = static_cast<unsigned int>(cellX) * 73856093u ^ static_cast<unsigned int>(cellY) * 19349663u;
+    return static_cast<int>(hash & static_cast<unsigned int>(keyMask));
+}
+
+void FishSchool::buildGrid() {
+    int count = getCount();
+    float inverseCellSize = 1.0f / neighborRadius;
+
+    // Count the fish per key, shifted by one so the prefix sum gives the starts
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    for (int i = 0; i < count; ++i) {
+        cellX[i] = static_cast<int>(std::floor(x[i] * inverseCellSize));
+        cellY[i] = static_cast<int>(std::floor(y[i] * inverseCellSize));
+        fishKey[i] = cellKey(cellX[i], cellY[i]);
+        ++cellStart[fishKey[i] + 1];
+    }
+    for (int k = 0; k <= keyMask; ++k) {
+        cellStart[k + 1] += cellStart[k];
+    }
+
+    // Scatter the fish into key order. cellStart[k] is used as the insert
+    // position of key k and ends up as the start of key k + 1, so shifting it
+    // back by one restores the starts.
+    for (int i = 0; i < count; ++i) {
+        int j = cellStart[fishKey[i]]++;
+        sortedX[j] = x[i];
+        sortedY[j] = y[i];
+        sortedVX[j] = vx[i];
+        sortedVY[j] = vy[i];
+        sortedCellX[j] = cellX[i];
+        sortedCellY[j] = cellY[i];
+        sortedId[j] = fishId[i];
+        fishIndex[fishId[i]] = j;
+    }
+    for (int k = keyMask; k >= 0; --k) {
+        cellStart[k + 1] = cellStart[k];
+    }
+    cellStart[0] = 0;
+
+    x.swap(sortedX);
+    y.swap(sortedY);
+    vx.swap(sortedVX);
+    vy.swap(sortedVY);
+    cellX.swap(sortedCellX);
+    cellY.swap(sortedCellY);
+    fishId.swap(sortedId);
+}
+
+void FishSchool::findNeighbors() {
+    B2_PROFILE_SCOPE("FishSchool::findNeighbors");
+
+    const float* fishX = x.data();
+    const float* fishY = y.data();
+    const float* fishVX = vx.data();
+    const float* fishVY = vy.data();
+
+    int count = getCount();
+    for (int i = 0; i < count; ++i) {
+        NeighborSums sums = {};
+
+        // Two of the 3x3 cells can share a key, each key is only searched once
+        int visited[9];
+        int visitedCount = 0;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int key = cellKey(cellX[i] + dx, cellY[i] + dy);
+                if (std::find(visited, visited + visitedCount, key) != visited + visitedCount) {
+                    continue;
+                }
+                visited[visitedCount++] = key;
+
+                // Fish of other cells that share the key fail the distance test
+                addNeighbors(sums, fishX, fishY, fishVX, fishVY, cellStart[key], cellStart[key + 1], fishX[i], fishY[i]);
+            }
+        }
+
+        neighborCount[i] = sums.count;
+        offsetX[i] = sums.offsetX;
+        offsetY[i] = sums.offsetY;
+        velocityX[i] = sums.velocityX;
+        velocityY[i] = sums.velocityY;
+        separationX[i] = sums.separationX;
+        separationY[i] = sums.separationY;
+    }
+}
+
+void FishSchool::steer(float timeStep) {
+    B2_PROFILE_SCOPE("FishSchool::steer");
+
+    int count = getCount();
+
+    // The bed is interpolated from the heightfield, not in the loop below so that loop has no calls
+    for (int i = 0; i < count; ++i) {
+        bedHeight[i] = terrain != nullptr ? terrain->getHeight(x[i]) : -FLT_MAX;
+    }
+
+    float minX = terrain != nullptr ? terrain->getMinX() : -FLT_MAX;
+    float maxX = terrain != nullptr ? terrain->getMaxX() : FLT_MAX;
+    float lureSpeed = lureVelocity.Length();
+    float lureAttraction = lureInWater && lureSpeed < scareSpeed ? lureWeight : 0.0f;
+    float lureScare = lureInWater && lureSpeed >= scareSpeed ? scareWeight : 0.0f;
+
+    // Masks and min/max instead of branches, as in the neighbor loops
+    float surface = this->surface;
+    const b2Vec2 lurePosition = this->lurePosition;
+    for (int i = 0; i < count; ++i) {
+        float fishX = x[i];
+        float fishY = y[i];
+        float fishVX = vx[i];
+        float fishVY = vy[i];
+
+        // Boids: head for the neighbors' center and heading, keep some distance
+        float hasNeighbors = std::min(neighborCount[i], 1.0f);  // Counts are whole numbers
+        float inverseN = hasNeighbors / std::max(neighborCount[i], 1.0f);
+        float ax = cohesionWeight * offsetX[i] * inverseN
+            + alignmentWeight * hasNeighbors * (velocityX[i] * inverseN - fishVX)
+            + separationWeight * separationX[i];
+        float ay = cohesionWeight * offsetY[i] * inverseN
+            + alignmentWeight * hasNeighbors * (velocityY[i] * inverseN - fishVY)
+            + separationWeight * separationY[i];
+
+        // The lure pulls harder the closer it is, down to the bite distance
+        float toLureX = lurePosition.x - fishX;
+        float toLureY = lurePosition.y - fishY;
+        float lureDistance = std::sqrt(toLureX * toLureX + toLureY * toLureY) + FLT_EPSILON;
+        float closeness = std::max(0.0f, 1.0f - lureDistance / lureRadius);
+        float pull = float(lureDistance > biteDistance) * lureAttraction;
+        float lureForce = (pull - lureScare) * closeness / lureDistance;
+        ax += lureForce * toLureX;
+        ay += lureForce * toLureY;
+
+        // Turn back before the surface, the bed and the ends of the lake
+        ay -= boundaryWeight * std::max(0.0f, fishY - (surface - boundaryMargin));
+        ay += boundaryWeight * std::max(0.0f, (bedHeight[i] + boundaryMargin) - fishY);
+        ax += boundaryWeight * std::max(0.0f, (minX + boundaryMargin) - fishX);
+        ax -= boundaryWeight * std::max(0.0f, fishX - (maxX - boundaryMargin));
+
+        float acceleration = std::sqrt(ax * ax + ay * ay);
+        float accelerationScale = maxAcceleration / std::max(acceleration, maxAcceleration);
+        fishVX += timeStep * accelerationScale * ax;
+        fishVY += timeStep * accelerationScale * ay;
+
+        float speed = std::sqrt(fishVX * fishVX + fishVY * fishVY) + FLT_EPSILON;
+        float speedScale = std::min(std::max(speed, minSpeed), maxSpeed) / speed;
+        fishVX *= speedScale;
+        fishVY *= speedScale;
+
+        // Never leave the water, whatever the forces say
+        x[i] = std::min(std::max(fishX + timeStep * fishVX, minX), maxX);
+        y[i] = std::min(std::max(fishY + timeStep * fishVY, bedHeight[i]), surface);
+        vx[i] = fishVX;
+        vy[i] = fishVY;
+    }
+}
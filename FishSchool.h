@@ -0,0 +1,91 @@
+#ifndef FISHSCHOOL_H
+#define FISHSCHOOL_H
+
+#include <Box2D/Box2D.h>
+#include <vector>
+
+class LakeTerrain;
+
+// Fish that swim in schools and react to the lure (boids).
+//
+// Every fish steers away from fish that are too close (separation), towards
+// the heading of its neighbors (alignment) and towards their center
+// (cohesion). Fish in range of a still lure swim to it, a lure that moves
+// fast scares them away. The water surface and the lake bed keep them in.
+//
+// The fish are kinematic agents, not bodies: there are thousands of them and
+// they only have to look plausible, so they never go through the contact
+// solver. The state is stored as separate arrays (x, y, vx, vy, ...).
+// Neighbors are found with a spatial hash of a uniform grid whose cells are
+// as large as the neighbor radius, so only the 3x3 cells around a fish are
+// searched. The hash is rebuilt every step with a counting sort that also
+// reorders the fish by cell, so the fish of a cell are contiguous in memory
+// and the neighbor loops read them as straight arrays. Those loops keep
+// separate sums per lane, so the compiler can vectorize them without
+// reordering float additions.
+class FishSchool {
+public:
+    FishSchool();
+
+    // Where the fish may swim: below surface, above the lake bed of terrain
+    // and between its ends. The terrain must outlive the school.
+    void setWater(const LakeTerrain* terrain, float surface);
+
+    // Replace the fish with count fish scattered over the water
+    void spawn(int count, unsigned int seed = 1);
+
+    // The lure attracts fish only while it is in the water
+    void setLure(const b2Vec2& position, const b2Vec2& velocity, bool inWater);
+
+    void step(float timeStep);
+
+    // Fish are reordered every step, an index is not the same fish for long
+    int getCount() const { return fishCount; }
+    b2Vec2 getPosition(int index) const { return b2Vec2(x[index], y[index]); }
+    b2Vec2 getVelocity(int index) const { return b2Vec2(vx[index], vy[index]); }
+
+    // A fish keeps its id from spawn to spawn, ids go from 0 to getCount() - 1
+    int getId(int index) const { return fishId[index]; }
+    int findIndex(int id) const { return fishIndex[id]; }
+
+    // Overwrite a fish, for fish that are moved by something else for a while
+    void setFish(int index, const b2Vec2& position, const b2Vec2& velocity);
+
+private:
+    void buildGrid();  // Sort the fish by cell and find where each cell starts
+    void findNeighbors();  // Separation, alignment and cohesion sums of each fish
+    void steer(float timeStep);  // Turn the sums into accelerations and move
+    int cellKey(int cellX, int cellY) const;
+
+    const LakeTerrain* terrain;
+    float surface;
+    b2Vec2 lurePosition;
+    b2Vec2 lureVelocity;
+    bool lureInWater;
+
+    int fishCount;
+
+    // Fish state, sorted by cell after buildGrid
+    std::vector<float> x, y, vx, vy;
+    std::vector<int> cellX, cellY;  // Grid cell of each fish
+    std::vector<int> fishId;
+    std::vector<int> fishIndex;  // Where the fish of each id is
+
+    // Neighbor sums of each fish, written by findNeighbors
+    std::vector<float> neighborCount;
+    std::vector<float> offsetX, offsetY;  // Sum of offsets to the neighbors
+    std::vector<float> velocityX, velocityY;  // Sum of the neighbors' velocities
+    std::vector<float> separationX, separationY;
+    std::vector<float> bedHeight;
+
+    // Spatial hash: the fish of key k are [cellStart[k], cellStart[k + 1])
+    std::vector<int> cellStart;
+    std::vector<int> fishKey;
+    int keyMask;
+
+    // Scratch space for the counting sort, kept between steps
+    std::vector<float> sortedX, sortedY, sortedVX, sortedVY;
+    std::vector<int> sortedCellX, sortedCellY, sortedId;
+};
+
+#endif // FISHSCHOOL_H
@@ -3,6 +3,12 @@ QT += widgets opengl
 
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 5): QT += openglwidgets
+
+# QWheelEvent::position needs Qt 5.14, QPainterPath::clear 5.13
+lessThan(QT_MAJOR_VERSION, 5)|if(equals(QT_MAJOR_VERSION, 5):lessThan(QT_MINOR_VERSION, 14)) {
+    error("Qt 5.14 or newer is required")
+}
 
 CONFIG += c++17
 
@@ -10,22 +16,31 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# Record Box2D and game scopes and write them to fishing_trace.json on exit,
+# see Box2D/Common/b2Profiler.h
+#DEFINES += B2_PROFILER
+
 SOURCES += \
     Box2D/Collision/Shapes/b2ChainShape.cpp \
     Box2D/Collision/Shapes/b2CircleShape.cpp \
     Box2D/Collision/Shapes/b2EdgeShape.cpp \
+    Box2D/Collision/Shapes/b2HeightfieldShape.cpp \
     Box2D/Collision/Shapes/b2PolygonShape.cpp \
     Box2D/Collision/b2BroadPhase.cpp \
     Box2D/Collision/b2CollideCircle.cpp \
     Box2D/Collision/b2CollideEdge.cpp \
+    Box2D/Collision/b2CollideHeightfield.cpp \
     Box2D/Collision/b2CollidePolygon.cpp \
     Box2D/Collision/b2Collision.cpp \
     Box2D/Collision/b2Distance.cpp \
     Box2D/Collision/b2DynamicTree.cpp \
     Box2D/Collision/b2TimeOfImpact.cpp \
+    Box2D/Common/b2Allocator.cpp \
     Box2D/Common/b2BlockAllocator.cpp \
     Box2D/Common/b2Draw.cpp \
     Box2D/Common/b2Math.cpp \
+    Box2D/Common/b2PerfCounters.cpp \
+    Box2D/Common/b2Profiler.cpp \
     Box2D/Common/b2Settings.cpp \
     Box2D/Common/b2StackAllocator.cpp \
     Box2D/Common/b2Timer.cpp \
@@ -36,8 +51,12 @@ SOURCES += \
     Box2D/Dynamics/Contacts/b2ContactSolver.cpp \
     Box2D/Dynamics/Contacts/b2EdgeAndCircleContact.cpp \
     Box2D/Dynamics/Contacts/b2EdgeAndPolygonContact.cpp \
+    Box2D/Dynamics/Contacts/b2HeightfieldAndCircleContact.cpp \
+    Box2D/Dynamics/Contacts/b2HeightfieldAndPolygonContact.cpp \
     Box2D/Dynamics/Contacts/b2PolygonAndCircleContact.cpp \
     Box2D/Dynamics/Contacts/b2PolygonContact.cpp \
+    Box2D/Dynamics/Controllers/b2BuoyancyController.cpp \
+    Box2D/Dynamics/Controllers/b2Controller.cpp \
     Box2D/Dynamics/Joints/b2DistanceJoint.cpp \
     Box2D/Dynamics/Joints/b2FrictionJoint.cpp \
     Box2D/Dynamics/Joints/b2GearJoint.cpp \
@@ -51,13 +70,26 @@ SOURCES += \
     Box2D/Dynamics/Joints/b2WeldJoint.cpp \
     Box2D/Dynamics/Joints/b2WheelJoint.cpp \
     Box2D/Dynamics/b2Body.cpp \
+    Box2D/Dynamics/b2BodyStore.cpp \
     Box2D/Dynamics/b2ContactManager.cpp \
     Box2D/Dynamics/b2Fixture.cpp \
     Box2D/Dynamics/b2Island.cpp \
+    Box2D/Dynamics/b2IslandManager.cpp \
+    Box2D/Dynamics/b2PairTable.cpp \
     Box2D/Dynamics/b2World.cpp \
     Box2D/Dynamics/b2WorldCallbacks.cpp \
     Box2D/Rope/b2Rope.cpp \
+    Camera.cpp \
+    DebugDraw.cpp \
+    FishLodManager.cpp \
+    FishSchool.cpp \
+    FishingLine.cpp \
     Game.cpp \
+    LakeTerrain.cpp \
+    Simulation.cpp \
+    SpriteAtlas.cpp \
+    SpriteRenderer.cpp \
+    WaterVolume.cpp \
     main.cpp
 
 HEADERS += \
@@ -65,6 +97,7 @@ HEADERS += \
     Box2D/Collision/Shapes/b2ChainShape.h \
     Box2D/Collision/Shapes/b2CircleShape.h \
     Box2D/Collision/Shapes/b2EdgeShape.h \
+    Box2D/Collision/Shapes/b2HeightfieldShape.h \
     Box2D/Collision/Shapes/b2PolygonShape.h \
     Box2D/Collision/Shapes/b2Shape.h \
     Box2D/Collision/b2BroadPhase.h \
@@ -72,10 +105,14 @@ HEADERS += \
     Box2D/Collision/b2Distance.h \
     Box2D/Collision/b2DynamicTree.h \
     Box2D/Collision/b2TimeOfImpact.h \
+    Box2D/Common/b2Allocator.h \
     Box2D/Common/b2BlockAllocator.h \
     Box2D/Common/b2Draw.h \
     Box2D/Common/b2GrowableStack.h \
+    Box2D/Common/b2HandlePool.h \
     Box2D/Common/b2Math.h \
+    Box2D/Common/b2PerfCounters.h \
+    Box2D/Common/b2Profiler.h \
     Box2D/Common/b2Settings.h \
     Box2D/Common/b2StackAllocator.h \
     Box2D/Common/b2Timer.h \
@@ -84,10 +121,15 @@ HEADERS += \
     Box2D/Dynamics/Contacts/b2CircleContact.h \
     Box2D/Dynamics/Contacts/b2Contact.h \
     Box2D/Dynamics/Contacts/b2ContactSolver.h \
+    Box2D/Dynamics/Contacts/b2ContactTraits.h \
     Box2D/Dynamics/Contacts/b2EdgeAndCircleContact.h \
     Box2D/Dynamics/Contacts/b2EdgeAndPolygonContact.h \
+    Box2D/Dynamics/Contacts/b2HeightfieldAndCircleContact.h \
+    Box2D/Dynamics/Contacts/b2HeightfieldAndPolygonContact.h \
     Box2D/Dynamics/Contacts/b2PolygonAndCircleContact.h \
     Box2D/Dynamics/Contacts/b2PolygonContact.h \
+    Box2D/Dynamics/Controllers/b2BuoyancyController.h \
+    Box2D/Dynamics/Controllers/b2Controller.h \
     Box2D/Dynamics/Joints/b2DistanceJoint.h \
     Box2D/Dynamics/Joints/b2FrictionJoint.h \
     Box2D/Dynamics/Joints/b2GearJoint.h \
@@ -101,14 +143,30 @@ HEADERS += \
     Box2D/Dynamics/Joints/b2WeldJoint.h \
     Box2D/Dynamics/Joints/b2WheelJoint.h \
     Box2D/Dynamics/b2Body.h \
+    Box2D/Dynamics/b2BodyStore.h \
     Box2D/Dynamics/b2ContactManager.h \
     Box2D/Dynamics/b2Fixture.h \
     Box2D/Dynamics/b2Island.h \
+    Box2D/Dynamics/b2IslandManager.h \
+    Box2D/Dynamics/b2PairTable.h \
     Box2D/Dynamics/b2TimeStep.h \
     Box2D/Dynamics/b2World.h \
     Box2D/Dynamics/b2WorldCallbacks.h \
     Box2D/Rope/b2Rope.h \
-    Game.h
+    Camera.h \
+    DebugDraw.h \
+    FishLodManager.h \
+    FishSchool.h \
+    FishingLine.h \
+    Game.h \
+    LakeTerrain.h \
+    Simulation.h \
+    SpriteAtlas.h \
+    SpriteRenderer.h \
+    SpriteShaders.h \
+    SpscQueue.h \
+    TripleBuffer.h \
+    WaterVolume.h
 
 FORMS += \
     Game.ui
@@ -0,0 +1,149 @@
+#include "FishingLine.h"
+#include <vector>
+
+// Collision group shared by lines and lures, so a line doesn't collide with its lure
+static const int16 lineGroup = -1;
+
+FishingLine::FishingLine()
+    : lure(nullptr),
+    rodTip(0.0f, 0.0f),
+    segmentLength(0.1f),
+    vertexMass(0.01f),
+    tailLength(0.1f),
+    maxTension(200.0f),
+    freeSpool(false),
+    tension(0.0f, 0.0f) {
+}
+
+void FishingLine::create(int capacity, float segmentLength, const b2Vec2& rodTip, b2Body* lure) {
+    this->lure = lure;
+    this->rodTip = rodTip;
+    this->segmentLength = segmentLength;
+
+    // Start with the shortest line, lure to rod tip
+    b2Vec2 lurePosition = lure->GetPosition();
+    std::vector<b2Vec2> vertices(3);
+    std::vector<float32> masses(3, vertexMass);
+    vertices[0] = lurePosition;
+    vertices[1] = 0.5f * (lurePosition + rodTip);
+    vertices[2] = rodTip;
+    masses[2] = 0.0f;  // Pinned to the rod tip
+
+    b2RopeDef def;
+    def.vertices = vertices.data();
+    def.count = 3;
+    def.capacity = b2Max(capacity, 3);
+    def.masses = masses.data();
+    def.gravity = lure->GetWorld()->GetGravity();
+    def.damping = 0.5f;
+    def.k2 = 1.0f;   // Fishing line barely stretches
+    def.k3 = 0.05f;  // and hardly resists bending
+    def.ordering = b2_redBlackOrdering;  // Vectorized solver, lines have hundreds of segments
+
+    // The line rests on the lake bed and snags on anything else in the world,
+    // except the lure it is tied to. Both go in a group that never collides.
+    def.world = lure->GetWorld();
+    def.radius = 0.01f;
+    def.friction = 0.5f;
+    def.filter.groupIndex = lineGroup;
+    def.contactCapacity = def.capacity;  // Enough for a line lying on the lake bed
+    for (b2Fixture* fixture = lure->GetFixtureList(); fixture != nullptr; fixture = fixture->GetNext()) {
+        b2Filter filter = fixture->GetFilterData();
+        filter.groupIndex = lineGroup;
+        fixture->SetFilterData(filter);
+    }
+
+    rope.Initialize(&def);
+
+    rope.SetRestLength(0, segmentLength);
+    tailLength = segmentLength;
+    rope.SetRestLength(1, tailLength);
+}
+
+float FishingLine::getLineOut() const {
+    return (rope.GetVertexCount() - 2) * segmentLength + tailLength;
+}
+
+float FishingLine::getMaxLineOut() const {
+    return (rope.GetCapacity() - 1) * segmentLength;
+}
+
+void FishingLine::reel(float delta) {
+    setTailLength(tailLength + delta);
+}
+
+// The rod end segment absorbs line changes. When it grows past a full segment
+// a vertex is added at the rod tip, when it shrinks to nothing one is removed.
+void FishingLine::setTailLength(float length) {
+    const float minTail = 0.05f * segmentLength;
+
+    while (length > segmentLength && rope.GetVertexCount() < rope.GetCapacity()) {
+        int tip = rope.GetVertexCount() - 1;
+        rope.SetMass(tip, vertexMass);  // The old tip joins the free line
+        rope.SetRestLength(tip - 1, segmentLength);
+        rope.AddVertex(rodTip, 0.0f, 0.0f);
+        length -= segmentLength;
+    }
+
+    while (length < minTail && rope.GetVertexCount() > 3) {
+        rope.RemoveVertex();
+        length += segmentLength;
+    }
+
+    tailLength = b2Clamp(length, minTail, segmentLength);
+    pinRodEnd();
+}
+
+void FishingLine::pinRodEnd() {
+    int tip = rope.GetVertexCount() - 1;
+    rope.SetMass(tip, 0.0f);
+    rope.SetVertex(tip, rodTip);
+    rope.SetRestLength(tip - 1, tailLength);
+}
+
+void FishingLine::step(float timeStep, int iterations) {
+    tension.SetZero();
+    if (lure == nullptr || timeStep <= 0.0f) {
+        return;
+    }
+
+    // Let the lure pull line off the reel during a cast
+    if (freeSpool) {
+        float distance = b2Distance(rodTip, lure->GetPosition());
+        float slack = 1.05f * distance - getLineOut();
+        if (slack > 0.0f) {
+            reel(slack);
+        }
+    }
+
+    pinRodEnd();
+
+    // Vertex 0 carries the lure's mass, so the line only moves the lure as much
+    // as the mass ratio allows. Its velocity is cleared because the world step
+    // already moved the lure.
+    b2Vec2 lurePosition = lure->GetPosition();
+    bool coupled = lure->GetType() == b2_dynamicBody && lure->GetMass() > 0.0f;
+    rope.SetVertex(0, lurePosition);
+    rope.SetMass(0, coupled ? lure->GetMass() : 0.0f);
+
+    rope.Step(timeStep, iterations);
+
+    if (!coupled) {
+        return;
+    }
+
+    // The rope integrated gravity for vertex 0 as well, which the world step
+    // already applied to the lure. Whatever is left is the pull of the line.
+    b2Vec2 gravity = lure->GetGravityScale() * lure->GetWorld()->GetGravity();
+    b2Vec2 gravityDrop = (timeStep * timeStep) * gravity;
+    b2Vec2 correction = rope.GetVertices()[0] - (lurePosition + gravityDrop);
+
+    b2Vec2 impulse = (lure->GetMass() / timeStep) * correction;
+    float maxImpulse = maxTension * timeStep;
+    if (impulse.LengthSquared() > maxImpulse * maxImpulse) {
+        impulse *= maxImpulse / impulse.Length();
+    }
+
+    tension = (1.0f / timeStep) * impulse;
+    lure->ApplyLinearImpulse(impulse, lure->GetWorldCenter(), false);
+}
@@ -0,0 +1,61 @@
+#ifndef FISHINGLINE_H
+#define FISHINGLINE_H
+
+#include <Box2D/Box2D.h>
+#include <Box2D/Rope/b2Rope.h>
+
+// A fishing line simulated as a Verlet rope (b2Rope) between the rod tip and a lure.
+//
+// Vertex 0 is attached to the lure, the last vertex is pinned to the rod tip.
+// Line is paid out and reeled in at the rod end by growing or shrinking the
+// last segment and adding or removing vertices, all within the storage
+// reserved up front. The line and the lure are coupled both ways: the lure
+// drags vertex 0 along, and the correction the line applies to vertex 0 is
+// fed back to the lure as an impulse, so a taut line pulls on the lure.
+class FishingLine {
+public:
+    FishingLine();
+
+    // Build the line. capacity is the maximum number of vertices, so the
+    // longest line is (capacity - 1) * segmentLength.
+    void create(int capacity, float segmentLength, const b2Vec2& rodTip, b2Body* lure);
+
+    void setRodTip(const b2Vec2& position) { rodTip = position; }
+
+    // While free spooling, the lure pulls line off the reel as it flies
+    void setFreeSpool(bool flag) { freeSpool = flag; }
+    bool isFreeSpool() const { return freeSpool; }
+
+    // Change the line out by delta meters (negative reels in)
+    void reel(float delta);
+    float getLineOut() const;
+    float getMaxLineOut() const;
+
+    // Step the line after the world step
+    void step(float timeStep, int iterations);
+
+    int getPointCount() const { return rope.GetVertexCount(); }
+    const b2Vec2* getPoints() const { return rope.GetVertices(); }
+
+    // Force the line applied to the lure during the last step
+    const b2Vec2& getTension() const { return tension; }
+
+    // Maximum force the line can apply to the lure
+    void setMaxTension(float force) { maxTension = force; }
+
+private:
+    void setTailLength(float length);
+    void pinRodEnd();
+
+    b2Rope rope;
+    b2Body* lure;
+    b2Vec2 rodTip;
+    float segmentLength;
+    float vertexMass;     // Mass of a line vertex
+    float tailLength;     // Rest length of the segment at the rod end
+    float maxTension;
+    bool freeSpool;
+    b2Vec2 tension;
+};
+
+#endif // FISHINGLINE_H
@@ -1,117 +1,126 @@
 #include "Game.h"
 #include <QPainter>
 #include <QMouseEvent>
+#include <QWheelEvent>
+#include <QKeyEvent>
 #include <QTimer>
-#include <QPainterPath>
+#include <QPolygonF>
+#include <QSurfaceFormat>
+#include <algorithm>
+#include <cfloat>
 #include <cmath>
 
-// Constructor: Initializes the Box2D world and game objects
+// Half size of the lure in meters, matches its fixture
+static const b2Vec2 lureHalfSize(0.5f, 0.25f);
+
+// Half size of a fish sprite in meters
+static const b2Vec2 fishHalfSize(0.3f, 0.15f);
+
+// A fish swimming to the left is flipped so its back stays up
+static b2Vec2 fishSpriteSize(float angle) {
+    return b2Vec2(fishHalfSize.x, std::cos(angle) < 0.0f ? -fishHalfSize.y : fishHalfSize.y);
+}
+
+// Constructor: Starts the physics thread and sets up the rendering
 Game::Game(QWidget *parent)
-    : QWidget(parent),
-    world(b2Vec2(0.0f, -10.0f)),  // Initialize the Box2D world with gravity (-10 m/s²)
-    throwableBody(nullptr),
-    groundBody(nullptr),
+    : QOpenGLWidget(parent),
+    simulation(b2Vec2(10.0f, 10.0f)),  // The lure starts 10 meters right, 10 meters up
+    showDebugDraw(false),
+    startingPosition(10.0f, 10.0f),
+    backgroundValid(false),
+    repaintAll(true),
     isDragging(false),
-    waterLevel(7.0f),  // Water level set to Y = 7.0
-    targetDepth(3.0f),
-    isInWater(false){
+    heldAt(0),
+    aimReady(false),
+    isPanning(false){
 
-    // Load the ball image
-    if (!ballImage.load(":/new/prefix1/image/Jig.png")) {  // Replace with your actual image path
-        qDebug() << "Failed to load ball image!";
-    }
+    // Multisampling keeps QPainter's antialiasing on the GL surface
+    QSurfaceFormat surfaceFormat = QSurfaceFormat::defaultFormat();
+    surfaceFormat.setSamples(4);
+    setFormat(surfaceFormat);
 
+    // Register the images, they are only decoded when the first frame is drawn
+    lureSprite = atlas.addImage(":/new/prefix1/image/Jig.png");
+    fishSprite = atlas.addImage(":/new/prefix1/image/Fish.png");
 
     // Create the ground object with default values
     createGround(0.0f, 0.0f, 25.0f, 0.0f);
 
-    // Create the throwable object (e.g., a ball)
-    createThrowableBody();
+    // D toggles the debug overlay of every fixture and joint
+    setFocusPolicy(Qt::StrongFocus);
+
+    // Keep the last frame so paintGL only has to repaint what moved
+    setUpdateBehavior(QOpenGLWidget::PartialUpdate);
 
-    // Set the ball's initial position (hardcoded for now)
-    setBallStartPosition(10.0f, 10.0f);  // Start at (10 meters right, 10 meters up)
+    // The physics steps on its own thread from now on
+    simulation.start();
 
-    // Timer to update the physics simulation at ~60 FPS
+    // Timer to show the newest physics step at ~60 FPS
     QTimer *timer = new QTimer(this);
     connect(timer, &QTimer::timeout, this, [this]() {
-        if (!isDragging) {  // Only update the physics when the object is not being dragged
-            world.Step(1.0f / 60.0f, 6, 2);  // Step the physics simulation forward by 1/60th of a second
-            updateLureInWater();  // Stop the lure at the target depth
+        simulation.flushCommands();  // In case the physics fell behind on input
+        processLureEvents();
+        if (simulation.hasNewSnapshot()) {
             update();  // Request the widget to redraw itself
         }
     });
     timer->start(16);  // 16 milliseconds per update (60 FPS)
 }
 
-// === Water Resistance, Target Depth, and Detection ===
-void Game::updateLureInWater() {
-    b2Vec2 position = throwableBody->GetPosition();
-
-    // Detect when the lure enters or exits the water
-    if (position.y <= waterLevel && !isInWater) {
-        isInWater = true;  // Mark the lure as in water
-        qDebug() << "Lure hit the water!";
-    } else if (position.y > waterLevel && isInWater) {
-        isInWater = false;  // Mark the lure as out of water
-        qDebug() << "Lure exited the water!";
-    }
-
-    // Apply water resistance if the lure is in water
-    if (isInWater) {
-        applyWaterResistance();
-
-        // Stop the lure if it reaches the target depth
-        if (position.y <= waterLevel - targetDepth) {
-            stopLureAtDepth();
+// The simulation reports what happened to the lure in the water
+void Game::processLureEvents() {
+    WaterEvent::Type type;
+    while (simulation.pollLureEvent(type)) {
+        switch (type) {
+        case WaterEvent::Entered:
+            qDebug() << "Lure hit the water!";
+            break;
+        case WaterEvent::Exited:
+            qDebug() << "Lure exited the water!";
+            break;
+        case WaterEvent::ReachedDepth:
+            //qDebug() << "Lure stopped at target depth!";
+            break;
         }
     }
 }
 
-void Game::applyWaterResistance() {
-    b2Vec2 velocity = throwableBody->GetLinearVelocity();
-
-    // Apply different damping factors for horizontal and vertical motion
-    float horizontalDamping = 0.9f;  // Slow down horizontal motion slightly
-    float verticalDamping = 0.7f;    // Stronger damping for vertical motion
-
-    b2Vec2 waterDampedVelocity(
-        velocity.x * horizontalDamping,  // Reduce horizontal velocity
-        velocity.y * verticalDamping     // Reduce vertical velocity
-        );
-
-    // Apply the new velocity to the lure
-    throwableBody->SetLinearVelocity(waterDampedVelocity);
 
-    // Optionally reduce angular velocity (spinning effect)
-    float angularDamping = 0.8f;  // Damping for rotational motion
-    float newAngularVelocity = throwableBody->GetAngularVelocity() * angularDamping;
-    throwableBody->SetAngularVelocity(newAngularVelocity);
-}
+// === Mouse Events ===
 
-void Game::stopLureAtDepth() {
-    // Stop the lure's motion
-    throwableBody->SetLinearVelocity(b2Vec2(0.0f, 0.0f));
-    throwableBody->SetAngularVelocity(0.0f);  // Stop spinning
-    throwableBody->SetGravityScale(0.0f);     // Neutralize gravity to keep it at the target depth
-    //qDebug() << "Lure stopped at target depth!";
+// Mouse position in widget pixels, QMouseEvent::pos() is deprecated in Qt 6
+static QPointF mousePosition(const QMouseEvent *event) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return event->position();
+#else
+    return event->localPos();
+#endif
 }
 
-
-// === Mouse Events ===
-
 // Handles mouse press events
 void Game::mousePressEvent(QMouseEvent *event) {
-    float scale = 30.0f;  // Convert pixels to Box2D meters
-    dragStart.Set(event->pos().x() / scale, (height() - event->pos().y()) / scale);  // Record drag start position
-    startingPosition = throwableBody->GetPosition();  // Record the current position of the object
+    if (event->button() == Qt::RightButton) {  // The right button pans the view
+        isPanning = true;
+        lastPanPosition = mousePosition(event);
+        camera.setFollowing(false);  // F follows the lure again
+        return;
+    }
+
+    dragStart = camera.toWorld(mousePosition(event));  // Record drag start position
+    heldAt = simulation.hold();  // Stop the physics while the throw is aimed
+    aimReady = false;  // The trajectory starts at the held lure, paintGL waits for its snapshot
     isDragging = true;  // Start dragging
 }
 
 // Handles mouse move events
 void Game::mouseMoveEvent(QMouseEvent *event) {
-    if (isDragging) {
-        float scale = 30.0f;  // Convert pixels to Box2D meters
-        dragEnd.Set(event->pos().x() / scale, (height() - event->pos().y()) / scale);  // Record drag end position
+    if (isPanning) {
+        camera.pan(mousePosition(event) - lastPanPosition);
+        lastPanPosition = mousePosition(event);
+        cameraMoved();
+        update();
+    } else if (isDragging) {
+        dragEnd = camera.toWorld(mousePosition(event));  // Record drag end position
         initialVelocity = 10.0f * (dragEnd - dragStart);  // Calculate velocity based on drag
         update();  // Redraw the widget to update the trajectory
     }
@@ -119,37 +128,70 @@ void Game::mouseMoveEvent(QMouseEvent *event) {
 
 // Handles mouse release events
 void Game::mouseReleaseEvent(QMouseEvent *event) {
-    Q_UNUSED(event);  // Ignore the unused parameter
-
-    if (isDragging) {
+    if (event->button() == Qt::RightButton) {
+        isPanning = false;
+    } else if (isDragging) {
         isDragging = false;  // Stop dragging
-        throwableBody->SetType(b2_dynamicBody);  // Change the body type to dynamic (affected by gravity)
-        throwableBody->SetLinearVelocity(initialVelocity);  // Apply the calculated velocity to the object
+        simulation.throwLure(initialVelocity);  // Throw with the calculated velocity and resume the physics
         dragStart.SetZero();  // Reset drag start
         dragEnd.SetZero();  // Reset drag end
     }
 }
 
+// Scrolling the wheel reels the line in and out, with Ctrl it zooms
+void Game::wheelEvent(QWheelEvent *event) {
+    if (event->modifiers() & Qt::ControlModifier) {
+        camera.zoomAt(event->position(), std::pow(2.0f, event->angleDelta().y() / 720.0f));  // 6 notches double the zoom
+        cameraMoved();
+        update();
+        event->accept();
+        return;
+    }
+
+    float metersPerStep = 0.25f;  // One wheel notch (120 units) moves 25 cm of line
+    simulation.reel(metersPerStep * event->angleDelta().y() / 120.0f);
+    event->accept();
+}
+
+void Game::keyPressEvent(QKeyEvent *event) {
+    if (event->key() == Qt::Key_D) {
+        showDebugDraw = !showDebugDraw;
+        simulation.setDebugDraw(showDebugDraw);  // The shapes are collected with each snapshot
+        repaintAll = true;  // Also erases the overlay when it is turned off
+        update();
+        return;
+    }
+    if (event->key() == Qt::Key_F) {
+        camera.setFollowing(true);  // Back to the lure after panning, paintGL moves the camera
+        update();
+        return;
+    }
+    QOpenGLWidget::keyPressEvent(event);
+}
+
 // === Ground Position Handling ===
 
-// Creates the static ground object
+// Creates a straight lake bed from (x1, y1) to (x2, y2)
 void Game::createGround(float x1, float y1, float x2, float y2) {
-    // Destroy the old ground body if it exists
-    if (groundBody != nullptr) {
-        world.DestroyBody(groundBody);  // Remove old ground
+    if (x2 < x1) {  // The heightfield runs left to right
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+    }
+    if (x2 - x1 < b2_linearSlop) {
+        qDebug() << "The lake bed can't be vertical!";
+        return;
     }
 
-    // Define the ground body
-    b2BodyDef groundBodyDef;
-    groundBodyDef.position.Set(0.0f, 0.0f);  // Static position
-    groundBody = world.CreateBody(&groundBodyDef);  // Add to Box2D world
+    float spacing = 1.0f;  // One height sample per meter
+    int segments = std::max(1, static_cast<int>(std::ceil((x2 - x1) / spacing)));
 
-    // Define the shape of the ground as an edge
-    b2EdgeShape groundShape;
-    groundShape.Set(b2Vec2(x1, y1), b2Vec2(x2, y2));  // Start and end positions
+    std::vector<float> heights(segments + 1);
+    for (int i = 0; i <= segments; ++i) {
+        heights[i] = y1 + (y2 - y1) * i / segments;  // Interpolate along the line
+    }
 
-    // Attach the shape to the body
-    groundBody->CreateFixture(&groundShape, 0.0f);  // Static fixture
+    // The background is redrawn once a snapshot has the new lake bed
+    simulation.setLakeBed(std::move(heights), (x2 - x1) / segments, x1);
 }
 
 
@@ -158,33 +200,23 @@ void Game::setGroundPosition(float x1, float y1, float x2, float y2) {
     createGround(x1, y1, x2, y2);  // Recreate the ground with new positions
 }
 
-// === Lure Position Handling ===
-
-// Creates the throwable object (e.g., a Lure)
-void Game::createThrowableBody() {
-    // Define the throwable object's body
-    b2BodyDef bodyDef;
-    bodyDef.type = b2_kinematicBody;  // Initially kinematic to prevent free-fall
-    bodyDef.position.Set(0.0f, 0.0f);  // Default initial position
-    throwableBody = world.CreateBody(&bodyDef);  // Add the body to the Box2D world
-
-    // Define the shape of the throwable object as a rectangle
-    b2PolygonShape shape;
-    shape.SetAsBox(0.5f, 0.25f);  // Half-width = 0.5m, Half-height = 0.25m
-
-
-    // Create a fixture to define the object's physical properties
-    b2FixtureDef fixtureDef;
-    fixtureDef.shape = &shape;
-    fixtureDef.density = 1.2f;  // Density affects mass  Heavier objects (higher density)
-    fixtureDef.friction = 0.6f;  // Friction affects sliding
-    fixtureDef.restitution = 0.2f;  // Restitution affects bounciness
-    throwableBody->CreateFixture(&fixtureDef);  // Attach the fixture to the body
+bool Game::loadLakeBed(const QString& fileName) {
+    std::vector<float> heights;
+    float spacing;
+    float originX;
+    if (!LakeTerrain::read(fileName.toStdString(), heights, spacing, originX)) {
+        qDebug() << "Failed to load lake bed" << fileName;
+        return false;
+    }
+    simulation.setLakeBed(std::move(heights), spacing, originX);
+    return true;
 }
 
+// === Lure Position Handling ===
+
 // Function to set the Lure's starting position
 void Game::setBallStartPosition(float x, float y) {
-    throwableBody->SetTransform(b2Vec2(x, y), 0.0f);  // Move the ball to the new position
+    simulation.setStart(b2Vec2(x, y));  // Move the ball and the rod tip to the new position
     startingPosition.Set(x, y);  // Update the starting position
 }
 
@@ -194,7 +226,7 @@ b2Vec2 Game::getTrajectoryPoint(const b2Vec2& startPos, const b2Vec2& startVel,
 
     // Calculate velocity and gravity per time step
     b2Vec2 stepVelocity = t * startVel;  // Velocity at each step
-    b2Vec2 stepGravity = t * t * world.GetGravity();  // Gravity applied at each step
+    b2Vec2 stepGravity = t * t * simulation.getGravity();  // Gravity applied at each step
 
     // Use the physics formula to calculate the trajectory point
     return startPos + step * stepVelocity + 0.5f * (step * step + step) * stepGravity;
@@ -202,104 +234,241 @@ b2Vec2 Game::getTrajectoryPoint(const b2Vec2& startPos, const b2Vec2& startVel,
 
 // === Rendering ===
 
-void Game::paintEvent(QPaintEvent *event) {
-    Q_UNUSED(event);  // Ignore the unused parameter
+Game::~Game() {
+    simulation.stop();
+    makeCurrent();
+    spriteRenderer.release();
+    doneCurrent();
+}
 
-    QPainter painter(this);  // Create a QPainter for drawing
-    painter.setRenderHint(QPainter::Antialiasing);  // Enable smooth rendering
+void Game::initializeGL() {
+    // Without instancing support the sprites are drawn with QPainter
+    if (spriteRenderer.initialize()) {
+        spriteRenderer.setAtlas(atlas.image());
+    }
+}
+
+void Game::resizeGL(int w, int h) {
+    camera.setViewport(w, h);
+    cameraMoved();
+    invalidateBackground();  // The framebuffer is new and the view covers a different part of the lake
+}
+
+// The background shows a different part of the lake now, and the simulation
+// has to stream the lake bed and cull the bodies for the new view
+void Game::cameraMoved() {
+    backgroundValid = false;
+    repaintAll = true;
+    simulation.setView(camera.getViewBounds());
+}
+
+void Game::invalidateBackground() {
+    backgroundValid = false;
+    repaintAll = true;
+    update();
+}
 
-    float scale = 30.0f;  // Convert Box2D meters to pixels (1 meter = 30 pixels)
+// The layers that don't move: sky, water line and lake bed. Drawn at the
+// device pixel ratio so the cache stays sharp on high DPI screens.
+void Game::drawBackground(const std::shared_ptr<const std::vector<b2Vec2>>& lakeBed) {
+    B2_PROFILE_SCOPE("Game::drawBackground");
+
+    qreal pixelRatio = devicePixelRatioF();
+    background = QPixmap(size() * pixelRatio);
+    background.setDevicePixelRatio(pixelRatio);
+    background.fill(Qt::white);
+
+    QPainter painter(&background);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    b2AABB view = camera.getViewBounds();
 
     // === DRAW THE WATER LINE ===
     painter.setPen(QPen(Qt::blue, 3));  // Blue line for water
-    float waterLineY = height() - waterLevel * scale;  // Convert water level to screen Y-coordinate
+    float waterLineY = camera.toScreen(b2Vec2(0.0f, simulation.getWaterLevel())).y();  // Convert water level to screen Y-coordinate
     painter.drawLine(0, waterLineY, width(), waterLineY);
 
-    // === DRAW THE FISHING LINE (DYNAMIC TENSION) ===
-    painter.setPen(QPen(Qt::black, 2));  // Black line with thickness 2
-
-    // Get the start and end points of the fishing line
-    QPointF startPoint(
-        startingPosition.x * scale,
-        height() - startingPosition.y * scale
-        );
-    b2Vec2 lurePosition = throwableBody->GetPosition();
-    QPointF endPoint(
-        lurePosition.x * scale,
-        height() - lurePosition.y * scale
-        );
-
-    // Calculate the distance between start and end points
-    float distance = std::hypot(endPoint.x() - startPoint.x(), endPoint.y() - startPoint.y());
-
-    // Adjust sag based on distance and velocity
-    float maxSag = 50.0f;          // Maximum sag (pixels)
-    float sagDivider = 5.0f;       // Controls how quickly sag increases with distance
-    float sagFactor = std::min(maxSag, distance / sagDivider);
-
-    float maxSpeed = 10.0f;        // Speed at which the line becomes completely taut
-    float lureSpeed = throwableBody->GetLinearVelocity().Length();  // Lure's velocity
-    float velocityFactor = std::max(0.1f, 1.0f - lureSpeed / maxSpeed);  // Scale sag by velocity
-    float dynamicSag = sagFactor * velocityFactor;
-
-    // Control point for bezier curve
-    QPointF controlPoint(
-        (startPoint.x() + endPoint.x()) / 2,           // Midpoint X
-        (startPoint.y() + endPoint.y()) / 2 + dynamicSag  // Midpoint Y with sag
-        );
-
-    // Create a path for the curve
-    QPainterPath path(startPoint);
-    path.quadTo(controlPoint, endPoint);  // Add a quadratic bezier curve
-    painter.drawPath(path);  // Draw the fishing line
-
     // === DRAW THE GROUND ===
     painter.setPen(QPen(Qt::green, 3));  // Green line with thickness 3
 
-    // Get the ground's shape and cast it to b2EdgeShape
-    b2Fixture* groundFixture = groundBody->GetFixtureList();  // Get the ground fixture
-    if (groundFixture != nullptr) {
-        b2EdgeShape* groundShape = dynamic_cast<b2EdgeShape*>(groundFixture->GetShape());
-        if (groundShape != nullptr) {
-            // Access the vertices of the edge shape
-            b2Vec2 groundStart = groundShape->m_vertex1;
-            b2Vec2 groundEnd = groundShape->m_vertex2;
-
-            // Convert Box2D coordinates to screen coordinates and draw the line
-            painter.drawLine(
-                groundStart.x * scale, height() - groundStart.y * scale,  // Starting point of the ground
-                groundEnd.x * scale, height() - groundEnd.y * scale       // Ending point of the ground
-                );
+    // Draw the lake bed samples that are on screen, plus one on each side
+    QPolygonF groundShape;
+    if (lakeBed != nullptr) {
+        auto isLeftOf = [](const b2Vec2& point, float x) { return point.x < x; };
+        auto first = std::lower_bound(lakeBed->begin(), lakeBed->end(), view.lowerBound.x, isLeftOf);
+        auto last = std::lower_bound(first, lakeBed->end(), view.upperBound.x, isLeftOf);
+        if (first != lakeBed->begin()) {
+            --first;
+        }
+        if (last != lakeBed->end()) {
+            ++last;
+        }
+        for (auto point = first; point != last; ++point) {
+            groundShape << camera.toScreen(*point);
         }
     }
+    painter.drawPolyline(groundShape);
 
-    // === DRAW THE Lure OBJECT ===
-    b2Vec2 position = throwableBody->GetPosition();  // Get the position from Box2D
-    float rectWidth  = 1.0f * scale;  // Width of the rectangle in pixels (2x half-width)
-    float rectHeight  = 0.5f * scale;  // Height of the rectangle in pixels (2x half-height)
+    backgroundLakeBed = lakeBed;
+    backgroundValid = true;
+}
 
-    // Calculate the top-left corner of the rectangle
-    QPointF topLeft(
-        position.x * scale - rectWidth / 2,  // X coordinate of the top-left corner
-        height() - position.y * scale - rectHeight / 2  // Y coordinate of the top-left corner
-        );
+QRect Game::dynamicBounds(const SimulationSnapshot& snapshot) const {
+    b2Vec2 lower(FLT_MAX, FLT_MAX);
+    b2Vec2 upper(-FLT_MAX, -FLT_MAX);
+    auto include = [&](const b2Vec2& point, float radius) {
+        lower = b2Min(lower, point - b2Vec2(radius, radius));
+        upper = b2Max(upper, point + b2Vec2(radius, radius));
+    };
+
+    // The half diagonal of a sprite covers it at any angle
+    for (const VisibleBody& body : snapshot.bodies) {
+        if (body.kind == LureBody) {
+            include(body.position, lureHalfSize.Length());
+        } else if (body.kind == FishBody) {
+            include(body.position, fishHalfSize.Length());
+        }
+    }
 
-    // Draw the rectangle image, scaling it to match the rectangle's size
-    painter.drawPixmap(
-        QRectF(topLeft, QSizeF(rectWidth, rectHeight)).toRect(),  // Convert QRectF to QRect
-        ballImage  // Source image
-        );
+    for (const b2Vec2& point : snapshot.linePoints) {
+        include(point, 0.0f);
+    }
+
+    if (isDragging && aimReady) {
+        for (int i = 0; i < 180; ++i) {
+            include(getTrajectoryPoint(startingPosition, initialVelocity, i), 0.0f);
+        }
+    }
+
+    if (lower.x > upper.x) {
+        return QRect();  // Nothing in view
+    }
 
+    // A few pixels more for the pen widths and antialiasing
+    QPointF topLeft = camera.toScreen(b2Vec2(lower.x, upper.y));
+    QPointF bottomRight = camera.toScreen(b2Vec2(upper.x, lower.y));
+    QRect bounds(QPoint(static_cast<int>(std::floor(topLeft.x())) - 3,
+                        static_cast<int>(std::floor(topLeft.y())) - 3),
+                 QPoint(static_cast<int>(std::ceil(bottomRight.x())) + 3,
+                        static_cast<int>(std::ceil(bottomRight.y())) + 3));
+    return bounds.intersected(rect());
+}
+
+void Game::paintGL() {
+    B2_PROFILE_SCOPE("Game::paintGL");
+
+    // The newest physics step, the simulation keeps stepping while it is drawn
+    SimulationSnapshot& snapshot = simulation.latest();
+
+    // The first snapshot after the Hold shows where the lure stopped
+    if (isDragging && !aimReady && snapshot.holdCount == heldAt) {
+        startingPosition = snapshot.lurePosition;
+        aimReady = true;
+    }
+
+    // Keep the lure in view, unless the user panned away from it
+    if (camera.isFollowing() && !isDragging && snapshot.stepCount >= 0 && camera.follow(snapshot.lurePosition)) {
+        cameraMoved();
+    }
+
+    if (!backgroundValid || snapshot.lakeBed != backgroundLakeBed) {
+        drawBackground(snapshot.lakeBed);
+        repaintAll = true;
+    }
+
+    // The framebuffer still holds the last frame. Repaint where the moving
+    // parts were and where they are now, the rest of the widget is unchanged.
+    QRect dynamicRect = dynamicBounds(snapshot);
+    QRect dirtyRect = dynamicRect.united(lastDynamicRect);
+    lastDynamicRect = dynamicRect;
+    if (repaintAll || showDebugDraw) {
+        dirtyRect = rect();
+        repaintAll = false;
+    }
+
+    QPainter painter(this);  // Create a QPainter for drawing
+    painter.setRenderHint(QPainter::Antialiasing);  // Enable smooth rendering
+    painter.setClipRect(dirtyRect);
+    painter.drawPixmap(0, 0, background);  // Also clears what moved away
+
+    if (snapshot.stepCount < 0) {
+        return;  // The simulation hasn't published anything yet
+    }
+
+    // === DRAW THE FISHING LINE ===
+    painter.setPen(QPen(Qt::black, 2));  // Black line with thickness 2
+
+    // The line is simulated on the physics thread, draw it as a polyline through its points
+    QPolygonF lineShape;
+    for (const b2Vec2& point : snapshot.linePoints) {
+        lineShape << camera.toScreen(point);
+    }
+    painter.drawPolyline(lineShape);
+
+    // === DRAW THE Lure OBJECT ===
+    // Only the bodies in view are in the snapshot, the rest costs nothing here
+    if (spriteRenderer.isReady()) {
+        // The sprites of all bodies go to the GPU in one instanced draw call
+        for (const VisibleBody& body : snapshot.bodies) {
+            if (body.kind == LureBody) {
+                spriteRenderer.addSprite(body.position, body.angle, lureHalfSize, atlas.sourceRect(lureSprite));
+            } else if (body.kind == FishBody) {
+                spriteRenderer.addSprite(body.position, body.angle, fishSpriteSize(body.angle), atlas.sourceRect(fishSprite));
+            }
+        }
+        painter.beginNativePainting();
+        spriteRenderer.draw(camera);
+        painter.endNativePainting();
+    } else {
+        float rectWidth  = 2.0f * lureHalfSize.x * camera.getZoom();  // Width of the rectangle in pixels
+        float rectHeight  = 2.0f * lureHalfSize.y * camera.getZoom();  // Height of the rectangle in pixels
+        int pixelWidth = static_cast<int>(std::ceil(rectWidth * devicePixelRatioF()));
+
+        float fishWidth = 2.0f * fishHalfSize.x * camera.getZoom();
+        float fishHeight = 2.0f * fishHalfSize.y * camera.getZoom();
+        int fishPixelWidth = static_cast<int>(std::ceil(fishWidth * devicePixelRatioF()));
+        const QPixmap& fishPixmap = atlas.pixmap(fishSprite, fishPixelWidth);
+
+        for (const VisibleBody& body : snapshot.bodies) {
+            if (body.kind == FishBody) {
+                // Rotated around its center, screen Y points down so the angle is negated
+                QPointF center = camera.toScreen(body.position);
+                b2Vec2 size = fishSpriteSize(body.angle);
+                painter.save();
+                painter.translate(center);
+                painter.rotate(-body.angle * 180.0f / b2_pi);
+                painter.scale(1.0, size.y < 0.0f ? -1.0 : 1.0);
+                painter.drawPixmap(QRectF(-0.5f * fishWidth, -0.5f * fishHeight, fishWidth, fishHeight).toRect(), fishPixmap);
+                painter.restore();
+                continue;
+            }
+            if (body.kind != LureBody) {
+                continue;
+            }
+
+            // Calculate the top-left corner of the rectangle
+            QPointF center = camera.toScreen(body.position);
+            QPointF topLeft(center.x() - rectWidth / 2, center.y() - rectHeight / 2);
+
+            // Draw the pre-scaled mip level closest to the rectangle's size, so the
+            // frame never scales the full size image
+            QRect target = QRectF(topLeft, QSizeF(rectWidth, rectHeight)).toRect();
+            painter.drawPixmap(target, atlas.pixmap(lureSprite, pixelWidth));
+        }
+    }
 
     // === DRAW THE TRAJECTORY (IF DRAGGING) ===
-    if (isDragging) {
+    if (isDragging && aimReady) {
         painter.setPen(QPen(Qt::red, 2));  // Red line with thickness 2
         for (int i = 0; i < 180; ++i) {  // Predict the trajectory for 3 seconds (180 steps)
             b2Vec2 trajectoryPoint = getTrajectoryPoint(startingPosition, initialVelocity, i);
-            float x = trajectoryPoint.x * scale;  // Convert X-coordinate to pixels
-            float y = height() - trajectoryPoint.y * scale;  // Convert Y-coordinate to pixels
-            painter.drawPoint(QPointF(x, y));  // Draw a red point at the trajectory position
+            painter.drawPoint(camera.toScreen(trajectoryPoint));  // Draw a red point at the trajectory position
         }
     }
+
+    // === DRAW THE PHYSICS DEBUG OVERLAY ===
+    if (showDebugDraw && snapshot.hasDebugDraw) {
+        snapshot.debugDraw.flush(painter, camera.getTransform());  // Collected by the physics thread
+    }
 }
 
@@ -1,16 +1,23 @@
 #ifndef GAME_H
 #define GAME_H
 
-#include <QWidget>
+#include <QOpenGLWidget>
 #include <Box2D/Box2D.h>
 #include <QPixmap>
+#include <memory>
+#include "Simulation.h"
+#include "SpriteRenderer.h"
+#include "Camera.h"
+#include "SpriteAtlas.h"
 
-// The Game class handles the physics simulation and rendering of the game.
-class Game : public QWidget {
+// The Game class handles the input and rendering of the game. The physics
+// runs on its own thread in Simulation, the game draws its newest snapshot.
+class Game : public QOpenGLWidget {
     Q_OBJECT
 
 public:
     explicit Game(QWidget *parent = nullptr);  // Constructor
+    ~Game() override;  // Releases the GL objects while the context still exists
 
     // Setter function to modify the ball's starting position
     void setBallStartPosition(float x, float y);
@@ -18,40 +25,58 @@ public:
     // Setter function to modify the ground's position
     void setGroundPosition(float x1, float y1, float x2, float y2);
 
+    // Load the lake bed from a heightfield file, see LakeTerrain. The file is
+    // read right away, the simulation switches to it before its next step.
+    bool loadLakeBed(const QString& fileName);
+
 protected:
-    // Qt event to handle rendering
-    void paintEvent(QPaintEvent *event) override;
+    // OpenGL callbacks, paintGL draws the frame with QPainter and the sprites with GL
+    void initializeGL() override;
+    void resizeGL(int w, int h) override;
+    void paintGL() override;
 
     // Mouse events for interacting with the game
     void mousePressEvent(QMouseEvent *event) override;  // When the mouse button is pressed
     void mouseMoveEvent(QMouseEvent *event) override;   // When the mouse is moved
     void mouseReleaseEvent(QMouseEvent *event) override;  // When the mouse button is released
+    void wheelEvent(QWheelEvent *event) override;  // Reels the line in and out
+    void keyPressEvent(QKeyEvent *event) override;  // D toggles the physics debug overlay, F follows the lure
 
 private:
-    b2World world;  // The Box2D world where physics simulation happens
-    b2Body* throwableBody;  // The throwable object (e.g., a ball)
-    b2Body* groundBody;  // The static ground object
+    Simulation simulation;  // The physics, stepped on its own thread
+    SpriteRenderer spriteRenderer;  // Draws the lure and fish sprites in one instanced call
+    Camera camera;  // Which part of the lake is on screen, all meter to pixel conversions go through it
+    bool showDebugDraw;  // Whether the debug overlay is drawn
 
     b2Vec2 startingPosition;  // Starting position of the throwable object
     b2Vec2 initialVelocity;  // Initial velocity when the object is thrown
     b2Vec2 dragStart;  // Starting point of the drag (mouse press)
     b2Vec2 dragEnd;  // Ending point of the drag (mouse release)
-    QPixmap ballImage;  // Image to represent the ball
+    SpriteAtlas atlas;  // Lure and fish images, decoded and packed on first use
+    int lureSprite;  // Sprite id of the lure in the atlas
+    int fishSprite;
+    QPixmap background;  // Water line and lake bed, only redrawn when they change
+    std::shared_ptr<const std::vector<b2Vec2>> backgroundLakeBed;  // The lake bed drawn into background
+    bool backgroundValid;  // False when background has to be redrawn
+    bool repaintAll;  // The next frame repaints the whole widget, not only what moved
+    QRect lastDynamicRect;  // Where the moving parts were drawn in the last frame
 
     bool isDragging;  // Flag to check if the user is currently dragging
+    int heldAt;  // Hold number of the throw being aimed
+    bool aimReady;  // startingPosition is where the physics held the lure
+    bool isPanning;  // The view is dragged with the right button
+    QPointF lastPanPosition;  // Mouse position of the last pan step
 
-    void createThrowableBody();  // Function to create the throwable object
     void createGround(float x1, float y1, float x2, float y2);  // Function to create the static ground
+    void processLureEvents();  // Log what happened to the lure in the water
+    void drawBackground(const std::shared_ptr<const std::vector<b2Vec2>>& lakeBed);  // Redraw the static layers into the background pixmap
+    void invalidateBackground();  // Redraw the background and the whole widget in the next frame
+    void cameraMoved();  // Tell the background and the simulation about the new view
+    QRect dynamicBounds(const SimulationSnapshot& snapshot) const;  // Screen area covered by the lure, the line and the trajectory
     b2Vec2 getTrajectoryPoint(const b2Vec2& startPos, const b2Vec2& startVel, float step) const;
     // Helper function to calculate the trajectory points
 
     std::vector<b2Vec2> trajectoryPoints;  // Store trajectory points
-    float   waterLevel; // Water level
-    float targetDepth;  // Target depth where the lure will stop
-    void updateLureInWater(); //Water Resistance
-    void applyWaterResistance();
-    void stopLureAtDepth();
-    bool isInWater;
 };
 
 #endif // GAME_H
@@ -0,0 +1,278 @@
+#include "LakeTerrain.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+// File layout, all values little endian whatever the machine:
+//   char     magic[4]    "LAKE"
+//   uint32   version     1
+//   uint32   count       number of samples
+//   float    spacing     distance between samples
+//   float    originX     X of the first sample
+//   float    baseHeight  height of step 0
+//   float    heightStep  height of one step
+//   int16    steps[count]
+const char fileMagic[4] = { 'L', 'A', 'K', 'E' };
+const uint32_t fileVersion = 1;
+const size_t headerSize = 28;
+
+// Larger counts are a corrupt file, not a lake: 16M samples is 8000 km at half meter spacing
+const uint32_t maxSampleCount = 1u << 24;
+
+uint32_t readUint32(const unsigned char* bytes) {
+    return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+}
+
+float readFloat(const unsigned char* bytes) {
+    uint32_t bits = readUint32(bytes);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void writeUint32(unsigned char* bytes, uint32_t value) {
+    bytes[0] = static_cast<unsigned char>(value);
+    bytes[1] = static_cast<unsigned char>(value >> 8);
+    bytes[2] = static_cast<unsigned char>(value >> 16);
+    bytes[3] = static_cast<unsigned char>(value >> 24);
+}
+
+void writeFloat(unsigned char* bytes, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeUint32(bytes, bits);
+}
+
+}
+
+LakeTerrain::LakeTerrain()
+    : world(nullptr),
+    body(nullptr),
+    chunkSegments(64),
+    spacing(1.0f),
+    originX(0.0f),
+    loadedFirst(0),
+    loadedLast(-1),
+    loadedChunkCount(0) {
+}
+
+void LakeTerrain::create(b2World* world, int chunkSegments) {
+    this->world = world;
+    this->chunkSegments = std::max(chunkSegments, 1);
+
+    b2BodyDef bodyDef;  // Static, at the origin
+    body = world->CreateBody(&bodyDef);
+}
+
+void LakeTerrain::setHeights(const std::vector<float>& heights, float spacing, float originX) {
+    unloadAll();
+
+    this->heights = heights;
+    this->spacing = spacing;
+    this->originX = originX;
+
+    int segmentCount = std::max(getPointCount() - 1, 0);
+    int chunkCount = (segmentCount + chunkSegments - 1) / chunkSegments;
+    chunks.assign(chunkCount, nullptr);
+}
+
+bool LakeTerrain::load(const std::string& fileName) {
+    std::vector<float> values;
+    float spacing;
+    float originX;
+    if (!read(fileName, values, spacing, originX)) {
+        return false;
+    }
+    setHeights(values, spacing, originX);
+    return true;
+}
+
+bool LakeTerrain::read(const std::string& fileName, std::vector<float>& heights, float& spacing, float& originX) {
+    std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::streamoff fileSize = file.tellg();
+    file.seekg(0);
+
+    unsigned char header[headerSize];
+    if (!file.read(reinterpret_cast<char*>(header), headerSize)
+        || std::memcmp(header, fileMagic, sizeof(fileMagic)) != 0
+        || readUint32(header + 4) != fileVersion) {
+        return false;
+    }
+
+    uint32_t count = readUint32(header + 8);
+    float fileSpacing = readFloat(header + 12);
+    float fileOriginX = readFloat(header + 16);
+    float baseHeight = readFloat(header + 20);
+    float heightStep = readFloat(header + 24);
+
+    // Check the count against what is in the file before allocating for it
+    if (count < 2 || count > maxSampleCount
+        || fileSize - static_cast<std::streamoff>(headerSize) < static_cast<std::streamoff>(count) * 2
+        || !(fileSpacing > 0.0f)) {
+        return false;
+    }
+
+    std::vector<unsigned char> steps(count * 2);
+    if (!file.read(reinterpret_cast<char*>(steps.data()), steps.size())) {
+        return false;
+    }
+
+    heights.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        int16_t step = static_cast<int16_t>(steps[2 * i] | steps[2 * i + 1] << 8);
+        heights[i] = baseHeight + heightStep * step;
+    }
+    spacing = fileSpacing;
+    originX = fileOriginX;
+    return true;
+}
+
+bool LakeTerrain::save(const std::string& fileName, float heightStep) const {
+    if (heights.size() < 2 || heights.size() > maxSampleCount || !(heightStep > 0.0f)) {
+        return false;
+    }
+
+    // Center the range of heights on step 0
+    auto range = std::minmax_element(heights.begin(), heights.end());
+    float baseHeight = 0.5f * (*range.first + *range.second);
+    if ((*range.second - baseHeight) / heightStep > INT16_MAX) {
+        return false;  // Heights don't fit in 16 bits with this step
+    }
+
+    unsigned char header[headerSize];
+    std::memcpy(header, fileMagic, sizeof(fileMagic));
+    writeUint32(header + 4, fileVersion);
+    writeUint32(header + 8, static_cast<uint32_t>(heights.size()));
+    writeFloat(header + 12, spacing);
+    writeFloat(header + 16, originX);
+    writeFloat(header + 20, baseHeight);
+    writeFloat(header + 24, heightStep);
+
+    std::vector<unsigned char> steps(heights.size() * 2);
+    for (size_t i = 0; i < heights.size(); ++i) {
+        uint16_t step = static_cast<uint16_t>(static_cast<int16_t>(std::lround((heights[i] - baseHeight) / heightStep)));
+        steps[2 * i] = static_cast<unsigned char>(step);
+        steps[2 * i + 1] = static_cast<unsigned char>(step >> 8);
+    }
+
+    std::ofstream file(fileName, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(header), headerSize);
+    file.write(reinterpret_cast<const char*>(steps.data()), steps.size());
+    return static_cast<bool>(file);
+}
+
+float LakeTerrain::getMaxX() const {
+    return originX + std::max(getPointCount() - 1, 0) * spacing;
+}
+
+float LakeTerrain::getHeight(float x) const {
+    if (heights.empty()) {
+        return 0.0f;
+    }
+
+    float u = (x - originX) / spacing;
+    int last = getPointCount() - 1;
+    if (u <= 0.0f) {
+        return heights.front();
+    }
+    if (u >= last) {
+        return heights.back();
+    }
+
+    int i = static_cast<int>(u);
+    float t = u - i;
+    return (1.0f - t) * heights[i] + t * heights[i + 1];
+}
+
+int LakeTerrain::chunkAt(float x) const {
+    float u = (x - originX) / (spacing * chunkSegments);
+    int last = getChunkCount() - 1;
+    return std::max(0, std::min(static_cast<int>(std::floor(u)), last));
+}
+
+void LakeTerrain::stream(float minX, float maxX) {
+    if (body == nullptr || chunks.empty()) {
+        return;
+    }
+
+    int first = chunkAt(minX);
+    int last = chunkAt(maxX);
+
+    // Keep one extra chunk on each side so moving back and forth across a
+    // chunk border doesn't create and destroy the same fixture every step
+    int keepFirst = first - 1;
+    int keepLast = last + 1;
+
+    // The loaded chunks are always one contiguous range, only the chunks in
+    // the old and the new range are visited
+    for (int chunk = loadedFirst; chunk <= loadedLast; ++chunk) {
+        if (chunk < keepFirst || chunk > keepLast) {
+            unloadChunk(chunk);
+        }
+    }
+
+    for (int chunk = first; chunk <= last; ++chunk) {
+        loadChunk(chunk);
+    }
+
+    int keptFirst = std::max(loadedFirst, keepFirst);
+    int keptLast = std::min(loadedLast, keepLast);
+    if (keptFirst <= keptLast) {
+        loadedFirst = std::min(keptFirst, first);
+        loadedLast = std::max(keptLast, last);
+    } else {
+        loadedFirst = first;
+        loadedLast = last;
+    }
+}
+
+void LakeTerrain::loadChunk(int chunk) {
+    if (chunks[chunk] != nullptr) {
+        return;
+    }
+
+    int first = chunk * chunkSegments;
+    int last = std::min(first + chunkSegments, getPointCount() - 1);
+
+    b2HeightfieldShape shape;
+    shape.Create(&heights[first], last - first + 1, originX + first * spacing, spacing);
+
+    // Ghost samples from the neighboring chunks
+    if (first > 0) {
+        shape.SetPrevHeight(heights[first - 1]);
+    }
+    if (last < getPointCount() - 1) {
+        shape.SetNextHeight(heights[last + 1]);
+    }
+
+    b2FixtureDef fixtureDef;
+    fixtureDef.shape = &shape;
+    fixtureDef.friction = 0.6f;
+    chunks[chunk] = body->CreateFixture(&fixtureDef);
+    ++loadedChunkCount;
+}
+
+void LakeTerrain::unloadChunk(int chunk) {
+    if (chunks[chunk] == nullptr) {
+        return;
+    }
+
+    body->DestroyFixture(chunks[chunk]);
+    chunks[chunk] = nullptr;
+    --loadedChunkCount;
+}
+
+void LakeTerrain::unloadAll() {
+    for (int chunk = loadedFirst; chunk <= loadedLast; ++chunk) {
+        unloadChunk(chunk);
+    }
+    loadedFirst = 0;
+    loadedLast = -1;
+}
@@ -0,0 +1,72 @@
+#ifndef LAKETERRAIN_H
+#define LAKETERRAIN_H
+
+#include <Box2D/Box2D.h>
+#include <string>
+#include <vector>
+
+// The lake bed and shoreline as a heightfield: one height per sample, samples
+// evenly spaced along X.
+//
+// The heightfield is split into chunks of chunkSegments segments. Each chunk
+// becomes a b2HeightfieldShape fixture only while it is near the area passed
+// to stream(), so the broad-phase only ever holds the few chunks around the
+// action no matter how long the level is. A chunk is a single broad-phase
+// proxy, and a body resting on it has a single contact. Chunks are linked
+// with ghost samples so bodies slide smoothly from one chunk to the next.
+class LakeTerrain {
+public:
+    LakeTerrain();
+
+    // Create the static body that holds the chunk fixtures
+    void create(b2World* world, int chunkSegments = 64);
+
+    // Replace the heightfield. All loaded chunks are unloaded.
+    void setHeights(const std::vector<float>& heights, float spacing, float originX);
+
+    // Load or save a heightfield file. Heights are stored as 16 bit steps of
+    // a fixed size above a base height, so a kilometre at half meter spacing
+    // takes 4 KB.
+    bool load(const std::string& fileName);
+    bool save(const std::string& fileName, float heightStep = 0.01f) const;
+
+    // Only decode a heightfield file, nothing in the world is touched
+    static bool read(const std::string& fileName, std::vector<float>& heights, float& spacing, float& originX);
+
+    // Make sure the chunks overlapping [minX, maxX] have fixtures and remove
+    // the fixtures of chunks that are more than one chunk away
+    void stream(float minX, float maxX);
+
+    // Height of the bed at x, linearly interpolated between samples
+    float getHeight(float x) const;
+
+    int getPointCount() const { return static_cast<int>(heights.size()); }
+    b2Vec2 getPoint(int index) const { return b2Vec2(originX + index * spacing, heights[index]); }
+    float getSpacing() const { return spacing; }
+    float getMinX() const { return originX; }
+    float getMaxX() const;
+
+    int getChunkCount() const { return static_cast<int>(chunks.size()); }
+    int getLoadedChunkCount() const { return loadedChunkCount; }
+
+    b2Body* getBody() const { return body; }
+
+private:
+    void loadChunk(int chunk);
+    void unloadChunk(int chunk);
+    void unloadAll();
+    int chunkAt(float x) const;
+
+    b2World* world;
+    b2Body* body;
+    int chunkSegments;  // Segments per chunk
+    std::vector<float> heights;
+    float spacing;
+    float originX;
+    std::vector<b2Fixture*> chunks;  // Fixture per chunk, nullptr when not loaded
+    int loadedFirst;  // Range of chunks that may have fixtures
+    int loadedLast;
+    int loadedChunkCount;
+};
+
+#endif // LAKETERRAIN_H
@@ -0,0 +1,428 @@
+#include "Simulation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+const int fishCount = 2000;  // Fish in the lake, the school handles 5000 within a step
+const int fishBodyCount = 256;  // At most this many fish near the lure are bodies
+
+}
+
+Simulation::Simulation(const b2Vec2& startPosition)
+    : gravity(0.0f, -10.0f),  // Gravity (-10 m/s²)
+    waterLevel(7.0f),  // Water level set to Y = 7.0
+    targetDepth(3.0f),
+    world(gravity, &worldMemory),
+    throwableBody(nullptr),
+    water(nullptr),
+    rodTip(startPosition),
+    stepCount(0),
+    holdCount(0),
+    holding(false),
+    isInWater(false),
+    debugDrawEnabled(false),
+    holdsPosted(0),
+    running(false) {
+
+    viewBounds.lowerBound.SetZero();  // Nothing until the GUI sends its view
+    viewBounds.upperBound.SetZero();
+
+    // The lake bed body, the heights come with the first SetLakeBed command
+    terrain.create(&world);
+
+    // Create the water before the bodies that float in it
+    createWater();
+
+    // Create the throwable object (e.g., a ball)
+    createThrowableBody();
+    throwableBody->SetTransform(startPosition, 0.0f);
+
+    // Up to 25 meters of line in 10 cm segments
+    fishingLine.create(256, 0.1f, rodTip, throwableBody);
+
+    // The fish stay between the lake bed and the surface
+    fishSchool.setWater(&terrain, waterLevel);
+    fishLod.create(&world, fishBodyCount, reinterpret_cast<void*>(static_cast<intptr_t>(FishBody)));
+
+    // Size the world up front so stepping it never touches the heap. Each
+    // fish body touches the water and maybe the lure or the lake bed.
+    world.Reserve(64 + fishBodyCount, 16, 256 + 2 * fishBodyCount, 128 + fishBodyCount);
+}
+
+Simulation::~Simulation() {
+    stop();
+}
+
+void Simulation::start() {
+    if (!running.exchange(true)) {
+        thread = std::thread(&Simulation::run, this);
+    }
+}
+
+void Simulation::stop() {
+    if (running.exchange(false)) {
+        thread.join();
+    }
+}
+
+// === Commands ===
+
+void Simulation::post(SimulationCommand command) {
+    // Commands that didn't fit earlier go first, so the order is kept
+    flushCommands();
+    if (!overflow.empty() || !commands.push(std::move(command))) {
+        overflow.push_back(std::move(command));  // Not moved from when push fails
+    }
+}
+
+void Simulation::flushCommands() {
+    while (!overflow.empty() && commands.push(std::move(overflow.front()))) {
+        overflow.pop_front();
+    }
+}
+
+// The view changes with every frame while panning or following the lure, only
+// the newest one matters
+void Simulation::setView(const b2AABB& bounds) {
+    views.writeBuffer() = bounds;
+    views.publish();
+}
+
+void Simulation::setStart(const b2Vec2& position) {
+    SimulationCommand command;
+    command.type = SimulationCommand::SetStart;
+    command.vector = position;
+    post(std::move(command));
+}
+
+void Simulation::setLakeBed(std::vector<float> heights, float spacing, float originX) {
+    SimulationCommand command;
+    command.type = SimulationCommand::SetLakeBed;
+    command.heights = std::move(heights);
+    command.value = spacing;
+    command.vector.Set(originX, 0.0f);
+    post(std::move(command));
+}
+
+int Simulation::hold() {
+    SimulationCommand command;
+    command.type = SimulationCommand::Hold;
+    post(std::move(command));
+    return ++holdsPosted;  // Commands are never dropped, so the physics counts the same
+}
+
+void Simulation::throwLure(const b2Vec2& velocity) {
+    SimulationCommand command;
+    command.type = SimulationCommand::Throw;
+    command.vector = velocity;
+    post(std::move(command));
+}
+
+void Simulation::reel(float delta) {
+    SimulationCommand command;
+    command.type = SimulationCommand::Reel;
+    command.value = delta;
+    post(std::move(command));
+}
+
+void Simulation::setDebugDraw(bool flag) {
+    SimulationCommand command;
+    command.type = SimulationCommand::SetDebugDraw;
+    command.value = flag ? 1.0f : 0.0f;
+    post(std::move(command));
+}
+
+void Simulation::execute(SimulationCommand& command) {
+    switch (command.type) {
+    case SimulationCommand::SetStart:
+        throwableBody->SetTransform(command.vector, 0.0f);  // Move the lure to the new position
+        rodTip = command.vector;  // The rod is held where the lure is thrown from
+        fishingLine.setRodTip(rodTip);
+        break;
+    case SimulationCommand::SetLakeBed: {
+        // Only the terrain fixtures are replaced, the ground body stays
+        float originX = command.vector.x;
+        terrain.setHeights(command.heights, command.value, originX);
+
+        // The snapshots share the samples until the next lake bed
+        auto points = std::make_shared<std::vector<b2Vec2>>();
+        points->reserve(terrain.getPointCount());
+        for (int i = 0; i < terrain.getPointCount(); ++i) {
+            points->push_back(terrain.getPoint(i));
+        }
+        lakeBed = std::move(points);
+        streamTerrain();
+
+        // A new lake gets new fish
+        fishLod.reset();
+        fishSchool.spawn(fishCount);
+        break;
+    }
+    case SimulationCommand::Hold:
+        holding = true;
+        ++holdCount;
+        break;
+    case SimulationCommand::Throw:
+        holding = false;
+        throwableBody->SetType(b2_dynamicBody);  // Change the body type to dynamic (affected by gravity)
+        throwableBody->SetGravityScale(1.0f);  // Undo stopLureAtDepth
+        water->AddBody(throwableBody);  // Let the water act on the lure again
+        throwableBody->SetLinearVelocity(command.vector);  // Apply the calculated velocity to the object
+        fishingLine.setFreeSpool(true);  // Let the lure pull line off the reel
+        break;
+    case SimulationCommand::Reel:
+        fishingLine.reel(command.value);
+        break;
+    case SimulationCommand::SetDebugDraw:
+        debugDrawEnabled = command.value != 0.0f;
+        break;
+    }
+}
+
+// === Stepping ===
+
+void Simulation::run() {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(timeStep));
+
+    // Apply the setup commands and show the world before the first step
+    SimulationCommand command;
+    while (commands.pop(command)) {
+        execute(command);
+    }
+    publish();
+
+    // Each step has a deadline one period after the last one, not after the
+    // last step finished, so the rate doesn't drift and a slow step is made
+    // up for by the next ones
+    Clock::time_point deadline = Clock::now();
+    while (running.load(std::memory_order_relaxed)) {
+        deadline += period;
+        std::this_thread::sleep_until(deadline);
+        tick();
+
+        // After a long stall (debugger, suspended machine) carry on from now
+        // instead of running a burst of steps to catch up
+        Clock::time_point now = Clock::now();
+        if (now - deadline > 4 * period) {
+            deadline = now;
+        }
+    }
+}
+
+void Simulation::tick() {
+    B2_PROFILE_SCOPE("Simulation::tick");
+
+    bool changed = false;
+    if (views.hasNew()) {
+        viewBounds = views.read();
+        changed = true;
+    }
+
+    SimulationCommand command;
+    while (commands.pop(command)) {
+        execute(command);
+        changed = true;
+    }
+
+    if (!holding) {  // Only update the physics when the object is not being dragged
+        streamTerrain();  // Make sure the lake bed under the lure has fixtures
+        fishLod.update(fishSchool, throwableBody->GetPosition());  // Only the fish near the lure are bodies
+        world.Step(timeStep, 6, 2);  // Step the physics simulation forward by 1/60th of a second
+        fishLod.sync(fishSchool);  // Collisions moved the fish with bodies
+        waterVolume.endStep();  // Queue the water events for this step
+        world.ClearSensorEvents();  // The water was the only reader
+        processWaterEvents();  // Stop the lure at the target depth
+        fishingLine.step(timeStep, 8);  // Move the line and let it pull on the lure
+        fishSchool.setLure(throwableBody->GetPosition(), throwableBody->GetLinearVelocity(), isInWater);
+        fishSchool.step(timeStep);  // Let the fish react to the lure
+        ++stepCount;
+        changed = true;
+    }
+
+    // Nothing moves while a throw is aimed, the GUI keeps the last snapshot
+    if (changed) {
+        publish();
+    }
+}
+
+void Simulation::publish() {
+    SimulationSnapshot& snapshot = snapshots.writeBuffer();
+    snapshot.stepCount = stepCount;
+    snapshot.holdCount = holdCount;
+    snapshot.lurePosition = throwableBody->GetPosition();
+    snapshot.lureAngle = throwableBody->GetAngle();
+    snapshot.lureInWater = isInWater;
+    snapshot.linePoints.assign(fishingLine.getPoints(), fishingLine.getPoints() + fishingLine.getPointCount());
+    snapshot.lakeBed = lakeBed;
+    findVisibleBodies(snapshot.bodies);
+    findVisibleFish(snapshot.bodies);
+
+    // The shapes in view are collected here, the GUI only draws them
+    snapshot.hasDebugDraw = debugDrawEnabled;
+    if (debugDrawEnabled) {
+        snapshot.debugDraw.SetFlags(b2Draw::e_shapeBit | b2Draw::e_jointBit);
+        snapshot.debugDraw.clear();
+        world.SetDebugDraw(&snapshot.debugDraw);
+        world.DrawDebugData(viewBounds);
+    }
+
+    snapshots.publish();
+}
+
+// Collects the bodies of the fixtures the broad-phase finds in an area
+class BodyQuery : public b2QueryCallback {
+public:
+    explicit BodyQuery(std::vector<b2Body*>& bodies) : bodies(bodies) {}
+
+    bool ReportFixture(b2Fixture* fixture) override {
+        b2Body* body = fixture->GetBody();
+        // Fish are drawn from the school, with or without a body
+        void* userData = body->GetUserData();
+        if (body->GetType() != b2_staticBody && userData != nullptr &&
+            userData != reinterpret_cast<void*>(static_cast<intptr_t>(FishBody))) {
+            bodies.push_back(body);
+        }
+        return true;  // Keep going
+    }
+
+private:
+    std::vector<b2Body*>& bodies;
+};
+
+// Only the bodies in view go to the GUI, so a long cast over a large lake
+// doesn't cost anything for what is off screen
+void Simulation::findVisibleBodies(std::vector<VisibleBody>& bodies) {
+    visibleBodies.clear();
+    BodyQuery query(visibleBodies);
+    world.QueryAABB(&query, viewBounds);
+
+    // A body is reported once for each of its fixtures in view
+    std::sort(visibleBodies.begin(), visibleBodies.end());
+    visibleBodies.erase(std::unique(visibleBodies.begin(), visibleBodies.end()), visibleBodies.end());
+
+    bodies.clear();
+    for (b2Body* body : visibleBodies) {
+        VisibleBody visible;
+        visible.position = body->GetPosition();
+        visible.angle = body->GetAngle();
+        visible.kind = static_cast<BodyKind>(reinterpret_cast<intptr_t>(body->GetUserData()));
+        bodies.push_back(visible);
+    }
+}
+
+// Adds the fish in view to bodies. A fish faces the way it swims.
+void Simulation::findVisibleFish(std::vector<VisibleBody>& bodies) {
+    // A fish whose center is just outside the view can still show its head or tail
+    b2Vec2 margin(0.5f, 0.5f);
+    b2Vec2 lower = viewBounds.lowerBound - margin;
+    b2Vec2 upper = viewBounds.upperBound + margin;
+
+    for (int i = 0; i < fishSchool.getCount(); ++i) {
+        b2Vec2 position = fishSchool.getPosition(i);
+        if (position.x < lower.x || position.y < lower.y || position.x > upper.x || position.y > upper.y) {
+            continue;
+        }
+
+        b2Vec2 velocity = fishSchool.getVelocity(i);
+        VisibleBody visible;
+        visible.position = position;
+        visible.angle = std::atan2(velocity.y, velocity.x);
+        visible.kind = FishBody;
+        bodies.push_back(visible);
+    }
+}
+
+// Only the chunks of the lake bed under the view and near the lure get
+// fixtures, so the size of the lake doesn't affect the cost of a step
+void Simulation::streamTerrain() {
+    float margin = 5.0f;  // Load a bit more than needed so bodies never hit missing ground
+    b2Vec2 lurePosition = throwableBody->GetPosition();
+    float minX = std::min(viewBounds.lowerBound.x, lurePosition.x);
+    float maxX = std::max(viewBounds.upperBound.x, lurePosition.x);
+    terrain.stream(minX - margin, maxX + margin);
+}
+
+// === Water Resistance, Target Depth, and Detection ===
+
+// Creates the buoyancy controller. Buoyancy and drag are applied as forces during
+// world.Step, so they work for any number of bodies and don't depend on the frame rate.
+void Simulation::createWater() {
+    b2BuoyancyControllerDef waterDef;
+    waterDef.normal.Set(0.0f, 1.0f);  // Water surface faces up
+    waterDef.offset = waterLevel;     // Surface height
+    waterDef.density = 1.0f;          // Lure (1.2) sinks slowly, lighter bodies float
+    waterDef.linearDrag = 2.0f;       // Drag proportional to speed
+    waterDef.quadraticDrag = 1.0f;    // Drag proportional to speed squared
+    waterDef.angularDrag = 1.0f;      // Slows down spinning
+    water = static_cast<b2BuoyancyController*>(world.CreateController(&waterDef));
+
+    // The sensor covers the whole lake below the surface
+    waterVolume.create(&world, -1000.0f, 1000.0f, -100.0f, waterLevel);
+    waterVolume.setTargetDepth(targetDepth);
+}
+
+// Reacts to the water events collected during the last world step and passes
+// the ones of the lure on to the GUI
+void Simulation::processWaterEvents() {
+    for (const WaterEvent& event : waterVolume.getEvents()) {
+        if (event.body != throwableBody) {
+            continue;  // Only the lure is handled for now
+        }
+
+        switch (event.type) {
+        case WaterEvent::Entered:
+            isInWater = true;  // Mark the lure as in water
+            fishingLine.setFreeSpool(false);  // Close the bail, line out is fixed from now on
+            break;
+        case WaterEvent::Exited:
+            isInWater = false;  // Mark the lure as out of water
+            break;
+        case WaterEvent::ReachedDepth:
+            stopLureAtDepth();  // Stop the lure at the target depth
+            break;
+        }
+
+        // The GUI only logs them, an event is dropped if it doesn't keep up
+        lureEvents.push(event.type);
+    }
+    waterVolume.clearEvents();
+}
+
+void Simulation::stopLureAtDepth() {
+    // Stop the lure's motion
+    throwableBody->SetLinearVelocity(b2Vec2(0.0f, 0.0f));
+    throwableBody->SetAngularVelocity(0.0f);  // Stop spinning
+    throwableBody->SetGravityScale(0.0f);     // Neutralize gravity to keep it at the target depth
+    water->RemoveBody(throwableBody);         // Neutralize buoyancy as well
+}
+
+// === Lure ===
+
+// Creates the throwable object (e.g., a Lure)
+void Simulation::createThrowableBody() {
+    // Define the throwable object's body
+    b2BodyDef bodyDef;
+    bodyDef.type = b2_kinematicBody;  // Initially kinematic to prevent free-fall
+    bodyDef.position.Set(0.0f, 0.0f);  // Default initial position
+    bodyDef.userData = reinterpret_cast<void*>(static_cast<intptr_t>(LureBody));  // Drawn with the lure sprite
+    throwableBody = world.CreateBody(&bodyDef);  // Add the body to the Box2D world
+
+    // Define the shape of the throwable object as a rectangle
+    b2PolygonShape shape;
+    shape.SetAsBox(0.5f, 0.25f);  // Half-width = 0.5m, Half-height = 0.25m
+
+    // Create a fixture to define the object's physical properties
+    b2FixtureDef fixtureDef;
+    fixtureDef.shape = &shape;
+    fixtureDef.density = 1.2f;  // Density affects mass  Heavier objects (higher density)
+    fixtureDef.friction = 0.6f;  // Friction affects sliding
+    fixtureDef.restitution = 0.2f;  // Restitution affects bounciness
+    throwableBody->CreateFixture(&fixtureDef);  // Attach the fixture to the body
+
+    water->AddBody(throwableBody);  // Let the water push and slow the lure
+}
@@ -0,0 +1,169 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <Box2D/Box2D.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "WaterVolume.h"
+#include "FishingLine.h"
+#include "LakeTerrain.h"
+#include "FishSchool.h"
+#include "FishLodManager.h"
+#include "DebugDraw.h"
+#include "TripleBuffer.h"
+#include "SpscQueue.h"
+
+// What a body looks like, kept in the body's user data
+enum BodyKind {
+    SceneryBody,  // Not drawn as a sprite
+    LureBody,
+    FishBody  // Fish of the school, drawn from the school even while it has a body
+};
+
+// A body that overlaps the view
+struct VisibleBody {
+    b2Vec2 position;
+    float angle;
+    BodyKind kind;
+};
+
+// Everything the GUI needs to draw one physics step. The simulation fills one
+// in after every step, the GUI reads the newest one when it paints.
+struct SimulationSnapshot {
+    SimulationSnapshot() : stepCount(-1), holdCount(0), lurePosition(0.0f, 0.0f), lureAngle(0.0f), lureInWater(false), hasDebugDraw(false) {}
+
+    int stepCount;  // Steps taken when the snapshot was made, -1 before the first one
+    int holdCount;  // Hold commands applied, while holding lurePosition is where the last one stopped the lure
+    b2Vec2 lurePosition;
+    float lureAngle;
+    bool lureInWater;
+    std::vector<b2Vec2> linePoints;  // Rod tip to lure, keeps its memory between snapshots
+
+    // Bodies with a sprite that overlap the view, found with b2World::QueryAABB,
+    // followed by the fish in view
+    std::vector<VisibleBody> bodies;
+
+    // Lake bed samples, only replaced when the lake bed changes so the GUI can
+    // tell by comparing pointers
+    std::shared_ptr<const std::vector<b2Vec2>> lakeBed;
+
+    bool hasDebugDraw;  // debugDraw holds the shapes in view
+    DebugDraw debugDraw;
+};
+
+// Input from the GUI, applied on the physics thread before the next step
+struct SimulationCommand {
+    enum Type {
+        SetStart,      // vector: where the lure waits and the rod tip is
+        SetLakeBed,    // heights, value: spacing, vector.x: X of the first sample
+        Hold,          // Stop stepping while a throw is aimed
+        Throw,         // vector: initial velocity of the lure, stepping resumes
+        Reel,          // value: meters of line out, negative reels in
+        SetDebugDraw   // value: nonzero to fill in the debug draw of each snapshot
+    };
+
+    Type type;
+    b2Vec2 vector;
+    float value;
+    std::vector<float> heights;
+};
+
+// The physics of the game on its own thread.
+//
+// The world is stepped at a fixed 60 Hz against absolute deadlines, so the
+// tick rate doesn't depend on how long the GUI takes to paint or whether the
+// GUI thread is blocked by a window drag. Nothing is shared with the GUI
+// thread except through four lock-free channels: commands come in through a
+// single producer single consumer queue, the view comes in through a triple
+// buffer that only keeps the newest one, snapshots go out through a second
+// triple buffer and the water events of the lure go out through a second
+// queue. Neither thread ever waits for the other. Commands that don't fit in
+// the queue wait on the GUI side, none is ever dropped.
+class Simulation {
+public:
+    static constexpr float timeStep = 1.0f / 60.0f;
+
+    // The lure and the rod tip start at startPosition
+    explicit Simulation(const b2Vec2& startPosition);
+    ~Simulation();  // Stops the thread
+
+    void start();
+    void stop();
+
+    // GUI thread: queue a command for the next step. Only the newest view is kept.
+    void setView(const b2AABB& bounds);
+    void setStart(const b2Vec2& position);
+    void setLakeBed(std::vector<float> heights, float spacing, float originX);
+    int hold();  // Returns the number the snapshots report as holdCount once the lure is held
+    void throwLure(const b2Vec2& velocity);
+    void reel(float delta);
+    void setDebugDraw(bool flag);
+
+    // GUI thread: queue the commands that didn't fit in the queue before, call regularly
+    void flushCommands();
+
+    // GUI thread: the newest snapshot, stays valid until the next call
+    SimulationSnapshot& latest() { return snapshots.read(); }
+    bool hasNewSnapshot() const { return snapshots.hasNew(); }
+
+    // GUI thread: the next water event of the lure, false when there are none
+    bool pollLureEvent(WaterEvent::Type& type) { return lureEvents.pop(type); }
+
+    // Constant while the simulation runs, safe to read from any thread
+    const b2Vec2& getGravity() const { return gravity; }
+    float getWaterLevel() const { return waterLevel; }
+
+private:
+    void run();  // Thread function
+    void tick();
+    void post(SimulationCommand command);
+    void execute(SimulationCommand& command);
+    void publish();
+    void findVisibleBodies(std::vector<VisibleBody>& bodies);
+    void findVisibleFish(std::vector<VisibleBody>& bodies);
+
+    void createWater();  // Function to create the water controller and sensor for the lake
+    void createThrowableBody();  // Function to create the throwable object
+    void streamTerrain();  // Load the lake bed around the view and the lure
+    void processWaterEvents(); // Handle the water events of the last step
+    void stopLureAtDepth();
+
+    const b2Vec2 gravity;
+    const float waterLevel; // Water level
+    const float targetDepth;  // Target depth where the lure will stop
+
+    // Only touched by the physics thread once it runs
+    b2ArenaAllocator worldMemory;  // Backs all world allocations, must be declared before the world
+    b2World world;  // The Box2D world where physics simulation happens
+    b2Body* throwableBody;  // The throwable object (e.g., a ball)
+    LakeTerrain terrain;  // The lake bed, only the part near the view and the lure has fixtures
+    b2BuoyancyController* water;  // Applies buoyancy and drag to bodies below the water line
+    WaterVolume waterVolume;  // Reports bodies entering, leaving and sinking in the water
+    FishingLine fishingLine;  // Line between the rod tip and the lure
+    FishSchool fishSchool;  // The fish of the lake, spawned with each lake bed
+    FishLodManager fishLod;  // Lends bodies to the fish near the lure
+    std::shared_ptr<const std::vector<b2Vec2>> lakeBed;  // Shared with the snapshots
+    b2Vec2 rodTip;  // Where the fishing line leaves the rod
+    b2AABB viewBounds;  // The part of the world on screen
+    std::vector<b2Body*> visibleBodies;  // Scratch space for findVisibleBodies
+    int stepCount;
+    int holdCount;
+    bool holding;  // No steps while the user aims a throw
+    bool isInWater;
+    bool debugDrawEnabled;
+
+    SpscQueue<SimulationCommand, 256> commands;  // GUI to physics
+    std::deque<SimulationCommand> overflow;  // GUI side, commands waiting for room in the queue
+    int holdsPosted;  // GUI side, Hold commands posted so far
+    TripleBuffer<b2AABB> views;  // GUI to physics, the newest view
+    TripleBuffer<SimulationSnapshot> snapshots;  // Physics to GUI
+    SpscQueue<WaterEvent::Type, 64> lureEvents;  // Physics to GUI
+
+    std::thread thread;
+    std::atomic<bool> running;
+};
+
+#endif // SIMULATION_H
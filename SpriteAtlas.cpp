@@ -0,0 +1,161 @@
+#include "SpriteAtlas.h"
+#include <QImageReader>
+#include <QPainter>
+#include <QDebug>
+#include <algorithm>
+
+// The padding around each sprite is filled with copies of its edge pixels,
+// so filtering at the edge blends with the sprite and not with its neighbor
+// or the transparent background. It is as wide as one texel of the smallest
+// mip level the renderer samples.
+static const int atlasPadding = 1 << SpriteAtlas::maxTextureMipLevel;
+static const int maxMipLevels = 8;
+
+SpriteAtlas::SpriteAtlas()
+    : built(false) {
+}
+
+int SpriteAtlas::addImage(const QString& fileName) {
+    Sprite sprite;
+    sprite.fileName = fileName;
+    sprites.push_back(sprite);
+    built = false;  // Rebuilt with the new image on next use
+    return static_cast<int>(sprites.size()) - 1;
+}
+
+const QImage& SpriteAtlas::image() {
+    if (!built) {
+        build();
+    }
+    return atlas;
+}
+
+QRect SpriteAtlas::sourceRect(int sprite) {
+    if (!built) {
+        build();
+    }
+    return sprites[sprite].rect;
+}
+
+const QPixmap& SpriteAtlas::pixmap(int sprite, int width) {
+    if (!built) {
+        build();
+    }
+
+    Sprite& s = sprites[sprite];
+    if (s.rect.isEmpty()) {
+        s.levels.resize(1);
+        return s.levels[0];  // Null pixmap, draws nothing
+    }
+
+    // Level n is 1 / 2^n of the full size
+    int level = 0;
+    while (level + 1 < maxMipLevels && (s.rect.width() >> (level + 1)) >= std::max(width, 1)) {
+        ++level;
+    }
+
+    if (static_cast<int>(s.levels.size()) <= level) {
+        s.levels.resize(level + 1);
+    }
+
+    QPixmap& cached = s.levels[level];
+    if (cached.isNull()) {
+        QImage source = atlas.copy(s.rect);
+        if (level > 0) {
+            source = source.scaled(std::max(1, s.rect.width() >> level), std::max(1, s.rect.height() >> level),
+                                   Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
+        cached = QPixmap::fromImage(source);
+    }
+    return cached;
+}
+
+void SpriteAtlas::build() {
+    built = true;
+    for (Sprite& sprite : sprites) {
+        sprite.levels.clear();
+        sprite.rect = QRect();
+    }
+
+    // Decode everything once
+    std::vector<QImage> images(sprites.size());
+    int area = 0;
+    int maxWidth = 1;
+    for (size_t i = 0; i < sprites.size(); ++i) {
+        QImageReader reader(sprites[i].fileName);
+        if (!reader.read(&images[i])) {
+            qDebug() << "Failed to load sprite" << sprites[i].fileName << reader.errorString();
+            continue;
+        }
+        images[i] = images[i].convertToFormat(QImage::Format_RGBA8888);
+        int w = images[i].width() + 2 * atlasPadding;
+        int h = images[i].height() + 2 * atlasPadding;
+        area += w * h;
+        maxWidth = std::max(maxWidth, w);
+    }
+
+    // Shelves fill best with the tallest images first
+    std::vector<int> order;
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!images[i].isNull()) {
+            order.push_back(static_cast<int>(i));
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return images[a].height() > images[b].height();
+    });
+
+    // Power of two width about as wide as the square root of the area
+    int atlasWidth = 1;
+    while (atlasWidth < maxWidth || atlasWidth * atlasWidth < area) {
+        atlasWidth *= 2;
+    }
+
+    int x = 0;
+    int y = 0;
+    int shelfHeight = 0;
+    for (int i : order) {
+        int w = images[i].width() + 2 * atlasPadding;
+        int h = images[i].height() + 2 * atlasPadding;
+        if (x + w > atlasWidth) {  // Start a new shelf
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        sprites[i].rect = QRect(x + atlasPadding, y + atlasPadding, images[i].width(), images[i].height());
+        x += w;
+        shelfHeight = std::max(shelfHeight, h);
+    }
+
+    int atlasHeight = 1;
+    while (atlasHeight < y + shelfHeight) {
+        atlasHeight *= 2;
+    }
+
+    atlas = QImage(atlasWidth, atlasHeight, QImage::Format_RGBA8888);
+    atlas.fill(Qt::transparent);
+    QPainter painter(&atlas);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (int i : order) {
+        const QImage& image = images[i];
+        QRect rect = sprites[i].rect;
+        int w = image.width();
+        int h = image.height();
+        int p = atlasPadding;
+        int left = rect.left();
+        int top = rect.top();
+        int right = left + w;
+        int bottom = top + h;
+        painter.drawImage(rect.topLeft(), image);
+
+        // Stretch the edge rows and columns over the padding, the corner pixels over the corners
+        painter.drawImage(QRect(left - p, top, p, h), image, QRect(0, 0, 1, h));
+        painter.drawImage(QRect(right, top, p, h), image, QRect(w - 1, 0, 1, h));
+        painter.drawImage(QRect(left, top - p, w, p), image, QRect(0, 0, w, 1));
+        painter.drawImage(QRect(left, bottom, w, p), image, QRect(0, h - 1, w, 1));
+        painter.drawImage(QRect(left - p, top - p, p, p), image, QRect(0, 0, 1, 1));
+        painter.drawImage(QRect(right, top - p, p, p), image, QRect(w - 1, 0, 1, 1));
+        painter.drawImage(QRect(left - p, bottom, p, p), image, QRect(0, h - 1, 1, 1));
+        painter.drawImage(QRect(right, bottom, p, p), image, QRect(w - 1, h - 1, 1, 1));
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef SPRITEATLAS_H
+#define SPRITEATLAS_H
+
+#include <QImage>
+#include <QPixmap>
+#include <QRect>
+#include <QString>
+#include <vector>
+
+// Packs the sprite images (lure, fish, splashes) into one atlas image.
+//
+// Images are only registered up front. Nothing is read or decoded until the
+// atlas is first used, so adding sprites doesn't slow down startup. The
+// atlas then decodes every image once, packs them on shelves sorted by height
+// and keeps the rectangle of each sprite. The GL renderer uploads the atlas
+// as one texture with mipmaps, up to maxTextureMipLevel.
+//
+// For QPainter, pixmap() hands out pre-scaled copies at mip levels: the
+// sprite at its full size, half, quarter and so on. The smallest level that
+// is at least as large as what is drawn is scaled once and cached, so a
+// frame never smooth scales a large image.
+class SpriteAtlas {
+public:
+    // Texture mip levels above this would mix neighboring sprites
+    static const int maxTextureMipLevel = 3;
+
+    SpriteAtlas();
+
+    // Register an image and return its sprite id. The file is read lazily.
+    int addImage(const QString& fileName);
+
+    // The packed atlas. Built on the first call.
+    const QImage& image();
+
+    // Rectangle of the sprite in the atlas, in pixels
+    QRect sourceRect(int sprite);
+
+    // The sprite pre-scaled to the smallest mip level at least width pixels wide
+    const QPixmap& pixmap(int sprite, int width);
+
+    bool isBuilt() const { return built; }
+
+private:
+    struct Sprite {
+        QString fileName;
+        QRect rect;  // In the atlas, empty if the image failed to load
+        std::vector<QPixmap> levels;  // Cached mip levels, null until first use
+    };
+
+    void build();
+
+    std::vector<Sprite> sprites;
+    QImage atlas;
+    bool built;
+};
+
+#endif // SPRITEATLAS_H
@@ -0,0 +1,171 @@
+#include "SpriteRenderer.h"
+#include "SpriteAtlas.h"
+#include "SpriteShaders.h"
+#include <QOpenGLContext>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+SpriteRenderer::SpriteRenderer()
+    : ready(false),
+    quadBuffer(QOpenGLBuffer::VertexBuffer),
+    instanceBuffer(QOpenGLBuffer::VertexBuffer),
+    invAtlasWidth(1.0f),
+    invAtlasHeight(1.0f),
+    instanceCapacity(0),
+    viewLocation(-1) {
+}
+
+SpriteRenderer::~SpriteRenderer() {
+    // The GL objects must be released with release() while the context is current
+}
+
+bool SpriteRenderer::initialize() {
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if (!context) {
+        return false;
+    }
+
+    // Instancing and vertex attribute divisors are core in GL 3.3 and ES 3.0
+    QSurfaceFormat format = context->format();
+    bool es = context->isOpenGLES();
+    if (es ? format.majorVersion() < 3 : format.version() < qMakePair(3, 3)) {
+        qDebug() << "OpenGL" << format.majorVersion() << format.minorVersion()
+                 << "has no instancing, drawing sprites with QPainter";
+        return false;
+    }
+
+    initializeOpenGLFunctions();
+
+    const char* vertexHeader = es ? spriteEsVertexHeader : spriteDesktopHeader;
+    const char* fragmentHeader = es ? spriteEsFragmentHeader : spriteDesktopHeader;
+    if (!program.addShaderFromSourceCode(QOpenGLShader::Vertex, QByteArray(vertexHeader) + spriteVertexShader) ||
+        !program.addShaderFromSourceCode(QOpenGLShader::Fragment, QByteArray(fragmentHeader) + spriteFragmentShader) ||
+        !program.link()) {
+        qDebug() << "Sprite shader failed:" << program.log();
+        return false;
+    }
+    viewLocation = program.uniformLocation("view");
+    program.bind();
+    program.setUniformValue("atlas", 0);
+    program.release();
+
+    vao.create();
+    vao.bind();
+
+    // Two triangles as a strip, shared by all instances
+    static const float corners[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+    quadBuffer.create();
+    quadBuffer.bind();
+    quadBuffer.allocate(corners, sizeof(corners));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+    // Streamed every frame, the attributes advance once per instance
+    instanceBuffer.create();
+    instanceBuffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
+    instanceBuffer.bind();
+    const GLsizei stride = sizeof(Instance);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(Instance, x)));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(Instance, halfWidth)));
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(Instance, u0)));
+    glVertexAttribDivisor(3, 1);
+
+    vao.release();
+    quadBuffer.release();
+    instanceBuffer.release();
+
+    instances.reserve(256);
+    ready = true;
+    return true;
+}
+
+void SpriteRenderer::release() {
+    atlas.reset();
+    instanceBuffer.destroy();
+    quadBuffer.destroy();
+    vao.destroy();
+    program.removeAllShaders();
+    instanceCapacity = 0;
+    ready = false;
+}
+
+void SpriteRenderer::setAtlas(const QImage& image) {
+    if (!ready || image.isNull()) {
+        return;
+    }
+
+    // Row 0 of the image goes to v = 0, the shader flips the quad instead of the image
+    atlas.reset(new QOpenGLTexture(image.convertToFormat(QImage::Format_RGBA8888)));
+    atlas->setMinificationFilter(QOpenGLTexture::LinearMipMapLinear);
+    atlas->setMipMaxLevel(SpriteAtlas::maxTextureMipLevel);  // Deeper levels would blend sprites together
+    atlas->setMagnificationFilter(QOpenGLTexture::Linear);
+    atlas->setWrapMode(QOpenGLTexture::ClampToEdge);
+    invAtlasWidth = 1.0f / image.width();
+    invAtlasHeight = 1.0f / image.height();
+}
+
+void SpriteRenderer::addSprite(const b2Vec2& position, float angle, const b2Vec2& halfSize, const QRectF& source) {
+    Instance instance;
+    instance.x = position.x;
+    instance.y = position.y;
+    instance.c = std::cos(angle);
+    instance.s = std::sin(angle);
+    instance.halfWidth = halfSize.x;
+    instance.halfHeight = halfSize.y;
+    instance.u0 = static_cast<float>(source.left()) * invAtlasWidth;
+    instance.v0 = static_cast<float>(source.top()) * invAtlasHeight;
+    instance.u1 = static_cast<float>(source.right()) * invAtlasWidth;
+    instance.v1 = static_cast<float>(source.bottom()) * invAtlasHeight;
+    instances.push_back(instance);
+}
+
+void SpriteRenderer::draw(const Camera& camera) {
+    int width = camera.getWidth();
+    int height = camera.getHeight();
+    if (!ready || !atlas || instances.empty() || width <= 0 || height <= 0) {
+        instances.clear();
+        return;
+    }
+
+    int count = static_cast<int>(instances.size());
+    const int bytes = count * static_cast<int>(sizeof(Instance));
+
+    // Grow by doubling, otherwise orphan the old storage so the driver
+    // doesn't wait for the last frame to finish with it
+    instanceBuffer.bind();
+    if (count > instanceCapacity) {
+        instanceCapacity = std::max(2 * instanceCapacity, count);
+    }
+    instanceBuffer.allocate(instanceCapacity * static_cast<int>(sizeof(Instance)));
+    instanceBuffer.write(0, instances.data(), bytes);
+    instanceBuffer.release();
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+
+    program.bind();
+    // Clip space is 2 units across the viewport, centered on the camera
+    float scaleX = 2.0f * camera.getZoom() / width;
+    float scaleY = 2.0f * camera.getZoom() / height;
+    const b2Vec2& center = camera.getCenter();
+    program.setUniformValue(viewLocation, scaleX, scaleY, -scaleX * center.x, -scaleY * center.y);
+    glActiveTexture(GL_TEXTURE0);
+    atlas->bind();
+    vao.bind();
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+
+    vao.release();
+    atlas->release();
+    program.release();
+
+    instances.clear();
+}
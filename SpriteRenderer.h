@@ -0,0 +1,79 @@
+#ifndef SPRITERENDERER_H
+#define SPRITERENDERER_H
+
+#include <Box2D/Box2D.h>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLTexture>
+#include <QImage>
+#include <QRectF>
+#include <memory>
+#include <vector>
+#include "Camera.h"
+
+// Draws all sprites of a frame with one instanced draw call.
+//
+// Every sprite is a quad cut from one texture (the atlas). During the frame
+// the game adds one instance per sprite with the body transform, the size in
+// meters and the texture rectangle. draw() uploads all instances into one
+// buffer and draws them with glDrawArraysInstanced, so the cost on the CPU is
+// a small copy per sprite and a fixed number of GL calls no matter how many
+// fish there are. The texture is uploaded once, not scaled every frame.
+//
+// Needs OpenGL 3.3 or OpenGL ES 3.0, which software Mesa (llvmpipe) provides.
+// initialize() returns false on older contexts and the game falls back to
+// QPainter.
+class SpriteRenderer : protected QOpenGLExtraFunctions {
+public:
+    SpriteRenderer();
+    ~SpriteRenderer();
+
+    // Create the GL objects. The widget's context must be current.
+    bool initialize();
+    bool isReady() const { return ready; }
+
+    // Release the GL objects. The widget's context must be current.
+    void release();
+
+    // Upload the atlas. Texture rectangles are given in pixels of this image.
+    void setAtlas(const QImage& image);
+
+    // Queue a sprite centered on position, rotated by angle and halfSize
+    // meters large, showing the part source of the atlas
+    void addSprite(const b2Vec2& position, float angle, const b2Vec2& halfSize, const QRectF& source);
+
+    // Queue a sprite that follows a body
+    void addSprite(const b2Body* body, const b2Vec2& halfSize, const QRectF& source) {
+        addSprite(body->GetPosition(), body->GetAngle(), halfSize, source);
+    }
+
+    // Draw and clear the queued sprites as seen by the camera
+    void draw(const Camera& camera);
+
+    int getSpriteCount() const { return static_cast<int>(instances.size()); }
+
+private:
+    // Per instance data, matches the vertex attributes in the shader
+    struct Instance {
+        float x, y;  // Center in meters
+        float c, s;  // Cosine and sine of the angle
+        float halfWidth, halfHeight;  // In meters
+        float u0, v0, u1, v1;  // Texture rectangle, v0 is the top of the image
+    };
+
+    bool ready;
+    QOpenGLShaderProgram program;
+    QOpenGLVertexArrayObject vao;
+    QOpenGLBuffer quadBuffer;
+    QOpenGLBuffer instanceBuffer;
+    std::unique_ptr<QOpenGLTexture> atlas;
+    float invAtlasWidth;
+    float invAtlasHeight;
+    int instanceCapacity;  // Instances that fit in instanceBuffer
+    int viewLocation;
+    std::vector<Instance> instances;  // Keeps its memory between frames
+};
+
+#endif // SPRITERENDERER_H
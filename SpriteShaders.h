@@ -0,0 +1,38 @@
+#ifndef SPRITESHADERS_H
+#define SPRITESHADERS_H
+
+// The shaders of SpriteRenderer, without a Qt dependency so
+// tests/SpriteRendererGL can compile the same sources.
+
+// Prepended to the shaders. Vertex shaders default to high precision on ES,
+// fragment shaders need one.
+static const char* const spriteDesktopHeader = "#version 330 core\n";
+static const char* const spriteEsVertexHeader = "#version 300 es\n";
+static const char* const spriteEsFragmentHeader = "#version 300 es\nprecision mediump float;\n";
+
+// The quad corners go from -1 to 1. Each instance moves, rotates and scales
+// the quad and picks its part of the atlas.
+static const char* const spriteVertexShader =
+    "layout(location = 0) in vec2 corner;\n"
+    "layout(location = 1) in vec4 transform;\n"  // x, y, cos, sin
+    "layout(location = 2) in vec2 halfSize;\n"
+    "layout(location = 3) in vec4 source;\n"  // u0, v0, u1, v1
+    "uniform vec4 view;\n"  // Meters to clip space: scale x, scale y, offset x, offset y
+    "out vec2 uv;\n"
+    "void main() {\n"
+    "    vec2 local = corner * halfSize;\n"
+    "    vec2 p = transform.xy + vec2(transform.z * local.x - transform.w * local.y,\n"
+    "                                 transform.w * local.x + transform.z * local.y);\n"
+    "    gl_Position = vec4(p * view.xy + view.zw, 0.0, 1.0);\n"
+    "    uv = mix(source.xy, source.zw, vec2(0.5 + 0.5 * corner.x, 0.5 - 0.5 * corner.y));\n"
+    "}\n";
+
+static const char* const spriteFragmentShader =
+    "in vec2 uv;\n"
+    "uniform sampler2D atlas;\n"
+    "out vec4 color;\n"
+    "void main() {\n"
+    "    color = texture(atlas, uv);\n"
+    "}\n";
+
+#endif // SPRITESHADERS_H
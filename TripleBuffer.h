@@ -0,0 +1,55 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Hands the newest value from one writer thread to one reader thread without
+// locks and without either side ever waiting for the other.
+//
+// There are three values: the writer owns one, the reader owns one and the
+// third is in the middle. publish() swaps the writer's value with the middle
+// one, read() swaps the middle one with the reader's value if something new
+// was published since. The swap is a single atomic exchange of the middle
+// index, with a flag bit telling the reader that it is fresh. A writer that
+// publishes faster than the reader reads simply replaces the middle value, so
+// the reader always gets the latest complete value and never a torn one.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), writeIndex(0), readIndex(2) {}
+
+    // Writer: the value to fill in. Holds whatever was in it two publishes
+    // ago, so buffers inside it can be reused.
+    T& writeBuffer() { return values[writeIndex]; }
+
+    // Writer: make the filled in value the newest one
+    void publish() {
+        int previous = middle.exchange(writeIndex | freshBit, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    // Reader: the newest published value. Stays the same until the next
+    // call that finds something new, so the reader may keep using it.
+    T& read() {
+        if (middle.load(std::memory_order_relaxed) & freshBit) {
+            int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+            readIndex = previous & indexMask;
+        }
+        return values[readIndex];
+    }
+
+    // Reader: was something published since the last read()?
+    bool hasNew() const { return (middle.load(std::memory_order_relaxed) & freshBit) != 0; }
+
+private:
+    enum { indexMask = 3, freshBit = 4 };
+
+    T values[3];
+
+    // Each index on its own cache line, so the two threads don't slow each other down
+    alignas(64) std::atomic<int> middle;
+    alignas(64) int writeIndex;  // Only touched by the writer
+    alignas(64) int readIndex;   // Only touched by the reader
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,90 @@
+#include "WaterVolume.h"
+
+WaterVolume::WaterVolume()
+    : world(nullptr),
+    sensorBody(nullptr),
+    sensor(nullptr),
+    surface(0.0f),
+    targetDepth(0.0f) {
+}
+
+void WaterVolume::create(b2World* world, float left, float right, float bottom, float surface) {
+    this->world = world;
+    this->surface = surface;
+
+    // The water is a static sensor box, it detects bodies without pushing them
+    b2BodyDef bodyDef;
+    bodyDef.position.Set(0.5f * (left + right), 0.5f * (bottom + surface));
+    sensorBody = world->CreateBody(&bodyDef);
+
+    b2PolygonShape shape;
+    shape.SetAsBox(0.5f * (right - left), 0.5f * (surface - bottom));
+
+    b2FixtureDef fixtureDef;
+    fixtureDef.shape = &shape;
+    fixtureDef.isSensor = true;
+    sensor = sensorBody->CreateFixture(&fixtureDef);
+
+    world->SetSensorEventsEnabled(true);
+}
+
+void WaterVolume::enter(b2Body* body) {
+    std::unordered_map<const b2Body*, int>::iterator it = occupantIndex.find(body);
+    if (it != occupantIndex.end()) {
+        ++occupants[it->second].fixtureCount;  // Another fixture of the same body
+        return;
+    }
+
+    occupantIndex.emplace(body, static_cast<int>(occupants.size()));
+    occupants.push_back({body, 1, false});
+    events.push_back({WaterEvent::Entered, body});
+}
+
+void WaterVolume::exit(b2Body* body) {
+    std::unordered_map<const b2Body*, int>::iterator it = occupantIndex.find(body);
+    if (it == occupantIndex.end()) {
+        return;
+    }
+
+    int index = it->second;
+    if (--occupants[index].fixtureCount > 0) {
+        return;  // Still in the water with another fixture
+    }
+
+    // Swap with the last occupant to keep the array dense
+    occupantIndex.erase(it);
+    if (index != static_cast<int>(occupants.size()) - 1) {
+        occupants[index] = occupants.back();
+        occupantIndex[occupants[index].body] = index;
+    }
+    occupants.pop_back();
+    events.push_back({WaterEvent::Exited, body});
+}
+
+void WaterVolume::endStep() {
+    // Sensor overlaps of this step, and of bodies destroyed or deactivated since the last one
+    const b2SensorEvent* sensorEvents = world->GetSensorEvents();
+    int sensorEventCount = world->GetSensorEventCount();
+    for (int i = 0; i < sensorEventCount; ++i) {
+        const b2SensorEvent& event = sensorEvents[i];
+        if (event.sensorFixture != sensor) {
+            continue;  // Another sensor
+        }
+
+        // The body of an end event may already be destroyed, it is only a key then
+        if (event.begin) {
+            enter(event.visitorBody);
+        } else {
+            exit(event.visitorBody);
+        }
+    }
+
+    float depthLevel = surface - targetDepth;
+    for (Occupant& occupant : occupants) {
+        bool belowDepth = occupant.body->GetPosition().y <= depthLevel;
+        if (belowDepth && !occupant.reachedDepth) {
+            events.push_back({WaterEvent::ReachedDepth, occupant.body});
+        }
+        occupant.reachedDepth = belowDepth;
+    }
+}
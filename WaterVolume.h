@@ -0,0 +1,72 @@
+#ifndef WATERVOLUME_H
+#define WATERVOLUME_H
+
+#include <Box2D/Box2D.h>
+#include <unordered_map>
+#include <vector>
+
+// Something that happened to a body in the water during the last world step.
+struct WaterEvent {
+    enum Type {
+        Entered,        // The body started touching the water
+        Exited,         // The body left the water completely
+        ReachedDepth    // The body sank below the target depth
+    };
+
+    Type type;
+    b2Body* body;
+};
+
+// A region of water backed by a sensor fixture. Box2D records begin/end
+// touching of the sensor in the world's sensor event buffer, endStep turns the
+// ones of this sensor into water events and hands them out in one batch after
+// each world step. Only bodies that are currently in the water are checked for
+// depth, nothing else is polled.
+class WaterVolume {
+public:
+    WaterVolume();
+
+    // Create the sensor body covering [left, right] x [bottom, surface] and
+    // turn on the world's sensor events.
+    void create(b2World* world, float left, float right, float bottom, float surface);
+
+    // Depth below the surface at which ReachedDepth is reported when a body sinks past it
+    void setTargetDepth(float depth) { targetDepth = depth; }
+    float getTargetDepth() const { return targetDepth; }
+
+    float getSurface() const { return surface; }
+
+    // Call after world.Step to queue the events for the step. The world's
+    // sensor events are left for the caller to clear.
+    void endStep();
+
+    // Events queued since the last clearEvents() call, in the order they happened
+    const std::vector<WaterEvent>& getEvents() const { return events; }
+    void clearEvents() { events.clear(); }
+
+    // Is the body currently touching the water?
+    bool contains(const b2Body* body) const { return occupantIndex.count(body) > 0; }
+
+private:
+    // A body touching the water. A body can touch the sensor with several fixtures.
+    struct Occupant {
+        b2Body* body;
+        int fixtureCount;
+        bool reachedDepth;
+    };
+
+    void enter(b2Body* body);
+    void exit(b2Body* body);
+
+    b2World* world;
+    b2Body* sensorBody;  // Static body holding the sensor fixture
+    b2Fixture* sensor;   // The water region
+    float surface;       // Height of the water surface
+    float targetDepth;   // Depth for ReachedDepth events
+
+    std::vector<Occupant> occupants;  // Bodies in the water
+    std::unordered_map<const b2Body*, int> occupantIndex;  // Position of each body in occupants
+    std::vector<WaterEvent> events;   // Events for the consumer
+};
+
+#endif // WATERVOLUME_H
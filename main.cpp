@@ -5,8 +5,16 @@
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
-    Game game;
-    game.resize(800, 600);
-    game.show();
-    return a.exec();
+    int result;
+    {
+        // Destroying the game stops the physics thread, which records into the trace
+        Game game;
+        game.resize(800, 600);
+        game.show();
+        result = a.exec();
+    }
+
+    // Only writes a file when built with B2_PROFILER
+    b2WriteProfileTrace("fishing_trace.json");
+    return result;
 }
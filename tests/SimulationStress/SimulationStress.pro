@@ -0,0 +1,31 @@
+# Headless stress test of Simulation, no window or GL needed:
+#   qmake && make && ./SimulationStress
+# With ThreadSanitizer:
+#   qmake CONFIG+=tsan && make && ./SimulationStress
+
+QT = core gui  # DebugDraw collects QPainterPaths
+
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+tsan {
+    QMAKE_CXXFLAGS += -fsanitize=thread -g -O1
+    QMAKE_LFLAGS += -fsanitize=thread
+}
+
+ROOT = $$PWD/../..
+INCLUDEPATH += $$ROOT
+
+SOURCES += \
+    $$files($$ROOT/Box2D/Collision/*.cpp, true) \
+    $$files($$ROOT/Box2D/Common/*.cpp) \
+    $$files($$ROOT/Box2D/Dynamics/*.cpp, true) \
+    $$ROOT/Box2D/Rope/b2Rope.cpp \
+    $$ROOT/DebugDraw.cpp \
+    $$ROOT/FishLodManager.cpp \
+    $$ROOT/FishSchool.cpp \
+    $$ROOT/FishingLine.cpp \
+    $$ROOT/LakeTerrain.cpp \
+    $$ROOT/Simulation.cpp \
+    $$ROOT/WaterVolume.cpp \
+    main.cpp
@@ -0,0 +1,181 @@
+#include "Simulation.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Drives Simulation the way Game does, without a window: commands from this
+// thread, snapshots read back while the physics thread steps. Build it with
+// CONFIG+=tsan to let ThreadSanitizer check the channels between the two.
+
+static int failCount = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition) && failCount++ < 10) { \
+            std::printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
+
+static void sleepFor(int milliseconds) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+static void setUpLake(Simulation& simulation) {
+    simulation.setLakeBed(std::vector<float>(26, 0.0f), 1.0f, 0.0f);
+    b2AABB view;
+    view.lowerBound.Set(0.0f, 0.0f);
+    view.upperBound.Set(26.7f, 20.0f);
+    simulation.setView(view);
+}
+
+// The reader never sees a torn or an older value, the queue keeps the order
+static void testChannels() {
+    struct Value {
+        long first;
+        std::vector<long> items;
+        long last;
+    };
+
+    TripleBuffer<Value> buffer;
+    SpscQueue<std::vector<int>, 64> queue;
+    const long valueCount = 200000;
+    const int messageCount = 20000;
+
+    std::thread writer([&]() {
+        for (long i = 1; i <= valueCount; ++i) {
+            Value& value = buffer.writeBuffer();
+            value.first = i;
+            value.items.assign(3, i);
+            value.last = i;
+            buffer.publish();
+        }
+        for (int i = 0; i < messageCount; ++i) {
+            std::vector<int> message(2, i);
+            while (!queue.push(std::move(message))) {
+            }
+        }
+    });
+
+    long newest = 0;
+    int torn = 0;
+    int backwards = 0;
+    while (newest < valueCount) {
+        const Value& value = buffer.read();
+        if (value.first != value.last || (value.first != 0 && (value.items.size() != 3 || value.items[2] != value.first))) {
+            ++torn;
+        }
+        if (value.first < newest) {
+            ++backwards;
+        }
+        newest = value.first;
+    }
+
+    int outOfOrder = 0;
+    std::vector<int> message;
+    for (int expected = 0; expected < messageCount;) {
+        if (queue.pop(message)) {
+            if (message.size() != 2 || message[0] != expected) {
+                ++outOfOrder;
+            }
+            ++expected;
+        }
+    }
+    writer.join();
+
+    CHECK(torn == 0);
+    CHECK(backwards == 0);
+    CHECK(outOfOrder == 0);
+}
+
+// More commands than the queue holds, queued before the thread even runs
+static void testFlood() {
+    Simulation simulation(b2Vec2(10.0f, 10.0f));
+    setUpLake(simulation);
+
+    int lastHold = 0;
+    for (int i = 0; i < 1000; ++i) {
+        lastHold = simulation.hold();
+        simulation.throwLure(b2Vec2(0.0f, 0.0f));
+    }
+    lastHold = simulation.hold();
+    simulation.start();
+
+    for (int i = 0; i < 200 && simulation.latest().holdCount != lastHold; ++i) {
+        simulation.flushCommands();
+        sleepFor(16);
+    }
+    SimulationSnapshot& snapshot = simulation.latest();
+    simulation.stop();
+
+    CHECK(snapshot.holdCount == lastHold);
+    CHECK(snapshot.lakeBed && snapshot.lakeBed->size() == 26);
+}
+
+// A held lure stays where the snapshot of its Hold shows it
+static void testHold() {
+    Simulation simulation(b2Vec2(10.0f, 10.0f));
+    setUpLake(simulation);
+    simulation.start();
+    simulation.throwLure(b2Vec2(8.0f, 4.0f));
+    sleepFor(300);
+
+    for (int i = 0; i < 20; ++i) {
+        int held = simulation.hold();
+        SimulationSnapshot* snapshot = &simulation.latest();
+        for (int wait = 0; wait < 1000 && snapshot->holdCount != held; ++wait) {
+            sleepFor(1);
+            snapshot = &simulation.latest();
+        }
+        CHECK(snapshot->holdCount == held);
+        b2Vec2 heldPosition = snapshot->lurePosition;
+        int heldStep = snapshot->stepCount;
+
+        sleepFor(50);
+        simulation.reel(0.0f);  // Publishes a snapshot without stepping
+        sleepFor(20);
+        SimulationSnapshot& later = simulation.latest();
+        CHECK(later.lurePosition == heldPosition);
+        CHECK(later.stepCount == heldStep);
+
+        simulation.throwLure(b2Vec2(float(i % 5), 3.0f));
+        sleepFor(30);
+    }
+    simulation.stop();
+}
+
+// The physics keeps stepping while the GUI thread hitches
+static void testHitches() {
+    Simulation simulation(b2Vec2(10.0f, 10.0f));
+    setUpLake(simulation);
+    simulation.setDebugDraw(true);
+    simulation.start();
+    simulation.throwLure(b2Vec2(8.0f, 4.0f));
+
+    WaterEvent::Type type;
+    for (int i = 0; i < 100; ++i) {
+        int before = simulation.latest().stepCount;
+        bool hitch = i % 20 == 0;
+        sleepFor(hitch ? 120 : 5);
+        SimulationSnapshot& snapshot = simulation.latest();
+        CHECK(!hitch || snapshot.stepCount > before);
+        CHECK(snapshot.linePoints.size() > 1);
+        simulation.reel(0.01f);
+        while (simulation.pollLureEvent(type)) {
+        }
+    }
+    simulation.stop();
+}
+
+int main() {
+    testChannels();
+    testFlood();
+    testHold();
+    testHitches();
+
+    std::printf("failed checks %d\n", failCount);
+    return failCount == 0 ? 0 : 1;
+}
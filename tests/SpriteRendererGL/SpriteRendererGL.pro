@@ -0,0 +1,12 @@
+# Offscreen check of the sprite shaders on software Mesa, needs EGL but no Qt:
+#   qmake && make && EGL_PLATFORM=surfaceless LIBGL_ALWAYS_SOFTWARE=1 ./SpriteRendererGL
+
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+INCLUDEPATH += $$PWD/../..
+LIBS += -lEGL -lGL
+
+HEADERS += ../../SpriteShaders.h
+SOURCES += main.cpp
@@ -0,0 +1,208 @@
+#define GL_GLEXT_PROTOTYPES
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/glcorearb.h>
+
+#include "SpriteShaders.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+// Draws sprites with the shaders and the instance layout of SpriteRenderer
+// into an offscreen framebuffer and checks the pixels. Needs no window and
+// no Qt, only EGL, so it runs on software Mesa (llvmpipe) in CI:
+//   EGL_PLATFORM=surfaceless LIBGL_ALWAYS_SOFTWARE=1 ./SpriteRendererGL
+// Both context types SpriteRenderer accepts are tested, GL 3.3 core and
+// OpenGL ES 3.0.
+
+static int failCount = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition) && failCount++ < 10) { \
+            std::printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
+
+// Same layout as SpriteRenderer::Instance
+struct Instance {
+    float x, y;
+    float c, s;
+    float halfWidth, halfHeight;
+    float u0, v0, u1, v1;
+};
+
+static const int width = 200;
+static const int height = 100;
+
+static GLuint compileShader(GLenum type, const std::string& source) {
+    GLuint shader = glCreateShader(type);
+    const char* text = source.c_str();
+    glShaderSource(shader, 1, &text, nullptr);
+    glCompileShader(shader);
+    GLint compiled = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        char log[2048];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::printf("shader failed: %s\n", log);
+    }
+    CHECK(compiled);
+    return shader;
+}
+
+static bool isColor(const unsigned char* pixels, int x, int y, int r, int g, int b) {
+    const unsigned char* p = pixels + 4 * (y * width + x);  // Row 0 is the bottom
+    return p[0] == r && p[1] == g && p[2] == b;
+}
+
+static void drawSprites(bool es) {
+    // Render into a renderbuffer, the context has no window surface
+    GLuint framebuffer;
+    GLuint renderbuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+    CHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    glViewport(0, 0, width, height);
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    const char* vertexHeader = es ? spriteEsVertexHeader : spriteDesktopHeader;
+    const char* fragmentHeader = es ? spriteEsFragmentHeader : spriteDesktopHeader;
+    GLuint program = glCreateProgram();
+    glAttachShader(program, compileShader(GL_VERTEX_SHADER, std::string(vertexHeader) + spriteVertexShader));
+    glAttachShader(program, compileShader(GL_FRAGMENT_SHADER, std::string(fragmentHeader) + spriteFragmentShader));
+    glLinkProgram(program);
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    CHECK(linked);
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "atlas"), 0);
+
+    // A 2x2 atlas, row 0 is the top of the image: red, green / blue, black
+    const unsigned char texels[16] = { 255, 0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255, 0, 0, 0, 255 };
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // The vertex arrays are set up as in SpriteRenderer::initialize
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    static const float corners[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+    GLuint quadBuffer;
+    glGenBuffers(1, &quadBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+    GLuint instanceBuffer;
+    glGenBuffers(1, &instanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    const GLsizei stride = sizeof(Instance);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(Instance, x)));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(Instance, halfWidth)));
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offsetof(Instance, u0)));
+    glVertexAttribDivisor(3, 1);
+
+    // 10 pixels per meter, the camera looks at (10, 5) so the view is 20 x 10 meters.
+    // The first sprite shows the whole atlas at (5, 5), 4 x 4 meters large.
+    // The second shows only the red texel at (15, 5), 6 x 2 meters turned by 90 degrees.
+    const float halfPi = 1.57079633f;
+    const Instance instances[2] = {
+        { 5.0f, 5.0f, 1.0f, 0.0f, 2.0f, 2.0f, 0.0f, 0.0f, 1.0f, 1.0f },
+        { 15.0f, 5.0f, std::cos(halfPi), std::sin(halfPi), 3.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f }
+    };
+    glBufferData(GL_ARRAY_BUFFER, sizeof(instances), instances, GL_STREAM_DRAW);
+
+    float scaleX = 2.0f * 10.0f / width;
+    float scaleY = 2.0f * 10.0f / height;
+    glUniform4f(glGetUniformLocation(program, "view"), scaleX, scaleY, -scaleX * 10.0f, -scaleY * 5.0f);
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, 2);
+    CHECK(glGetError() == GL_NO_ERROR);
+
+    static unsigned char pixels[width * height * 4];
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    // The first sprite covers pixels 30 to 70 both ways, the image is upright
+    CHECK(isColor(pixels, 35, 65, 255, 0, 0));
+    CHECK(isColor(pixels, 65, 65, 0, 255, 0));
+    CHECK(isColor(pixels, 35, 35, 0, 0, 255));
+    CHECK(isColor(pixels, 65, 35, 0, 0, 0));
+
+    // The second one stands upright, 20 pixels wide and 60 high
+    CHECK(isColor(pixels, 150, 75, 255, 0, 0));
+    CHECK(isColor(pixels, 150, 25, 255, 0, 0));
+    CHECK(isColor(pixels, 135, 50, 255, 255, 255));
+    CHECK(isColor(pixels, 165, 50, 255, 255, 255));
+    CHECK(isColor(pixels, 100, 50, 255, 255, 255));
+
+    glDeleteBuffers(1, &instanceBuffer);
+    glDeleteBuffers(1, &quadBuffer);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteTextures(1, &texture);
+    glDeleteProgram(program);
+    glDeleteRenderbuffers(1, &renderbuffer);
+    glDeleteFramebuffers(1, &framebuffer);
+}
+
+static bool runWithContext(EGLDisplay display, bool es) {
+    eglBindAPI(es ? EGL_OPENGL_ES_API : EGL_OPENGL_API);
+
+    const EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, es ? EGL_OPENGL_ES3_BIT : EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+
+    const EGLint desktopAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE
+    };
+    const EGLint esAttributes[] = { EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 0, EGL_NONE };
+    EGLContext context = eglCreateContext(display, configCount > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT,
+                                          es ? esAttributes : desktopAttributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::printf("no %s context, EGL error 0x%x\n", es ? "OpenGL ES 3.0" : "OpenGL 3.3 core", eglGetError());
+        return false;
+    }
+
+    std::printf("%s\n", reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    drawSprites(es);
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    return true;
+}
+
+int main() {
+    EGLDisplay display = eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+        std::printf("no surfaceless EGL display\n");
+        return 1;
+    }
+
+    CHECK(runWithContext(display, false));
+    CHECK(runWithContext(display, true));
+    eglTerminate(display);
+
+    std::printf("failed checks %d\n", failCount);
+    return failCount == 0 ? 0 : 1;
+}